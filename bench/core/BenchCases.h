@@ -0,0 +1,186 @@
+// ============================================
+// BenchCases.h - Cas mesurés par bench/core, communs à l'hôte et à l'ESP32
+// ============================================
+//
+// Chaque cas exécute son opération `iterations` fois ; le programme qui
+// l'appelle mesure la durée (ns sur l'hôte, cycles sur l'ESP32) et les
+// allocations, puis divise par le nombre d'opérations. Le nombre
+// d'itérations est celui de l'ESP32, multiplié sur l'hôte. La mesure est
+// répétée REPEATS fois et la plus rapide est gardée : une interruption ou
+// un changement de fréquence ne ralentit qu'une répétition.
+//
+// Le gabarit de la page d'accueil et le JSON de /status reprennent à
+// l'identique le code des routes de WiFiManagerOTA.cpp (lambdas privées),
+// avec TimeFormatter::formatUptime() pour la durée de fonctionnement.
+//
+// Les noms des cas sont des clés stables : tools/bench_compare.py compare
+// deux résultats cas par cas. En ajouter, ne pas en renommer.
+
+#ifndef BENCH_CASES_H
+#define BENCH_CASES_H
+
+#include <Arduino.h>
+#include "utilities.h"
+#include "WebPages.h"
+
+namespace BenchCases
+{
+    typedef void (*Body)(uint32_t iterations);
+
+    struct Case
+    {
+        const char *name;
+        Body body;
+        uint32_t iterations; // sur l'ESP32, moins de 17 s (compteur de cycles 32 bits)
+    };
+
+    static const size_t BLOCK = 64;
+    static const uint32_t REPEATS = 5;
+
+    static volatile float sinkFloat;
+    static volatile uint32_t sinkInt;
+    static float samples[BLOCK];
+
+    // Sortie de log qui ne fait que compter : mesure Logger, pas l'UART
+    class CountingSink : public LogSink
+    {
+    public:
+        uint32_t lines = 0;
+        void write(const LogRecord &record) override { lines += record.length > 0; }
+    };
+
+    static CountingSink countingSink;
+    static Logger benchLogger;
+
+    // À appeler une fois avant les mesures
+    static void setup()
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+            samples[i] = 20.0f + (float)(i % 7) * 0.25f;
+        LogDispatcher &dispatcher = LogDispatcher::instance();
+        dispatcher.removeSink(&dispatcher.serial());
+        dispatcher.addSink(&countingSink);
+        benchLogger.setLevel(Logger::INFO);
+    }
+
+    static void circularBufferPushPop(uint32_t n)
+    {
+        static CircularBuffer<float, BLOCK> buffer;
+        float v = 0, acc = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            buffer.push(samples[i % BLOCK]);
+            buffer.pop(v);
+            acc += v;
+        }
+        sinkFloat = acc;
+    }
+
+    static void statisticsAddValue(uint32_t n)
+    {
+        Statistics stats;
+        for (uint32_t i = 0; i < n; i++)
+            stats.addValue(samples[i % BLOCK]);
+        sinkFloat = stats.getAverage();
+    }
+
+    // Par valeur, ajoutées par blocs de BLOCK
+    static void statisticsAddValues(uint32_t n)
+    {
+        Statistics stats;
+        for (uint32_t i = 0; i < n; i += BLOCK)
+            stats.addValues(samples, BLOCK);
+        sinkFloat = stats.getAverage();
+    }
+
+    static void lowPassFilter(uint32_t n)
+    {
+        LowPassFilter filter(0.1f);
+        float acc = 0;
+        for (uint32_t i = 0; i < n; i++)
+            acc += filter.filter(samples[i % BLOCK]);
+        sinkFloat = acc;
+    }
+
+    static void loggerLog(uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            benchLogger.log(Logger::INFO, "Connexion MQTT établie");
+        sinkInt = countingSink.lines;
+    }
+
+    static void loggerLogString(uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            benchLogger.info("Température: " + String(samples[i % BLOCK]) + " °C");
+        sinkInt = countingSink.lines;
+    }
+
+    static void loggerLogf(uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            benchLogger.infof("Température: %.2f °C", samples[i % BLOCK]);
+        sinkInt = countingSink.lines;
+    }
+
+    // Niveau inactif : ne doit rien coûter
+    static void loggerFiltered(uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            benchLogger.debugf("Température: %.2f °C", samples[i % BLOCK]);
+        sinkInt = countingSink.lines;
+    }
+
+    // Route "/" de WiFiManagerOTA
+    static void templateIndexPage(uint32_t n)
+    {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            String page = String(WebPages::INDEX_HTML);
+            page.replace("%SSID%", "MaisonWiFi");
+            page.replace("%IP%", IPAddress(192, 168, 1, 42).toString());
+            page.replace("%RSSI%", String(-61));
+            page.replace("%UPTIME%", TimeFormatter::formatUptime(millis()));
+            total += page.length();
+        }
+        sinkInt = total;
+    }
+
+    // Route "/status" de WiFiManagerOTA, sans les sections facultatives
+    static void statusJson(uint32_t n)
+    {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            String json = "{";
+            json += "\"ssid\":\"" + String("MaisonWiFi") + "\",";
+            json += "\"ip\":\"" + IPAddress(192, 168, 1, 42).toString() + "\",";
+            json += "\"rssi\":" + String(-61) + ",";
+            json += "\"uptime\":\"" + TimeFormatter::formatUptime(millis()) + "\",";
+            json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + ",";
+            json += "\"chipModel\":\"" + String(ESP.getChipModel()) + "\",";
+            json += "\"cpuFreq\":" + String(ESP.getCpuFreqMHz());
+            json += "}";
+            total += json.length();
+        }
+        sinkInt = total;
+    }
+
+    static const Case CASES[] = {
+        {"circular_buffer.push_pop", circularBufferPushPop, 200000},
+        {"statistics.add_value", statisticsAddValue, 200000},
+        {"statistics.add_values", statisticsAddValues, 200000},
+        {"low_pass_filter.filter", lowPassFilter, 200000},
+        {"logger.log", loggerLog, 20000},
+        {"logger.log_string", loggerLogString, 5000},
+        {"logger.logf", loggerLogf, 5000},
+        {"logger.filtered", loggerFiltered, 200000},
+        {"template.index_page", templateIndexPage, 500},
+        {"json.status", statusJson, 2000},
+    };
+
+    static const size_t COUNT = sizeof(CASES) / sizeof(CASES[0]);
+}
+
+#endif
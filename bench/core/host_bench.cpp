@@ -0,0 +1,108 @@
+// ============================================
+// host_bench.cpp - Utilitaires, logs, gabarits et JSON, sur la machine hôte
+// ============================================
+//
+//   g++ -O2 -std=gnu++17 -pthread -Itest/fakes -Isrc -I<ArduinoJson>/src
+//       bench/core/host_bench.cpp -o core_bench && ./core_bench > host.json
+//
+// (une seule ligne de commande ; <ArduinoJson> :
+// .pio/libdeps/native/ArduinoJson après un pio test -e native)
+//
+// Compilé contre le cœur Arduino simulé de test/fakes. Les durées sont en
+// ns par opération, les allocations comptées par operator new : String y
+// repose sur std::string, dont le tampon interne (15 octets) est plus grand
+// que celui de l'ESP32 (11 octets). Comparer des résultats hôte entre eux,
+// et ceux de l'ESP32 entre eux.
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include "BenchCases.h"
+
+static const uint32_t HOST_SCALE = 20;
+
+static bool counting = false;
+static uint32_t allocations = 0;
+static uint64_t allocatedBytes = 0;
+
+void *operator new(size_t size)
+{
+    if (counting)
+    {
+        allocations++;
+        allocatedBytes += size;
+    }
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    if (counting)
+    {
+        allocations++;
+        allocatedBytes += size;
+    }
+    return malloc(size ? size : 1);
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+int main()
+{
+    BenchCases::setup();
+    fake::setMillis(3723000); // 1h 2m 3s : durée de fonctionnement réaliste
+
+    // Répétitions entrelacées : un ralentissement passager de la machine
+    // touche un passage de tous les cas, pas toutes les mesures d'un cas
+    double best[BenchCases::COUNT];
+    uint32_t caseAllocations[BenchCases::COUNT];
+    uint64_t caseBytes[BenchCases::COUNT];
+    for (uint32_t r = 0; r < BenchCases::REPEATS; r++)
+    {
+        for (size_t i = 0; i < BenchCases::COUNT; i++)
+        {
+            const BenchCases::Case &c = BenchCases::CASES[i];
+            uint32_t n = c.iterations * HOST_SCALE;
+            c.body(n / 10); // chauffe : caches, tampons des String
+
+            allocations = 0;
+            allocatedBytes = 0;
+            counting = r == 0; // allocations comptées sur le premier passage
+            auto t0 = std::chrono::steady_clock::now();
+            c.body(n);
+            auto t1 = std::chrono::steady_clock::now();
+            counting = false;
+
+            double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+            if (r == 0)
+            {
+                best[i] = ns;
+                caseAllocations[i] = allocations;
+                caseBytes[i] = allocatedBytes;
+            }
+            else if (ns < best[i])
+                best[i] = ns;
+        }
+    }
+
+    printf("{\"suite\":\"core\",\"target\":\"host\",\"unit\":\"ns\",\"repeats\":%u,\"results\":[\n",
+           (unsigned)BenchCases::REPEATS);
+    for (size_t i = 0; i < BenchCases::COUNT; i++)
+    {
+        const BenchCases::Case &c = BenchCases::CASES[i];
+        uint32_t n = c.iterations * HOST_SCALE;
+        printf("  {\"name\":\"%s\",\"iterations\":%u,\"per_op\":%.2f,\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f}%s\n",
+               c.name, (unsigned)n, best[i] / n, (double)caseAllocations[i] / n, (double)caseBytes[i] / n,
+               i + 1 < BenchCases::COUNT ? "," : "");
+    }
+    printf("]}\n");
+    return 0;
+}
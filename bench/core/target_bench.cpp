@@ -0,0 +1,98 @@
+// ============================================
+// target_bench.cpp - Utilitaires, logs, gabarits et JSON, sur ESP32
+// ============================================
+//
+//   pio run -e bench_core -t upload -t monitor
+//
+// Les durées sont en cycles CPU par opération (ESP.getCycleCount()), sur
+// le cœur de loop() et sans Wi-Fi. Les allocations sont comptées en
+// enveloppant malloc/calloc/realloc à l'édition de liens
+// (-Wl,--wrap=..., voir [env:bench_core]) : String, operator new et le
+// reste du firmware passent par là. Le JSON est encadré de lignes
+// ---BEGIN--- / ---END--- pour être extrait du moniteur série.
+
+#include <Arduino.h>
+#include "BenchCases.h"
+
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *p, size_t size);
+
+    static volatile bool counting = false;
+    static volatile uint32_t allocations = 0;
+    static volatile uint32_t allocatedBytes = 0;
+    static TaskHandle_t benchTask = nullptr;
+
+    // Seules les allocations de la tâche mesurée sont comptées
+    static inline void countAllocation(size_t size)
+    {
+        if (counting && xTaskGetCurrentTaskHandle() == benchTask)
+        {
+            allocations++;
+            allocatedBytes += size;
+        }
+    }
+
+    void *__wrap_malloc(size_t size)
+    {
+        countAllocation(size);
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        countAllocation(count * size);
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *p, size_t size)
+    {
+        countAllocation(size);
+        return __real_realloc(p, size);
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+    BenchCases::setup();
+    benchTask = xTaskGetCurrentTaskHandle();
+
+    Serial.println("---BEGIN---");
+    Serial.printf("{\"suite\":\"core\",\"target\":\"%s\",\"unit\":\"cycles\",\"cpu_mhz\":%u,\"repeats\":%u,\"results\":[\n",
+                  ESP.getChipModel(), (unsigned)getCpuFrequencyMhz(), (unsigned)BenchCases::REPEATS);
+    for (size_t i = 0; i < BenchCases::COUNT; i++)
+    {
+        const BenchCases::Case &c = BenchCases::CASES[i];
+        uint32_t n = c.iterations;
+        c.body(n / 10); // chauffe : cache flash, tampons des String
+
+        // meilleure des répétitions ; allocations comptées sur la première
+        allocations = 0;
+        allocatedBytes = 0;
+        uint32_t cycles = 0;
+        for (uint32_t r = 0; r < BenchCases::REPEATS; r++)
+        {
+            counting = r == 0;
+            uint32_t t0 = ESP.getCycleCount();
+            c.body(n);
+            uint32_t elapsed = ESP.getCycleCount() - t0;
+            counting = false;
+
+            if (r == 0 || elapsed < cycles)
+                cycles = elapsed;
+            delay(10); // laisse tourner la tâche idle (chien de garde)
+        }
+
+        Serial.printf("  {\"name\":\"%s\",\"iterations\":%u,\"per_op\":%.2f,\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f}%s\n",
+                      c.name, (unsigned)n, (double)cycles / n, (double)allocations / n, (double)allocatedBytes / n,
+                      i + 1 < BenchCases::COUNT ? "," : "");
+    }
+    Serial.println("]}");
+    Serial.println("---END---");
+}
+
+void loop() { delay(1000); }
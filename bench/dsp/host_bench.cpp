@@ -0,0 +1,156 @@
+// ============================================
+// host_bench.cpp - Traitement par blocs face au traitement unitaire, sur l'hôte
+// ============================================
+//
+//   g++ -O2 -std=gnu++17 -Isrc bench/dsp/host_bench.cpp -o dsp_bench && ./dsp_bench
+//
+// utilities.h dépend d'Arduino : les références unitaires reprennent ici à
+// l'identique Statistics::addValue() et LowPassFilter::filter(). Les écarts
+// affichés vérifient que les deux chemins donnent le même résultat.
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DspKernels.h"
+
+static const size_t BLOCK = 256;
+static const uint32_t ROUNDS = 40000;
+static const uint32_t SAMPLES = BLOCK * ROUNDS;
+
+static float input[BLOCK];
+static float output[BLOCK];
+static int16_t input16[BLOCK];
+static int16_t output16[BLOCK];
+static volatile float sink;
+static volatile size_t blockLen = BLOCK; // inconnu du compilateur, comme sur la cible
+
+template <typename F>
+static double nsPerSample(F body)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    body();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / SAMPLES;
+}
+
+// Statistics::addValue()
+struct WelfordRef
+{
+    float lo = 1e30f, hi = -1e30f;
+    double mean = 0, m2 = 0;
+    uint32_t count = 0;
+
+    void add(float v)
+    {
+        if (v < lo)
+            lo = v;
+        if (v > hi)
+            hi = v;
+        count++;
+        double delta = v - mean;
+        mean += delta / count;
+        m2 += delta * (v - mean);
+    }
+};
+
+// Statistics::addValues() : blocs résumés puis combinés
+struct BlockStats
+{
+    double mean = 0, m2 = 0;
+    uint32_t count = 0;
+
+    void add(const float *x, size_t n)
+    {
+        Dsp::Moments m;
+        Dsp::moments(x, n, m);
+        double total = (double)count + m.count;
+        double delta = m.mean - mean;
+        mean += delta * m.count / total;
+        m2 += m.m2 + delta * delta * ((double)count * m.count / total);
+        count += m.count;
+    }
+};
+
+static void statistics()
+{
+    WelfordRef ref;
+    BlockStats block;
+    StatisticsQ15 q15;
+
+    double scalarNs = nsPerSample([&] {
+        for (uint32_t r = 0; r < ROUNDS; r++)
+            for (size_t i = 0; i < BLOCK; i++)
+                ref.add(input[i]);
+        sink = (float)ref.mean;
+    });
+    double blockNs = nsPerSample([&] {
+        size_t n = blockLen;
+        for (uint32_t r = 0; r < ROUNDS; r++)
+            block.add(input, n);
+        sink = (float)block.mean;
+    });
+    double q15Ns = nsPerSample([&] {
+        size_t n = blockLen;
+        for (uint32_t r = 0; r < ROUNDS; r++)
+            q15.addValues(input16, n);
+        sink = q15.getAverage();
+    });
+
+    double refSd = sqrt(ref.m2 / ref.count), blockSd = sqrt(block.m2 / block.count);
+    printf("Statistics         %6.2f ns  addValues %6.2f ns (x%.1f)  StatisticsQ15 %6.2f ns\n", scalarNs, blockNs,
+           scalarNs / blockNs, q15Ns);
+    printf("  écart-type       %.6f / %.6f / %.6f\n", refSd, blockSd, q15.getStdDev() / 32768.0);
+}
+
+static void lowPass()
+{
+    const float alpha = 0.05f;
+    float y = input[0];
+    LowPassFilterQ15 q15(alpha);
+
+    double scalarNs = nsPerSample([&] {
+        for (uint32_t r = 0; r < ROUNDS; r++)
+            for (size_t i = 0; i < BLOCK; i++)
+            {
+                // LowPassFilter::filter()
+                y += alpha * (input[i] - y);
+                output[i] = y;
+            }
+        sink = y;
+    });
+    float ref = y;
+
+    y = input[0];
+    double blockNs = nsPerSample([&] {
+        size_t n = blockLen;
+        for (uint32_t r = 0; r < ROUNDS; r++)
+            y = Dsp::ema(input, output, n, alpha, y);
+        sink = y;
+    });
+    double q15Ns = nsPerSample([&] {
+        size_t n = blockLen;
+        for (uint32_t r = 0; r < ROUNDS; r++)
+            q15.filterBlock(input16, output16, n);
+        sink = q15.getValue();
+    });
+
+    printf("LowPassFilter      %6.2f ns  filterBlock %4.2f ns (x%.1f)  LowPassFilterQ15 %6.2f ns\n", scalarNs,
+           blockNs, scalarNs / blockNs, q15Ns);
+    printf("  dernière sortie  %.6f / %.6f / %.6f\n", ref, y, Dsp::fromQ15(q15.getValue()));
+}
+
+int main()
+{
+    srand(1);
+    for (size_t i = 0; i < BLOCK; i++)
+    {
+        input[i] = 0.5f + 0.25f * sinf(i * 0.1f) + (rand() % 1000) / 10000.0f;
+        input16[i] = Dsp::toQ15(input[i]);
+    }
+    printf("%u échantillons, blocs de %zu (ns/échantillon)\n", SAMPLES, BLOCK);
+    statistics();
+    lowPass();
+    return 0;
+}
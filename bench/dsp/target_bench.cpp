@@ -0,0 +1,96 @@
+// ============================================
+// target_bench.cpp - Traitement par blocs face au traitement unitaire, sur ESP32
+// ============================================
+//
+//   pio run -e bench_dsp -t upload -t monitor
+//
+// Les durées sont en cycles CPU (ESP.getCycleCount()) par échantillon.
+// La dernière ligne indique si esp-dsp a été utilisé.
+
+#include <Arduino.h>
+#include "utilities.h"
+
+static const size_t BLOCK = 256;
+static const uint32_t ROUNDS = 200;
+static const uint32_t SAMPLES = BLOCK * ROUNDS;
+
+static float input[BLOCK];
+static float output[BLOCK];
+static int16_t input16[BLOCK];
+static int16_t output16[BLOCK];
+static volatile float sink;
+
+static float cyclesPerSample(uint32_t start) { return (float)(ESP.getCycleCount() - start) / SAMPLES; }
+
+static void statistics()
+{
+    Statistics unit, block;
+    StatisticsQ15 q15;
+
+    uint32_t t0 = ESP.getCycleCount();
+    for (uint32_t r = 0; r < ROUNDS; r++)
+        for (size_t i = 0; i < BLOCK; i++)
+            unit.addValue(input[i]);
+    float unitCycles = cyclesPerSample(t0);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t r = 0; r < ROUNDS; r++)
+        block.addValues(input, BLOCK);
+    float blockCycles = cyclesPerSample(t0);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t r = 0; r < ROUNDS; r++)
+        q15.addValues(input16, BLOCK);
+    float q15Cycles = cyclesPerSample(t0);
+
+    Serial.printf("Statistics     addValue %7.1f  addValues %6.1f (x%.1f)  StatisticsQ15 %6.1f\n", unitCycles,
+                  blockCycles, unitCycles / blockCycles, q15Cycles);
+    Serial.printf("  écart-type   %.6f / %.6f / %.6f\n", unit.getStdDev(), block.getStdDev(),
+                  q15.getStdDev() / 32768.0f);
+}
+
+static void lowPass()
+{
+    LowPassFilter unit(0.05f), block(0.05f);
+    LowPassFilterQ15 q15(0.05f);
+
+    uint32_t t0 = ESP.getCycleCount();
+    for (uint32_t r = 0; r < ROUNDS; r++)
+        for (size_t i = 0; i < BLOCK; i++)
+            output[i] = unit.filter(input[i]);
+    float unitCycles = cyclesPerSample(t0);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t r = 0; r < ROUNDS; r++)
+        block.filterBlock(input, output, BLOCK);
+    float blockCycles = cyclesPerSample(t0);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t r = 0; r < ROUNDS; r++)
+        q15.filterBlock(input16, output16, BLOCK);
+    float q15Cycles = cyclesPerSample(t0);
+
+    Serial.printf("LowPassFilter  filter   %7.1f  filterBlock %4.1f (x%.1f)  LowPassFilterQ15 %6.1f\n", unitCycles,
+                  blockCycles, unitCycles / blockCycles, q15Cycles);
+    Serial.printf("  sortie       %.6f / %.6f / %.6f\n", unit.getValue(), block.getValue(),
+                  Dsp::fromQ15(q15.getValue()));
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+    for (size_t i = 0; i < BLOCK; i++)
+    {
+        input[i] = 0.5f + 0.25f * sinf(i * 0.1f) + random(1000) / 10000.0f;
+        input16[i] = Dsp::toQ15(input[i]);
+    }
+    Serial.printf("%u échantillons, blocs de %u, %u MHz (cycles/échantillon)\n", (unsigned)SAMPLES,
+                  (unsigned)BLOCK, (unsigned)getCpuFrequencyMhz());
+    statistics();
+    lowPass();
+    sink = output[0];
+    Serial.printf("esp-dsp : %s\n", WIFIOTA_USE_ESP_DSP ? "oui" : "non");
+}
+
+void loop() { delay(1000); }
@@ -0,0 +1,180 @@
+// ============================================
+// host_bench.cpp - SpscRing face à CircularBuffer, sur la machine hôte
+// ============================================
+//
+//   g++ -O2 -std=gnu++17 -pthread -Isrc bench/spsc/host_bench.cpp -o spsc_bench && ./spsc_bench
+//
+// Un seul fil : coût brut d'un push/pop et des copies par blocs.
+// Deux fils : débit producteur -> consommateur, CircularBuffer devant alors
+// être protégé par un mutex.
+
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include "CircularBuffer.h"
+#include "SpscRing.h"
+
+static const size_t CAPACITY = 256;
+static const size_t BLOCK = 32;
+static const uint32_t ITEMS = 20000000;
+
+static volatile uint32_t sink;
+
+template <typename F>
+static double nsPerItem(F body)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    body();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / ITEMS;
+}
+
+static void singleThread()
+{
+    CircularBuffer<uint32_t, CAPACITY> circ;
+    SpscRing<uint32_t, CAPACITY> ring;
+    uint32_t block[BLOCK];
+
+    double circSingle = nsPerItem([&] {
+        uint32_t v = 0, acc = 0;
+        for (uint32_t i = 0; i < ITEMS; i++)
+        {
+            circ.push(i);
+            circ.pop(v);
+            acc += v;
+        }
+        sink = acc;
+    });
+    double ringSingle = nsPerItem([&] {
+        uint32_t v = 0, acc = 0;
+        for (uint32_t i = 0; i < ITEMS; i++)
+        {
+            ring.push(i);
+            ring.pop(v);
+            acc += v;
+        }
+        sink = acc;
+    });
+    double circBlock = nsPerItem([&] {
+        uint32_t acc = 0;
+        for (uint32_t i = 0; i < ITEMS; i += BLOCK)
+        {
+            for (size_t j = 0; j < BLOCK; j++)
+                circ.push(i + j);
+            for (size_t j = 0; j < BLOCK; j++)
+                circ.pop(block[j]);
+            acc += block[BLOCK - 1];
+        }
+        sink = acc;
+    });
+    double ringBlock = nsPerItem([&] {
+        uint32_t acc = 0;
+        for (uint32_t i = 0; i < ITEMS; i += BLOCK)
+        {
+            for (size_t j = 0; j < BLOCK; j++)
+                block[j] = i + j;
+            ring.push_n(block, BLOCK);
+            ring.pop_n(block, BLOCK);
+            acc += block[BLOCK - 1];
+        }
+        sink = acc;
+    });
+    double ringPeek = nsPerItem([&] {
+        uint32_t acc = 0;
+        for (uint32_t i = 0; i < ITEMS; i += BLOCK)
+        {
+            uint32_t *out;
+            size_t n = ring.prepare(out);
+            for (size_t j = 0; j < n && j < BLOCK; j++)
+                out[j] = i + j;
+            ring.commit(n < BLOCK ? n : BLOCK);
+            const uint32_t *in;
+            n = ring.peek(in);
+            for (size_t j = 0; j < n; j++)
+                acc += in[j];
+            ring.consume(n);
+        }
+        sink = acc;
+    });
+
+    printf("1 fil         CircularBuffer  SpscRing\n");
+    printf("  unitaire    %8.2f ns     %8.2f ns\n", circSingle, ringSingle);
+    printf("  blocs de %zu %8.2f ns     %8.2f ns (push_n/pop_n), %.2f ns (prepare/peek)\n", BLOCK, circBlock,
+           ringBlock, ringPeek);
+}
+
+static void twoThreads()
+{
+    CircularBuffer<uint32_t, CAPACITY> circ;
+    std::mutex lock;
+    SpscRing<uint32_t, CAPACITY> ring;
+    bool ordered = true;
+
+    double circNs = nsPerItem([&] {
+        std::thread producer([&] {
+            for (uint32_t i = 0; i < ITEMS;)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    while (i < ITEMS && !circ.isFull())
+                        circ.push(i++);
+                }
+                std::this_thread::yield();
+            }
+        });
+        uint32_t expected = 0, v;
+        while (expected < ITEMS)
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                while (circ.pop(v))
+                    ordered &= v == expected++;
+            }
+            std::this_thread::yield();
+        }
+        producer.join();
+    });
+
+    double ringNs = nsPerItem([&] {
+        std::thread producer([&] {
+            uint32_t block[BLOCK];
+            for (uint32_t i = 0; i < ITEMS;)
+            {
+                size_t n = 0;
+                while (n < BLOCK && i + n < ITEMS)
+                {
+                    block[n] = i + n;
+                    n++;
+                }
+                size_t pushed = ring.push_n(block, n);
+                if (pushed == 0)
+                    std::this_thread::yield(); // utile si un seul cœur
+                i += pushed;
+            }
+        });
+        uint32_t expected = 0;
+        while (expected < ITEMS)
+        {
+            const uint32_t *in;
+            size_t n = ring.peek(in);
+            for (size_t j = 0; j < n; j++)
+                ordered &= in[j] == expected++;
+            ring.consume(n);
+            if (n == 0)
+                std::this_thread::yield();
+        }
+        producer.join();
+    });
+
+    printf("2 fils        %8.2f ns     %8.2f ns   (ordre %s)\n", circNs, ringNs, ordered ? "correct" : "FAUX");
+}
+
+int main()
+{
+    printf("%u éléments uint32_t, capacité %zu\n", ITEMS, CAPACITY);
+    singleThread();
+    twoThreads();
+    return 0;
+}
@@ -0,0 +1,167 @@
+// ============================================
+// target_bench.cpp - SpscRing face à CircularBuffer, sur ESP32
+// ============================================
+//
+//   pio run -e bench_spsc -t upload -t monitor
+//
+// Les durées sont en cycles CPU (ESP.getCycleCount()). Le test sur deux
+// cœurs fait produire une tâche du cœur 0 vers loop() sur le cœur 1 ;
+// CircularBuffer y est protégé par un portMUX, seul moyen de le partager.
+
+#include <Arduino.h>
+#include "CircularBuffer.h"
+#include "SpscRing.h"
+
+static const size_t CAPACITY = 256;
+static const size_t BLOCK = 32;
+static const uint32_t ITEMS = 200000;
+static const uint32_t CROSS_ITEMS = 1000000;
+
+static CircularBuffer<uint32_t, CAPACITY> circ;
+static SpscRing<uint32_t, CAPACITY> ring;
+static portMUX_TYPE circLock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t sink;
+
+static float cyclesPerItem(uint32_t start, uint32_t items) { return (float)(ESP.getCycleCount() - start) / items; }
+
+static void singleCore()
+{
+    uint32_t v = 0, acc = 0, block[BLOCK];
+
+    uint32_t t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < ITEMS; i++)
+    {
+        circ.push(i);
+        circ.pop(v);
+        acc += v;
+    }
+    float circSingle = cyclesPerItem(t0, ITEMS);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < ITEMS; i++)
+    {
+        ring.push(i);
+        ring.pop(v);
+        acc += v;
+    }
+    float ringSingle = cyclesPerItem(t0, ITEMS);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < ITEMS; i += BLOCK)
+    {
+        for (size_t j = 0; j < BLOCK; j++)
+            circ.push(i + j);
+        for (size_t j = 0; j < BLOCK; j++)
+            circ.pop(block[j]);
+        acc += block[0];
+    }
+    float circBlock = cyclesPerItem(t0, ITEMS);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < ITEMS; i += BLOCK)
+    {
+        for (size_t j = 0; j < BLOCK; j++)
+            block[j] = i + j;
+        ring.push_n(block, BLOCK);
+        ring.pop_n(block, BLOCK);
+        acc += block[0];
+    }
+    float ringBlock = cyclesPerItem(t0, ITEMS);
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < ITEMS; i += BLOCK)
+    {
+        uint32_t *out;
+        size_t n = min(ring.prepare(out), BLOCK);
+        for (size_t j = 0; j < n; j++)
+            out[j] = i + j;
+        ring.commit(n);
+        const uint32_t *in;
+        n = ring.peek(in);
+        for (size_t j = 0; j < n; j++)
+            acc += in[j];
+        ring.consume(n);
+    }
+    float ringPeek = cyclesPerItem(t0, ITEMS);
+    sink = acc;
+
+    Serial.printf("1 cœur (cycles/élément)  CircularBuffer  SpscRing\n");
+    Serial.printf("  unitaire               %8.1f        %8.1f\n", circSingle, ringSingle);
+    Serial.printf("  blocs de %u            %8.1f        %8.1f (push_n/pop_n), %.1f (prepare/peek)\n", (unsigned)BLOCK,
+                  circBlock, ringBlock, ringPeek);
+}
+
+static void circProducer(void *)
+{
+    for (uint32_t i = 0; i < CROSS_ITEMS;)
+    {
+        portENTER_CRITICAL(&circLock);
+        while (i < CROSS_ITEMS && !circ.isFull())
+            circ.push(i++);
+        portEXIT_CRITICAL(&circLock);
+    }
+    vTaskDelete(nullptr);
+}
+
+static void ringProducer(void *)
+{
+    uint32_t block[BLOCK];
+    for (uint32_t i = 0; i < CROSS_ITEMS;)
+    {
+        size_t n = 0;
+        while (n < BLOCK && i + n < CROSS_ITEMS)
+        {
+            block[n] = i + n;
+            n++;
+        }
+        i += ring.push_n(block, n);
+    }
+    vTaskDelete(nullptr);
+}
+
+static void crossCore()
+{
+    bool ordered = true;
+    uint32_t expected = 0, v;
+
+    circ.clear();
+    uint32_t t0 = ESP.getCycleCount();
+    xTaskCreatePinnedToCore(circProducer, "circProd", 2048, nullptr, 1, nullptr, 0);
+    while (expected < CROSS_ITEMS)
+    {
+        portENTER_CRITICAL(&circLock);
+        while (circ.pop(v))
+            ordered &= v == expected++;
+        portEXIT_CRITICAL(&circLock);
+    }
+    float circCross = cyclesPerItem(t0, CROSS_ITEMS);
+
+    ring.clear();
+    expected = 0;
+    t0 = ESP.getCycleCount();
+    xTaskCreatePinnedToCore(ringProducer, "ringProd", 2048, nullptr, 1, nullptr, 0);
+    while (expected < CROSS_ITEMS)
+    {
+        const uint32_t *in;
+        size_t n = ring.peek(in);
+        for (size_t j = 0; j < n; j++)
+            ordered &= in[j] == expected++;
+        ring.consume(n);
+    }
+    float ringCross = cyclesPerItem(t0, CROSS_ITEMS);
+
+    Serial.printf("2 cœurs                  %8.1f        %8.1f (ordre %s)\n", circCross, ringCross,
+                  ordered ? "correct" : "FAUX");
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+    Serial.printf("%u éléments uint32_t, capacité %u, %u MHz\n", (unsigned)ITEMS, (unsigned)CAPACITY,
+                  (unsigned)getCpuFrequencyMhz());
+    singleCore();
+    crossCore();
+}
+
+void loop() { delay(1000); }
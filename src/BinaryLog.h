@@ -0,0 +1,185 @@
+// ============================================
+// BinaryLog.h - Trames de logs binaires (format rendu sur l'hôte)
+// ============================================
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "Hash.h"
+
+// Au lieu du texte, l'appareil émet l'empreinte FNV-1a du format, le niveau,
+// l'horodatage et les arguments bruts. Les formats restent dans le source :
+// tools/wlog_catalog.py les extrait dans un catalogue et
+// tools/wlog_decode.py reconstruit les lignes depuis une capture Serial,
+// MQTT ou /logs.
+//
+// Trame (little-endian) :
+//   0xFE 0x57          synchronisation (0xFE n'apparaît jamais en UTF-8)
+//   uint8_t  length    octets de id à la fin des arguments
+//   uint32_t id        Hash::fnv1a(format)
+//   uint32_t timestamp millis()
+//   uint8_t  level     Logger::Level
+//   arguments          étiquette d'un octet puis valeur :
+//                        'i' int32, 'I' int64, 'u' uint32, 'U' uint64,
+//                        'f' float, 'd' double, 'c' char,
+//                        's' longueur (uint8_t) puis octets
+//   uint8_t  crc       CRC-8 (polynôme 0x07) de length à la fin des arguments
+
+class BinaryLogWriter
+{
+public:
+    static const uint8_t SYNC0 = 0xFE;
+    static const uint8_t SYNC1 = 0x57;
+    static const size_t HEADER_SIZE = 12; // synchro, longueur, id, horodatage, niveau
+    static const size_t MAX_STRING = 48;  // chaînes tronquées au-delà
+
+private:
+    uint8_t *buffer;
+    size_t capacity;
+    size_t pos = 0;
+    bool overflow = false;
+
+    static uint8_t crc8(const uint8_t *data, size_t len)
+    {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            crc ^= data[i];
+            for (uint8_t b = 0; b < 8; b++)
+                crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+    void putLE(uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            put((uint8_t)(value >> (8 * i)));
+    }
+
+public:
+    // Le champ longueur tient sur un octet : trame limitée à 3 + 255 + 1 octets
+    BinaryLogWriter(uint8_t *out, size_t size) : buffer(out), capacity(size < 259 ? size : 259) {}
+
+    void put(uint8_t b)
+    {
+        // un octet réservé au CRC
+        if (pos + 1 >= capacity)
+        {
+            overflow = true;
+            return;
+        }
+        buffer[pos++] = b;
+    }
+
+    void begin(uint32_t id, uint32_t timestamp, uint8_t level)
+    {
+        pos = 0;
+        overflow = false;
+        put(SYNC0);
+        put(SYNC1);
+        put(0); // longueur, complétée par finish()
+        putLE(id, 4);
+        putLE(timestamp, 4);
+        put(level);
+    }
+
+    // Un argument est écrit entier ou pas du tout
+    template <typename T>
+    void arg(uint8_t tag, T value)
+    {
+        if (pos + 1 + sizeof(T) + 1 > capacity)
+        {
+            overflow = true;
+            return;
+        }
+        put(tag);
+        uint8_t raw[sizeof(T)];
+        memcpy(raw, &value, sizeof(T));
+        for (size_t i = 0; i < sizeof(T); i++)
+            put(raw[i]);
+    }
+
+    void str(const char *s)
+    {
+        if (s == nullptr)
+            s = "(null)";
+        size_t len = strnlen(s, MAX_STRING);
+        if (pos + 2 + len + 1 > capacity)
+        {
+            overflow = true;
+            return;
+        }
+        put('s');
+        put((uint8_t)len);
+        for (size_t i = 0; i < len; i++)
+            put((uint8_t)s[i]);
+    }
+
+    /**
+     * Complète la longueur et le CRC.
+     *
+     * @return Taille totale de la trame.
+     */
+    size_t finish()
+    {
+        buffer[2] = (uint8_t)(pos - 3);
+        buffer[pos] = crc8(buffer + 2, pos - 2);
+        return pos + 1;
+    }
+
+    bool truncated() const { return overflow; }
+};
+
+// Encodage des arguments selon leur type
+namespace BinaryLogArgs
+{
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    encode(BinaryLogWriter &w, T v)
+    {
+        if (sizeof(T) > 4)
+            w.arg<int64_t>('I', (int64_t)v);
+        else
+            w.arg<int32_t>('i', (int32_t)v);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    encode(BinaryLogWriter &w, T v)
+    {
+        if (sizeof(T) > 4)
+            w.arg<uint64_t>('U', (uint64_t)v);
+        else
+            w.arg<uint32_t>('u', (uint32_t)v);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type encode(BinaryLogWriter &w, T v)
+    {
+        w.arg<int32_t>('i', (int32_t)v);
+    }
+
+    inline void encode(BinaryLogWriter &w, char v) { w.arg<char>('c', v); }
+    inline void encode(BinaryLogWriter &w, float v) { w.arg<float>('f', v); }
+    inline void encode(BinaryLogWriter &w, double v) { w.arg<double>('d', v); }
+    inline void encode(BinaryLogWriter &w, const char *v) { w.str(v); }
+    inline void encode(BinaryLogWriter &w, char *v) { w.str(v); }
+    inline void encode(BinaryLogWriter &w, const String &v) { w.str(v.c_str()); }
+    inline void encode(BinaryLogWriter &w, const void *v) { encode(w, (uintptr_t)v); }
+
+    inline void encodeAll(BinaryLogWriter &) {}
+
+    template <typename First, typename... Rest>
+    void encodeAll(BinaryLogWriter &w, const First &first, const Rest &...rest)
+    {
+        encode(w, first);
+        encodeAll(w, rest...);
+    }
+}
+
+// Vérification -Wformat des appels binaires, sans générer de code
+int binaryLogFormatCheck(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -0,0 +1,59 @@
+// ============================================
+// CircularBuffer.h - Tampon circulaire à écrasement (sans dépendance Arduino)
+// ============================================
+#ifndef CIRCULAR_BUFFER_H
+#define CIRCULAR_BUFFER_H
+
+#include <stddef.h>
+
+// ═══════════════════════════════════════════════════════════
+// GESTIONNAIRE DE BUFFER CIRCULAIRE pour logs
+// ═══════════════════════════════════════════════════════════
+
+template <typename T, size_t SIZE>
+class CircularBuffer
+{
+private:
+    T buffer[SIZE];
+    size_t head = 0;
+    size_t tail = 0;
+    size_t count = 0;
+
+public:
+    bool push(const T &item)
+    {
+        if (count >= SIZE)
+        {
+            tail = (tail + 1) % SIZE;
+        }
+        else
+        {
+            count++;
+        }
+        buffer[head] = item;
+        head = (head + 1) % SIZE;
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        if (count == 0)
+            return false;
+        item = buffer[tail];
+        tail = (tail + 1) % SIZE;
+        count--;
+        return true;
+    }
+
+    size_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    bool isFull() const { return count >= SIZE; }
+    void clear() { head = tail = count = 0; }
+
+    T &operator[](size_t index)
+    {
+        return buffer[(tail + index) % SIZE];
+    }
+};
+
+#endif
@@ -0,0 +1,428 @@
+// ============================================
+// CommandEngine.h - Commandes texte sans allocation (Serial, MQTT, HTTP)
+// ============================================
+#ifndef COMMAND_ENGINE_H
+#define COMMAND_ENGINE_H
+
+#include <Arduino.h>
+#include "Hash.h"
+
+// Une ligne "led 1 0.5" est découpée sur place (les séparateurs deviennent
+// des '\0'), le nom de commande est mis en minuscules et haché (FNV-1a), puis
+// cherché dans une table dont les empreintes sont calculées à la
+// compilation. Les arguments sont convertis selon la signature de la
+// commande avant l'appel : le gestionnaire reçoit des valeurs typées et
+// n'a rien à analyser. Aucune allocation : tampon de ligne fixe, réponse
+// écrite dans un Print (Serial, ou CommandReply pour MQTT et HTTP).
+//
+// Signature : un caractère par argument
+//     i  entier (décimal ou 0x...)   f  flottant
+//     b  booléen (1/0, on/off, true/false)
+//     s  mot (ou "texte entre guillemets")
+//     r  reste de la ligne, en dernier
+// Les arguments après '|' sont facultatifs : "i|f" = un entier, puis un
+// flottant éventuel.
+//
+//     void cmdLed(const CommandEngine::Args &args, Print &out) {
+//         ledcWrite(0, args.getInt(0));
+//         out.println("OK");
+//     }
+//     static const CommandEngine::Command COMMANDS[] = {
+//         WIFIOTA_COMMAND("led", "i", cmdLed, "luminosité 0-255"),
+//     };
+//     CommandEngine commands(COMMANDS, sizeof(COMMANDS) / sizeof(COMMANDS[0]));
+//
+// Les noms de la table sont en minuscules ; "help" liste la table. Le même
+// moteur sert Serial (poll()), le topic de commande MQTT
+// (MQTTController::setCommandEngine()) et /cmd?line=...
+// (WiFiManagerOTA::setCommandEngine()). Les commandes HTTP s'exécutent dans
+// la tâche du serveur web, les autres dans loop().
+
+#ifndef WIFIOTA_COMMAND_LINE_SIZE
+#define WIFIOTA_COMMAND_LINE_SIZE 128
+#endif
+
+#ifndef WIFIOTA_COMMAND_MAX_ARGS
+#define WIFIOTA_COMMAND_MAX_ARGS 8
+#endif
+
+#ifndef WIFIOTA_COMMAND_REPLY_SIZE
+#define WIFIOTA_COMMAND_REPLY_SIZE 256
+#endif
+
+// Entrée de table avec l'empreinte du nom calculée à la compilation
+#define WIFIOTA_COMMAND(name, args, handler, help) {WIFIOTA_HASH(name), name, args, handler, help}
+
+// Réponse mémorisée (MQTT, HTTP), tronquée à WIFIOTA_COMMAND_REPLY_SIZE - 1
+class CommandReply : public Print
+{
+private:
+    char buffer[WIFIOTA_COMMAND_REPLY_SIZE];
+    size_t len = 0;
+
+public:
+    CommandReply() { buffer[0] = '\0'; }
+
+    size_t write(uint8_t c) override
+    {
+        if (len >= sizeof(buffer) - 1)
+            return 0;
+        buffer[len++] = (char)c;
+        buffer[len] = '\0';
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t size) override
+    {
+        size_t n = size < sizeof(buffer) - 1 - len ? size : sizeof(buffer) - 1 - len;
+        memcpy(buffer + len, data, n);
+        len += n;
+        buffer[len] = '\0';
+        return n;
+    }
+    using Print::write;
+
+    const char *c_str() const { return buffer; }
+    size_t length() const { return len; }
+    void clear()
+    {
+        len = 0;
+        buffer[0] = '\0';
+    }
+};
+
+class CommandEngine
+{
+public:
+    static const size_t MAX_ARGS = WIFIOTA_COMMAND_MAX_ARGS;
+
+    enum Result
+    {
+        OK,
+        EMPTY,    // ligne vide
+        UNKNOWN,  // commande absente de la table
+        BAD_ARGS, // arguments manquants, en trop ou mal formés
+        TOO_LONG  // ligne plus longue que WIFIOTA_COMMAND_LINE_SIZE - 1
+    };
+
+    // Arguments convertis ; les accesseurs renvoient def pour un argument
+    // facultatif absent
+    class Args
+    {
+    private:
+        union Value
+        {
+            int32_t i;
+            float f;
+            bool b;
+            const char *s;
+        };
+        Value values[MAX_ARGS];
+        size_t n = 0;
+
+        friend class CommandEngine;
+
+    public:
+        size_t count() const { return n; }
+        bool has(size_t i) const { return i < n; }
+        int32_t getInt(size_t i, int32_t def = 0) const { return i < n ? values[i].i : def; }
+        float getFloat(size_t i, float def = 0) const { return i < n ? values[i].f : def; }
+        bool getBool(size_t i, bool def = false) const { return i < n ? values[i].b : def; }
+        const char *getString(size_t i, const char *def = "") const { return i < n ? values[i].s : def; }
+    };
+
+    typedef void (*Handler)(const Args &args, Print &out);
+
+    struct Command
+    {
+        uint32_t hash; // WIFIOTA_HASH(name)
+        const char *name;
+        const char *args;
+        Handler handler;
+        const char *help;
+    };
+
+private:
+    const Command *table;
+    size_t tableSize;
+
+    // ligne Serial en cours
+    char line[WIFIOTA_COMMAND_LINE_SIZE];
+    size_t lineLength = 0;
+    bool overflow = false;
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    // Découpe le mot suivant sur place ; nullptr en fin de ligne
+    static char *nextToken(char *&cursor)
+    {
+        while (isSpace(*cursor))
+            cursor++;
+        if (*cursor == '\0')
+            return nullptr;
+        char *start = cursor;
+        char end = ' ';
+        if (*cursor == '"')
+        {
+            start = ++cursor;
+            end = '"';
+        }
+        while (*cursor != '\0' && (end == '"' ? *cursor != '"' : !isSpace(*cursor)))
+            cursor++;
+        if (*cursor != '\0')
+            *cursor++ = '\0';
+        return start;
+    }
+
+    static bool parseInt(const char *s, int32_t &value)
+    {
+        char *end;
+        long v = strtol(s, &end, 0);
+        value = (int32_t)v;
+        return end != s && *end == '\0';
+    }
+
+    static bool parseFloat(const char *s, float &value)
+    {
+        char *end;
+        value = strtof(s, &end);
+        return end != s && *end == '\0';
+    }
+
+    static bool parseBool(const char *s, bool &value)
+    {
+        if (strcasecmp(s, "1") == 0 || strcasecmp(s, "on") == 0 || strcasecmp(s, "true") == 0)
+            value = true;
+        else if (strcasecmp(s, "0") == 0 || strcasecmp(s, "off") == 0 || strcasecmp(s, "false") == 0)
+            value = false;
+        else
+            return false;
+        return true;
+    }
+
+    static const char *typeName(char type)
+    {
+        switch (type)
+        {
+        case 'i':
+            return "int";
+        case 'f':
+            return "float";
+        case 'b':
+            return "on|off";
+        case 'r':
+            return "text...";
+        default:
+            return "word";
+        }
+    }
+
+    static void printUsage(const Command &cmd, Print &out)
+    {
+        out.print(cmd.name);
+        bool optional = false;
+        for (const char *a = cmd.args ? cmd.args : ""; *a; a++)
+        {
+            if (*a == '|')
+            {
+                optional = true;
+                continue;
+            }
+            out.print(optional ? " [" : " <");
+            out.print(typeName(*a));
+            out.print(optional ? "]" : ">");
+        }
+    }
+
+    const Command *find(const char *name, size_t len) const
+    {
+        uint32_t hash = Hash::fnv1a((const uint8_t *)name, len);
+        for (size_t i = 0; i < tableSize; i++)
+            if (table[i].hash == hash && strcmp(table[i].name, name) == 0)
+                return &table[i];
+        return nullptr;
+    }
+
+    static Result badArgs(const Command &cmd, const char *reason, Print &out)
+    {
+        out.print("ERR ");
+        out.print(reason);
+        out.print(" (usage: ");
+        printUsage(cmd, out);
+        out.println(")");
+        return BAD_ARGS;
+    }
+
+    Result parseArgs(const Command &cmd, char *cursor, Args &args, Print &out) const
+    {
+        bool optional = false;
+        for (const char *a = cmd.args ? cmd.args : ""; *a; a++)
+        {
+            if (*a == '|')
+            {
+                optional = true;
+                continue;
+            }
+            if (args.n >= MAX_ARGS)
+                break;
+
+            char *token;
+            if (*a == 'r')
+            {
+                while (isSpace(*cursor))
+                    cursor++;
+                token = *cursor ? cursor : nullptr;
+                if (token)
+                {
+                    // espaces finaux retirés
+                    char *end = token + strlen(token);
+                    while (end > token && isSpace(end[-1]))
+                        *--end = '\0';
+                    cursor = end;
+                }
+            }
+            else
+            {
+                token = nextToken(cursor);
+            }
+
+            if (token == nullptr)
+            {
+                if (optional)
+                    return OK;
+                return badArgs(cmd, "argument manquant", out);
+            }
+
+            Args::Value &v = args.values[args.n];
+            bool valid = true;
+            switch (*a)
+            {
+            case 'i':
+                valid = parseInt(token, v.i);
+                break;
+            case 'f':
+                valid = parseFloat(token, v.f);
+                break;
+            case 'b':
+                valid = parseBool(token, v.b);
+                break;
+            default:
+                v.s = token;
+                break;
+            }
+            if (!valid)
+                return badArgs(cmd, "argument invalide", out);
+            args.n++;
+        }
+        if (nextToken(cursor) != nullptr)
+            return badArgs(cmd, "trop d'arguments", out);
+        return OK;
+    }
+
+    void printHelp(Print &out) const
+    {
+        for (size_t i = 0; i < tableSize; i++)
+        {
+            printUsage(table[i], out);
+            if (table[i].help)
+            {
+                out.print(" - ");
+                out.print(table[i].help);
+            }
+            out.println();
+        }
+    }
+
+public:
+    /**
+     * @param commands Table des commandes (en flash de préférence), à
+     *                 construire avec WIFIOTA_COMMAND().
+     */
+    CommandEngine(const Command *commands, size_t count) : table(commands), tableSize(count) {}
+
+    /**
+     * Exécute une ligne, découpée sur place (line est modifiée).
+     *
+     * @param out Destination de la réponse et des erreurs ("ERR ...").
+     */
+    Result execute(char *line, Print &out) const
+    {
+        char *cursor = line;
+        char *name = nextToken(cursor);
+        if (name == nullptr)
+            return EMPTY;
+        size_t len = 0;
+        for (char *c = name; *c; c++, len++)
+            *c = tolower((unsigned char)*c);
+
+        const Command *cmd = find(name, len);
+        if (cmd == nullptr)
+        {
+            if (strcmp(name, "help") == 0)
+            {
+                printHelp(out);
+                return OK;
+            }
+            out.print("ERR commande inconnue: ");
+            out.println(name);
+            return UNKNOWN;
+        }
+
+        Args args;
+        Result result = parseArgs(*cmd, cursor, args, out);
+        if (result != OK)
+            return result;
+        cmd->handler(args, out);
+        return OK;
+    }
+
+    // Exécute un texte non terminé par '\0' (charge utile MQTT), copié sur la pile
+    Result execute(const char *text, size_t length, Print &out) const
+    {
+        char copy[WIFIOTA_COMMAND_LINE_SIZE];
+        if (length >= sizeof(copy))
+        {
+            out.println("ERR ligne trop longue");
+            return TOO_LONG;
+        }
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+        return execute(copy, out);
+    }
+
+    /**
+     * Ajoute un caractère à la ligne en cours et l'exécute à la fin de
+     * ligne (\n ou \r). Pour toute source caractère par caractère.
+     */
+    void feed(char c, Print &out)
+    {
+        if (c != '\n' && c != '\r')
+        {
+            if (lineLength < sizeof(line) - 1)
+                line[lineLength++] = c;
+            else
+                overflow = true;
+            return;
+        }
+        if (overflow)
+            out.println("ERR ligne trop longue");
+        else if (lineLength > 0)
+        {
+            line[lineLength] = '\0';
+            execute(line, out);
+        }
+        lineLength = 0;
+        overflow = false;
+    }
+
+    // À appeler dans loop() : commandes tapées sur Serial, réponses sur Serial
+    void poll()
+    {
+        while (Serial.available())
+            feed((char)Serial.read(), Serial);
+    }
+
+    size_t size() const { return tableSize; }
+};
+
+#endif
@@ -0,0 +1,374 @@
+// ============================================
+// DspKernels.h - Traitement par blocs et virgule fixe (sans dépendance Arduino)
+// ============================================
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+// Noyaux utilisés par Statistics::addValues() et LowPassFilter::filterBlock(),
+// et variantes entières Q15/Q31 pour les ISR.
+//
+// Les sommes sont déroulées par 4 : sur ESP32, un tour de boucle coûte
+// autant que l'opération flottante elle-même, et quatre accumulateurs
+// indépendants laissent le FPU enchaîner les instructions. Les moyennes
+// exponentielles ne sont pas déroulées : chaque sortie dépend de la
+// précédente, il n'y a rien à paralléliser. Quand le
+// composant esp-dsp est disponible (livré avec le core Arduino ESP32),
+// le filtre passe-bas passe par son biquad optimisé en assembleur ;
+// WIFIOTA_USE_ESP_DSP=0 force la version C.
+//
+// Le FPU de l'ESP32 ne doit pas être utilisé dans une ISR : les classes
+// *Q15 / *Q31 ne font que des calculs entiers et sont forcées inline, donc
+// placées en IRAM avec la routine d'interruption qui les appelle. Elles
+// n'ont pas de section critique : copier l'objet dans une section critique
+// (portENTER_CRITICAL) pour le lire depuis une tâche.
+
+#ifndef WIFIOTA_USE_ESP_DSP
+#if defined(ESP_PLATFORM) && defined(__has_include)
+#if __has_include(<dsps_biquad.h>)
+#define WIFIOTA_USE_ESP_DSP 1
+#endif
+#endif
+#endif
+#ifndef WIFIOTA_USE_ESP_DSP
+#define WIFIOTA_USE_ESP_DSP 0
+#endif
+
+#if WIFIOTA_USE_ESP_DSP
+#include <dsps_biquad.h>
+#endif
+
+#ifndef WIFIOTA_ISR_INLINE
+#define WIFIOTA_ISR_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace Dsp
+{
+    // ═══ Flottant, par blocs ═══
+
+    // Résumé d'un bloc : combiné ensuite par Statistics (méthode de Chan)
+    struct Moments
+    {
+        uint32_t count;
+        float min;
+        float max;
+        float mean;
+        float m2; // somme des carrés des écarts à la moyenne
+    };
+
+    // Au-delà, les sommes flottantes d'un bloc perdent en précision :
+    // Statistics::addValues() découpe les tableaux plus longs.
+    static const size_t MOMENTS_BLOCK = 256;
+
+    /**
+     * Min, max, moyenne et somme des carrés des écarts de x[0..n-1], en deux
+     * passes (la seconde sur des données encore en cache). n > 0.
+     */
+    inline void moments(const float *x, size_t n, Moments &m)
+    {
+        float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        float lo = x[0], hi = x[0];
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            float a = x[i], b = x[i + 1], c = x[i + 2], d = x[i + 3];
+            s0 += a;
+            s1 += b;
+            s2 += c;
+            s3 += d;
+            float l1 = a < b ? a : b, h1 = a < b ? b : a;
+            float l2 = c < d ? c : d, h2 = c < d ? d : c;
+            if (l1 < lo)
+                lo = l1;
+            if (l2 < lo)
+                lo = l2;
+            if (h1 > hi)
+                hi = h1;
+            if (h2 > hi)
+                hi = h2;
+        }
+        for (; i < n; i++)
+        {
+            s0 += x[i];
+            if (x[i] < lo)
+                lo = x[i];
+            if (x[i] > hi)
+                hi = x[i];
+        }
+        float mean = ((s0 + s1) + (s2 + s3)) / n;
+
+        float q0 = 0, q1 = 0, q2 = 0, q3 = 0;
+        for (i = 0; i + 4 <= n; i += 4)
+        {
+            float a = x[i] - mean, b = x[i + 1] - mean, c = x[i + 2] - mean, d = x[i + 3] - mean;
+            q0 += a * a;
+            q1 += b * b;
+            q2 += c * c;
+            q3 += d * d;
+        }
+        for (; i < n; i++)
+        {
+            float a = x[i] - mean;
+            q0 += a * a;
+        }
+
+        m.count = n;
+        m.min = lo;
+        m.max = hi;
+        m.mean = mean;
+        m.m2 = (q0 + q1) + (q2 + q3);
+    }
+
+    /**
+     * Moyenne exponentielle y += alpha * (x - y) sur un bloc. in et out
+     * peuvent désigner le même tableau.
+     *
+     * @param y Dernière sortie du filtre.
+     * @return Nouvelle dernière sortie.
+     */
+    inline float ema(const float *in, float *out, size_t n, float alpha, float y)
+    {
+#if WIFIOTA_USE_ESP_DSP
+        // Biquad réduit au premier ordre : y[n] = alpha x[n] + (1 - alpha) y[n-1].
+        // En forme directe II, l'état w vaut y / alpha.
+        if (alpha > 0 && n > 0)
+        {
+            float coef[5] = {alpha, 0, 0, alpha - 1.0f, 0};
+            float w[2] = {y / alpha, 0};
+            dsps_biquad_f32(in, out, (int)n, coef, w);
+            return out[n - 1];
+        }
+#endif
+        // même expression que LowPassFilter::filter() : résultats identiques bit pour bit
+        for (size_t i = 0; i < n; i++)
+        {
+            y += alpha * (in[i] - y);
+            out[i] = y;
+        }
+        return y;
+    }
+
+    // ═══ Virgule fixe ═══
+
+    // Q15 : int16_t, 1.0 = 32768 ; Q31 : int32_t, 1.0 = 2^31 (exclus)
+    inline int16_t toQ15(float v)
+    {
+        float s = v * 32768.0f;
+        return s >= 32767.0f ? 32767 : (s <= -32768.0f ? -32768 : (int16_t)(s + (s >= 0 ? 0.5f : -0.5f)));
+    }
+
+    inline int32_t toQ31(float v)
+    {
+        double s = (double)v * 2147483648.0;
+        return s >= 2147483647.0 ? 2147483647 : (s <= -2147483648.0 ? (-2147483647 - 1) : (int32_t)s);
+    }
+
+    inline float fromQ15(int16_t v) { return v / 32768.0f; }
+    inline float fromQ31(int32_t v) { return (float)(v / 2147483648.0); }
+
+    WIFIOTA_ISR_INLINE int32_t mulQ31(int32_t a, int32_t b) { return (int32_t)(((int64_t)a * b) >> 31); }
+
+    // Q31 -> Q15 arrondi et saturé
+    WIFIOTA_ISR_INLINE int16_t roundQ15(int32_t y)
+    {
+        int32_t r = (y >> 16) + ((y >> 15) & 1);
+        return r > 32767 ? 32767 : (int16_t)r;
+    }
+
+    /**
+     * Moyenne exponentielle en Q31 : y += alpha x - alpha y, deux produits
+     * 32x32 -> 64 bits qui ne peuvent pas déborder.
+     */
+    WIFIOTA_ISR_INLINE int32_t emaQ31(const int32_t *in, int32_t *out, size_t n, int32_t alpha, int32_t y)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            y += mulQ31(in[i], alpha) - mulQ31(y, alpha);
+            out[i] = y;
+        }
+        return y;
+    }
+
+    /**
+     * Moyenne exponentielle d'un signal Q15. L'état y reste en Q31 : avec un
+     * alpha faible, un état Q15 resterait bloqué à quelques pas de la valeur
+     * d'entrée.
+     */
+    WIFIOTA_ISR_INLINE int32_t emaQ15(const int16_t *in, int16_t *out, size_t n, int32_t alpha, int32_t y)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            y += mulQ31((int32_t)in[i] << 16, alpha) - mulQ31(y, alpha);
+            out[i] = roundQ15(y);
+        }
+        return y;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════
+// VARIANTES ENTIÈRES (utilisables en ISR)
+// ═══════════════════════════════════════════════════════════
+
+// Passe-bas sur un signal Q15 ou sur des lectures ADC brutes (le filtre ne
+// suppose pas d'échelle). Le coefficient est donné en flottant, hors ISR.
+class LowPassFilterQ15
+{
+private:
+    int32_t alpha;     // Q31
+    int32_t state = 0; // Q31 (valeur << 16)
+    bool initialized = false;
+
+public:
+    explicit LowPassFilterQ15(float smoothingFactor = 0.1f) { setSmoothingFactor(smoothingFactor); }
+
+    WIFIOTA_ISR_INLINE int16_t filter(int16_t value)
+    {
+        filterBlock(&value, &value, 1);
+        return value;
+    }
+
+    WIFIOTA_ISR_INLINE void filterBlock(const int16_t *in, int16_t *out, size_t n)
+    {
+        if (n == 0)
+            return;
+        if (!initialized)
+        {
+            state = (int32_t)in[0] << 16;
+            initialized = true;
+        }
+        state = Dsp::emaQ15(in, out, n, alpha, state);
+    }
+
+    int16_t getValue() const { return Dsp::roundQ15(state); }
+    void reset() { initialized = false; }
+    void setSmoothingFactor(float factor) { alpha = Dsp::toQ31(factor < 0 ? 0 : (factor > 1 ? 1 : factor)); }
+};
+
+// Passe-bas sur un signal Q31 (ou des entiers 32 bits quelconques)
+class LowPassFilterQ31
+{
+private:
+    int32_t alpha; // Q31
+    int32_t state = 0;
+    bool initialized = false;
+
+public:
+    explicit LowPassFilterQ31(float smoothingFactor = 0.1f) { setSmoothingFactor(smoothingFactor); }
+
+    WIFIOTA_ISR_INLINE int32_t filter(int32_t value)
+    {
+        filterBlock(&value, &value, 1);
+        return value;
+    }
+
+    WIFIOTA_ISR_INLINE void filterBlock(const int32_t *in, int32_t *out, size_t n)
+    {
+        if (n == 0)
+            return;
+        if (!initialized)
+        {
+            state = in[0];
+            initialized = true;
+        }
+        state = Dsp::emaQ31(in, out, n, alpha, state);
+    }
+
+    int32_t getValue() const { return state; }
+    void reset() { initialized = false; }
+    void setSmoothingFactor(float factor) { alpha = Dsp::toQ31(factor < 0 ? 0 : (factor > 1 ? 1 : factor)); }
+};
+
+// Min, max, moyenne et écart-type d'échantillons 16 bits (Q15 ou ADC brut).
+// Sommes entières exactes : aucune dérive, quel que soit le nombre de
+// valeurs (2^32 au plus). Les getters flottants sont à appeler hors ISR.
+class StatisticsQ15
+{
+private:
+    int16_t min_val = 32767;
+    int16_t max_val = -32768;
+    int64_t sum = 0;
+    uint64_t sumSquares = 0;
+    uint32_t count = 0;
+
+public:
+    WIFIOTA_ISR_INLINE void addValue(int16_t value)
+    {
+        if (value < min_val)
+            min_val = value;
+        if (value > max_val)
+            max_val = value;
+        sum += value;
+        sumSquares += (uint32_t)((int32_t)value * value);
+        count++;
+    }
+
+    WIFIOTA_ISR_INLINE void addValues(const int16_t *values, size_t n)
+    {
+        int32_t lo = min_val, hi = max_val;
+        int64_t s = sum;
+        uint64_t q = sumSquares;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            int32_t a = values[i], b = values[i + 1], c = values[i + 2], d = values[i + 3];
+            s += (a + b) + (c + d);
+            q += (uint64_t)((uint32_t)(a * a) + (uint32_t)(b * b)) + ((uint32_t)(c * c) + (uint32_t)(d * d));
+            int32_t l1 = a < b ? a : b, h1 = a < b ? b : a;
+            int32_t l2 = c < d ? c : d, h2 = c < d ? d : c;
+            if (l1 < lo)
+                lo = l1;
+            if (l2 < lo)
+                lo = l2;
+            if (h1 > hi)
+                hi = h1;
+            if (h2 > hi)
+                hi = h2;
+        }
+        for (; i < n; i++)
+        {
+            int32_t v = values[i];
+            s += v;
+            q += (uint32_t)(v * v);
+            if (v < lo)
+                lo = v;
+            if (v > hi)
+                hi = v;
+        }
+        min_val = (int16_t)lo;
+        max_val = (int16_t)hi;
+        sum = s;
+        sumSquares = q;
+        count += n;
+    }
+
+    int16_t getMin() const { return count > 0 ? min_val : 0; }
+    int16_t getMax() const { return count > 0 ? max_val : 0; }
+    float getAverage() const { return count > 0 ? (float)((double)sum / count) : 0; }
+
+    // Variance de la population, comme Statistics
+    float getVariance() const
+    {
+        if (count < 2)
+            return 0;
+        double mean = (double)sum / count;
+        double v = (double)sumSquares / count - mean * mean;
+        return v > 0 ? (float)v : 0;
+    }
+    float getStdDev() const { return sqrtf(getVariance()); }
+
+    uint32_t getCount() const { return count; }
+
+    void reset()
+    {
+        min_val = 32767;
+        max_val = -32768;
+        sum = 0;
+        sumSquares = 0;
+        count = 0;
+    }
+};
+
+#endif
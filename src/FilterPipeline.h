@@ -0,0 +1,475 @@
+// ============================================
+// FilterPipeline.h - Chaîne de filtres composée à la compilation (sans dépendance Arduino)
+// ============================================
+#ifndef FILTER_PIPELINE_H
+#define FILTER_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <type_traits>
+#include "DspKernels.h"
+
+// Les étages (Ema, Biquad, Fir, Median, Decimator) sont des classes sans
+// méthode virtuelle ; FilterPipeline<T, Étages...> les enchaîne par
+// récursion de templates, si bien que le compilateur inline toute la
+// chaîne dans une seule fonction par échantillon.
+//
+// Chaque étage expose :
+//     bool process(T &v);  // transforme v ; false si aucune sortie (décimation)
+//     void reset();
+//
+// T vaut float, ou int16_t pour un signal Q15 (lectures ADC comprises) :
+// les étages int16_t ne font que des calculs entiers, avec un état interne
+// plus large que le signal, et peuvent donc tourner dans une ISR.
+//
+// Le code reste en C++11 (core Arduino ESP32 2.x).
+
+namespace Filters
+{
+    // ═══ Coefficients d'un biquad (formules RBJ « Audio EQ Cookbook ») ═══
+
+    // Normalisés (a0 = 1) : y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2.
+    // Stockés en float : en dessous d'une coupure de fs / 500 environ, le
+    // gain statique s'écarte de 1 de plus de 0,1 % ; décimer d'abord.
+    struct BiquadCoefficients
+    {
+        float b0, b1, b2, a1, a2;
+
+        static BiquadCoefficients lowPass(float sampleRate, float cutoff, float q = 0.70710678f)
+        {
+            double w = 2 * M_PI * cutoff / sampleRate, c = cos(w), alpha = sin(w) / (2 * q);
+            return normalize((1 - c) / 2, 1 - c, (1 - c) / 2, 1 + alpha, -2 * c, 1 - alpha);
+        }
+
+        static BiquadCoefficients highPass(float sampleRate, float cutoff, float q = 0.70710678f)
+        {
+            double w = 2 * M_PI * cutoff / sampleRate, c = cos(w), alpha = sin(w) / (2 * q);
+            return normalize((1 + c) / 2, -(1 + c), (1 + c) / 2, 1 + alpha, -2 * c, 1 - alpha);
+        }
+
+        // Gain unitaire au centre ; q = centre / largeur de bande
+        static BiquadCoefficients bandPass(float sampleRate, float center, float q)
+        {
+            double w = 2 * M_PI * center / sampleRate, c = cos(w), alpha = sin(w) / (2 * q);
+            return normalize(alpha, 0, -alpha, 1 + alpha, -2 * c, 1 - alpha);
+        }
+
+        // Réjecteur (50 Hz secteur par exemple)
+        static BiquadCoefficients notch(float sampleRate, float center, float q = 10)
+        {
+            double w = 2 * M_PI * center / sampleRate, c = cos(w), alpha = sin(w) / (2 * q);
+            return normalize(1, -2 * c, 1, 1 + alpha, -2 * c, 1 - alpha);
+        }
+
+    private:
+        static BiquadCoefficients normalize(double b0, double b1, double b2, double a0, double a1, double a2)
+        {
+            BiquadCoefficients k = {(float)(b0 / a0), (float)(b1 / a0), (float)(b2 / a0), (float)(a1 / a0),
+                                    (float)(a2 / a0)};
+            return k;
+        }
+    };
+
+    // ═══ Moyenne exponentielle (passe-bas du premier ordre) ═══
+
+    template <typename T>
+    class Ema;
+
+    template <>
+    class Ema<float>
+    {
+    private:
+        float alpha;
+        float state = 0;
+        bool initialized = false;
+
+    public:
+        explicit Ema(float smoothingFactor = 0.1f) : alpha(smoothingFactor) {}
+
+        bool process(float &v)
+        {
+            if (!initialized)
+            {
+                state = v;
+                initialized = true;
+            }
+            state += alpha * (v - state);
+            v = state;
+            return true;
+        }
+
+        void reset() { initialized = false; }
+    };
+
+    template <>
+    class Ema<int16_t>
+    {
+    private:
+        int32_t alpha;     // Q31
+        int32_t state = 0; // Q31
+        bool initialized = false;
+
+    public:
+        explicit Ema(float smoothingFactor = 0.1f) : alpha(Dsp::toQ31(smoothingFactor)) {}
+
+        WIFIOTA_ISR_INLINE bool process(int16_t &v)
+        {
+            if (!initialized)
+            {
+                state = (int32_t)v << 16;
+                initialized = true;
+            }
+            state += Dsp::mulQ31((int32_t)v << 16, alpha) - Dsp::mulQ31(state, alpha);
+            v = Dsp::roundQ15(state);
+            return true;
+        }
+
+        void reset() { initialized = false; }
+    };
+
+    // ═══ Biquad IIR (second ordre) ═══
+
+    template <typename T>
+    class Biquad;
+
+    // Forme directe II transposée : deux variables d'état, bonne précision en flottant
+    // (construit implicitement depuis des coefficients, voir FilterPipeline)
+    template <>
+    class Biquad<float>
+    {
+    private:
+        BiquadCoefficients k;
+        float s1 = 0, s2 = 0;
+
+    public:
+        Biquad(const BiquadCoefficients &coefficients = BiquadCoefficients{1, 0, 0, 0, 0})
+            : k(coefficients) {}
+
+        bool process(float &v)
+        {
+            float x = v;
+            float y = k.b0 * x + s1;
+            s1 = k.b1 * x - k.a1 * y + s2;
+            s2 = k.b2 * x - k.a2 * y;
+            v = y;
+            return true;
+        }
+
+        void reset() { s1 = s2 = 0; }
+    };
+
+    // Forme directe I : coefficients Q30 (|a1| < 2), sortie mémorisée en Q31
+    // pour que les fréquences de coupure basses ne soient pas noyées dans
+    // l'arrondi. Accumulateur 64 bits en Q45, sans débordement possible.
+    template <>
+    class Biquad<int16_t>
+    {
+    private:
+        int32_t b0, b1, b2, a1, a2; // Q30
+        int16_t x1 = 0, x2 = 0;
+        int32_t y1 = 0, y2 = 0; // Q31
+
+        static int32_t q30(float c)
+        {
+            double s = (double)c * 1073741824.0;
+            return s >= 2147483647.0 ? 2147483647 : (s <= -2147483648.0 ? (-2147483647 - 1) : (int32_t)lround(s));
+        }
+
+    public:
+        Biquad(const BiquadCoefficients &k = BiquadCoefficients{1, 0, 0, 0, 0})
+            : b0(q30(k.b0)), b1(q30(k.b1)), b2(q30(k.b2)), a1(q30(k.a1)), a2(q30(k.a2)) {}
+
+        WIFIOTA_ISR_INLINE bool process(int16_t &v)
+        {
+            int64_t acc = (int64_t)b0 * v + (int64_t)b1 * x1 + (int64_t)b2 * x2 - (((int64_t)a1 * y1) >> 16) -
+                          (((int64_t)a2 * y2) >> 16);
+            acc >>= 14;
+            int32_t y = acc > INT32_MAX ? INT32_MAX : (acc < INT32_MIN ? INT32_MIN : (int32_t)acc);
+            x2 = x1;
+            x1 = v;
+            y2 = y1;
+            y1 = y;
+            v = Dsp::roundQ15(y);
+            return true;
+        }
+
+        void reset()
+        {
+            x1 = x2 = 0;
+            y1 = y2 = 0;
+        }
+    };
+
+    // ═══ FIR court ═══
+
+    // La ligne à retard est doublée : les TAPS dernières valeurs sont
+    // toujours contiguës, sans modulo dans le produit scalaire.
+    template <typename T, size_t TAPS>
+    class Fir;
+
+    template <size_t TAPS>
+    class Fir<float, TAPS>
+    {
+    private:
+        float coeffs[TAPS];
+        float line[2 * TAPS] = {};
+        size_t pos = 0;
+
+    public:
+        explicit Fir(const float (&coefficients)[TAPS])
+        {
+            for (size_t i = 0; i < TAPS; i++)
+                coeffs[i] = coefficients[i];
+        }
+
+        bool process(float &v)
+        {
+            pos = pos == 0 ? TAPS - 1 : pos - 1;
+            line[pos] = line[pos + TAPS] = v;
+            const float *x = &line[pos];
+            float acc = 0;
+            for (size_t i = 0; i < TAPS; i++)
+                acc += coeffs[i] * x[i];
+            v = acc;
+            return true;
+        }
+
+        void reset()
+        {
+            for (size_t i = 0; i < 2 * TAPS; i++)
+                line[i] = 0;
+        }
+    };
+
+    template <size_t TAPS>
+    class Fir<int16_t, TAPS>
+    {
+    private:
+        int16_t coeffs[TAPS]; // Q15
+        int16_t line[2 * TAPS] = {};
+        size_t pos = 0;
+
+    public:
+        explicit Fir(const float (&coefficients)[TAPS])
+        {
+            for (size_t i = 0; i < TAPS; i++)
+                coeffs[i] = Dsp::toQ15(coefficients[i]);
+        }
+
+        WIFIOTA_ISR_INLINE bool process(int16_t &v)
+        {
+            pos = pos == 0 ? TAPS - 1 : pos - 1;
+            line[pos] = line[pos + TAPS] = v;
+            const int16_t *x = &line[pos];
+            int64_t acc = 1 << 14; // arrondi
+            for (size_t i = 0; i < TAPS; i++)
+                acc += (int32_t)coeffs[i] * x[i];
+            acc >>= 15;
+            v = acc > 32767 ? 32767 : (acc < -32768 ? -32768 : (int16_t)acc);
+            return true;
+        }
+
+        void reset()
+        {
+            for (size_t i = 0; i < 2 * TAPS; i++)
+                line[i] = 0;
+        }
+    };
+
+    // ═══ Médiane glissante (élimine les pics isolés) ═══
+
+    // Les N dernières valeurs restent triées : une insertion coûte O(N),
+    // à réserver aux fenêtres courtes (3 à 15 valeurs).
+    template <typename T, size_t N>
+    class Median
+    {
+        static_assert(N % 2 == 1, "Median: N doit être impair");
+
+    private:
+        T window[N];
+        T sorted[N];
+        size_t count = 0;
+        size_t pos = 0;
+
+    public:
+        WIFIOTA_ISR_INLINE bool process(T &v)
+        {
+            size_t i;
+            if (count == N)
+            {
+                // retire la valeur sortante (la dernière si introuvable : NaN)
+                for (i = 0; i + 1 < count && sorted[i] != window[pos]; i++)
+                    ;
+                for (; i + 1 < count; i++)
+                    sorted[i] = sorted[i + 1];
+                count--;
+            }
+            for (i = count; i > 0 && sorted[i - 1] > v; i--)
+                sorted[i] = sorted[i - 1];
+            sorted[i] = v;
+            count++;
+            window[pos] = v;
+            pos = (pos + 1) % N;
+            v = sorted[count / 2];
+            return true;
+        }
+
+        void reset() { count = pos = 0; }
+    };
+
+    // ═══ Décimation (moyenne de FACTOR valeurs) ═══
+
+    // Ne produit une sortie qu'une fois sur FACTOR : les étages suivants
+    // tournent à la cadence réduite. Précéder d'un passe-bas pour éviter le
+    // repliement.
+    template <typename T, size_t FACTOR>
+    class Decimator
+    {
+        static_assert(FACTOR >= 1, "Decimator: FACTOR doit être au moins 1");
+        typedef typename std::conditional<std::is_floating_point<T>::value, T, int32_t>::type Acc;
+
+    private:
+        Acc sum = 0;
+        size_t n = 0;
+
+    public:
+        WIFIOTA_ISR_INLINE bool process(T &v)
+        {
+            sum += v;
+            if (++n < FACTOR)
+                return false;
+            v = std::is_floating_point<T>::value ? (T)(sum / (Acc)FACTOR)
+                                                 : (T)((sum + (sum >= 0 ? (Acc)FACTOR / 2 : -(Acc)(FACTOR / 2))) /
+                                                       (Acc)FACTOR);
+            sum = 0;
+            n = 0;
+            return true;
+        }
+
+        void reset()
+        {
+            sum = 0;
+            n = 0;
+        }
+    };
+}
+
+// ═══════════════════════════════════════════════════════════
+// CHAÎNE DE FILTRES
+// ═══════════════════════════════════════════════════════════
+
+template <typename T, typename... Stages>
+class FilterPipeline;
+
+template <size_t I, typename P>
+struct FilterPipelineStage;
+
+// Fin de chaîne
+template <typename T>
+class FilterPipeline<T>
+{
+public:
+    WIFIOTA_ISR_INLINE bool process(T &) { return true; }
+    void reset() {}
+};
+
+/**
+ * Exemple : passe-bande 20-200 Hz sur un accéléromètre échantillonné à
+ * 1 kHz, puis médiane 5 points et décimation par 10 :
+ *
+ *     FilterPipeline<float,
+ *                    Filters::Biquad<float>, Filters::Biquad<float>,
+ *                    Filters::Median<float, 5>, Filters::Decimator<float, 10>>
+ *         vib(Filters::BiquadCoefficients::highPass(1000, 20),
+ *             Filters::BiquadCoefficients::lowPass(1000, 200), {}, {});
+ */
+template <typename T, typename First, typename... Rest>
+class FilterPipeline<T, First, Rest...>
+{
+    template <size_t I, typename U>
+    friend struct FilterPipelineStage;
+
+private:
+    First first;
+    FilterPipeline<T, Rest...> rest;
+    T last = T();
+
+public:
+    FilterPipeline() = default;
+
+    // Un argument par étage, dans l'ordre (ou {} pour les valeurs par défaut)
+    FilterPipeline(const First &f, const Rest &...r) : first(f), rest(r...) {}
+
+    /**
+     * Fait passer une valeur dans toute la chaîne (modifiée sur place).
+     *
+     * @return false si un décimateur l'a absorbée : v n'est pas une sortie.
+     */
+    WIFIOTA_ISR_INLINE bool process(T &v) { return first.process(v) && rest.process(v); }
+
+    /**
+     * Comme process(), mais retourne toujours la dernière sortie produite
+     * (utile pour chaîner avec ChangeDetector malgré la décimation).
+     */
+    T filter(T v)
+    {
+        if (process(v))
+            last = v;
+        return last;
+    }
+
+    /**
+     * Filtre n valeurs. out peut être in.
+     *
+     * @return Nombre de sorties écrites (n / facteur de décimation).
+     */
+    size_t processBlock(const T *in, T *out, size_t n)
+    {
+        size_t produced = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            T v = in[i];
+            if (process(v))
+            {
+                out[produced++] = v;
+                last = v;
+            }
+        }
+        return produced;
+    }
+
+    // Dernière sortie de filter() ou processBlock() (process() ne la mémorise pas)
+    T getValue() const { return last; }
+
+    void reset()
+    {
+        first.reset();
+        rest.reset();
+        last = T();
+    }
+
+    // Accès à l'étage I (réglage à chaud) : pipeline.stage<0>()
+    template <size_t I>
+    auto stage() -> decltype(FilterPipelineStage<I, FilterPipeline>::get(*this))
+    {
+        return FilterPipelineStage<I, FilterPipeline>::get(*this);
+    }
+};
+
+template <size_t I, typename P>
+struct FilterPipelineStage
+{
+    static auto get(P &p) -> decltype(FilterPipelineStage<I - 1, decltype(p.rest)>::get(p.rest))
+    {
+        return FilterPipelineStage<I - 1, decltype(p.rest)>::get(p.rest);
+    }
+};
+
+template <typename P>
+struct FilterPipelineStage<0, P>
+{
+    static auto get(P &p) -> decltype((p.first)) { return p.first; }
+};
+
+#endif
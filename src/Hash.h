@@ -0,0 +1,39 @@
+// ============================================
+// Hash.h - Empreintes FNV-1a calculables à la compilation
+// ============================================
+#ifndef WIFIOTA_HASH_H
+#define WIFIOTA_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+// FNV-1a 32 bits sur les octets de la chaîne (UTF-8 tel qu'écrit dans le
+// source). Écrit en constexpr C++11 (récursif) pour rester utilisable avec
+// toutes les versions du core ESP32 ; tools/wlog_catalog.py en calcule la
+// même valeur côté hôte.
+
+namespace Hash
+{
+    static const uint32_t FNV_OFFSET = 2166136261u;
+    static const uint32_t FNV_PRIME = 16777619u;
+
+    constexpr uint32_t fnv1a(const char *s, uint32_t h = FNV_OFFSET)
+    {
+        return *s == '\0' ? h : fnv1a(s + 1, (h ^ (uint8_t)*s) * FNV_PRIME);
+    }
+
+    // Variante à l'exécution pour des données quelconques
+    inline uint32_t fnv1a(const uint8_t *data, size_t len, uint32_t h = FNV_OFFSET)
+    {
+        for (size_t i = 0; i < len; i++)
+            h = (h ^ data[i]) * FNV_PRIME;
+        return h;
+    }
+}
+
+// Force l'évaluation à la compilation : la chaîne n'est pas conservée dans
+// le binaire si elle n'est utilisée qu'ici.
+#define WIFIOTA_HASH(str) (std::integral_constant<uint32_t, Hash::fnv1a(str)>::value)
+
+#endif
@@ -0,0 +1,132 @@
+// ============================================
+// InplaceFunction.h - Fonction appelable stockée sans allocation (sans dépendance Arduino)
+// ============================================
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <stddef.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Équivalent de std::function pour les lambdas qui capturent un peu d'état,
+// sans tas : l'objet appelable est construit dans un tampon de CAPACITY
+// octets. Une capture trop grande est refusée à la compilation (augmenter
+// CAPACITY ou capturer un pointeur vers l'état).
+//
+// Déplaçable mais pas copiable : une lambda qui capture un objet non
+// copiable reste acceptée.
+
+#ifndef WIFIOTA_INPLACE_FUNCTION_SIZE
+#define WIFIOTA_INPLACE_FUNCTION_SIZE (4 * sizeof(void *))
+#endif
+
+template <typename Signature, size_t CAPACITY = WIFIOTA_INPLACE_FUNCTION_SIZE>
+class InplaceFunction;
+
+template <typename R, typename... Args, size_t CAPACITY>
+class InplaceFunction<R(Args...), CAPACITY>
+{
+private:
+    typedef R (*Invoker)(void *, Args...);
+    typedef void (*Mover)(void *dst, void *src); // dst == nullptr : destruction
+
+    typename std::aligned_storage<CAPACITY, alignof(std::max_align_t)>::type storage;
+    Invoker invoker = nullptr;
+    Mover mover = nullptr;
+
+    template <typename Fn>
+    static R invoke(void *f, Args... args)
+    {
+        return (*static_cast<Fn *>(f))(std::forward<Args>(args)...);
+    }
+
+    template <typename Fn>
+    static void move(void *dst, void *src)
+    {
+        if (dst)
+            new (dst) Fn(std::move(*static_cast<Fn *>(src)));
+        static_cast<Fn *>(src)->~Fn();
+    }
+
+    void destroy()
+    {
+        if (mover)
+            mover(nullptr, &storage);
+        invoker = nullptr;
+        mover = nullptr;
+    }
+
+    void take(InplaceFunction &other)
+    {
+        if (other.mover)
+            other.mover(&storage, &other.storage);
+        invoker = other.invoker;
+        mover = other.mover;
+        other.invoker = nullptr;
+        other.mover = nullptr;
+    }
+
+public:
+    InplaceFunction() {}
+    InplaceFunction(std::nullptr_t) {}
+
+    template <typename Fn, typename D = typename std::decay<Fn>::type,
+              typename = typename std::enable_if<!std::is_same<D, InplaceFunction>::value>::type>
+    InplaceFunction(Fn &&f)
+    {
+        static_assert(sizeof(D) <= CAPACITY, "InplaceFunction : capture trop grande pour CAPACITY");
+        static_assert(alignof(D) <= alignof(std::max_align_t), "InplaceFunction : alignement non supporté");
+        if (isNull(f))
+            return;
+        new (&storage) D(std::forward<Fn>(f));
+        invoker = &invoke<D>;
+        mover = &move<D>;
+    }
+
+    InplaceFunction(InplaceFunction &&other) { take(other); }
+
+    InplaceFunction &operator=(InplaceFunction &&other)
+    {
+        if (this != &other)
+        {
+            destroy();
+            take(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t)
+    {
+        destroy();
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction &) = delete;
+    InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+    ~InplaceFunction() { destroy(); }
+
+    explicit operator bool() const { return invoker != nullptr; }
+
+    R operator()(Args... args) const
+    {
+        return invoker(const_cast<void *>(static_cast<const void *>(&storage)), std::forward<Args>(args)...);
+    }
+
+private:
+    // un pointeur de fonction nul donne une fonction vide
+    template <typename Fn>
+    static bool isNull(const Fn &f, typename std::enable_if<std::is_pointer<Fn>::value>::type * = nullptr)
+    {
+        return f == nullptr;
+    }
+    template <typename Fn>
+    static bool isNull(const Fn &, typename std::enable_if<!std::is_pointer<Fn>::value>::type * = nullptr)
+    {
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,338 @@
+// ============================================
+// OTADecompress.h - Décompression en flux des images firmware
+// ============================================
+#ifndef OTA_DECOMPRESS_H
+#define OTA_DECOMPRESS_H
+
+#include <Arduino.h>
+
+#if __has_include(<rom/miniz.h>)
+#include <rom/miniz.h>
+#else
+#include <esp32/rom/miniz.h>
+#endif
+
+// Interface commune : decode() consomme une partie de l'entrée et rend un
+// pointeur vers les octets produits (dans un tampon interne, valide jusqu'à
+// l'appel suivant). Les tampons ne sont alloués que pendant la mise à jour.
+
+// ═══════════════════════════════════════════════════════════
+// GZIP (inflate de la ROM ESP32)
+// ═══════════════════════════════════════════════════════════
+//
+// Deflate impose une fenêtre de 32 Ko : elle sert directement de tampon de
+// sortie circulaire, sans copie supplémentaire.
+
+class GzipDecoder
+{
+private:
+    enum State
+    {
+        G_HEADER,
+        G_EXTRA_LEN,
+        G_EXTRA,
+        G_NAME,
+        G_COMMENT,
+        G_HCRC,
+        G_DATA,
+        G_TRAILER
+    };
+
+    static const uint8_t FLAG_HCRC = 0x02;
+    static const uint8_t FLAG_EXTRA = 0x04;
+    static const uint8_t FLAG_NAME = 0x08;
+    static const uint8_t FLAG_COMMENT = 0x10;
+
+    State state = G_HEADER;
+    uint8_t header[10];
+    size_t headerLen = 0;
+    uint8_t flags = 0;
+    uint32_t skip = 0;
+    uint8_t extraLen[2];
+
+    tinfl_decompressor *inflator = nullptr;
+    uint8_t *dict = nullptr;
+    size_t dictOfs = 0;
+
+    // Avance dans les champs optionnels de l'en-tête
+    void nextHeaderField()
+    {
+        if (state < G_EXTRA_LEN && (flags & FLAG_EXTRA))
+        {
+            state = G_EXTRA_LEN;
+            skip = 2;
+        }
+        else if (state < G_NAME && (flags & FLAG_NAME))
+            state = G_NAME;
+        else if (state < G_COMMENT && (flags & FLAG_COMMENT))
+            state = G_COMMENT;
+        else if (state < G_HCRC && (flags & FLAG_HCRC))
+        {
+            state = G_HCRC;
+            skip = 2;
+        }
+        else
+            state = G_DATA;
+    }
+
+public:
+    ~GzipDecoder() { release(); }
+
+    bool begin()
+    {
+        release();
+        inflator = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+        dict = (uint8_t *)malloc(TINFL_LZ_DICT_SIZE);
+        if (!inflator || !dict)
+        {
+            release();
+            return false;
+        }
+        tinfl_init(inflator);
+        dictOfs = 0;
+        headerLen = 0;
+        state = G_HEADER;
+        return true;
+    }
+
+    void release()
+    {
+        free(inflator);
+        free(dict);
+        inflator = nullptr;
+        dict = nullptr;
+    }
+
+    /**
+     * @return Nombre d'octets produits dans out, ou -1 si le flux est invalide.
+     */
+    int decode(const uint8_t *in, size_t inLen, size_t &consumed, const uint8_t *&out)
+    {
+        consumed = 0;
+        if (state == G_TRAILER)
+        {
+            // CRC32 et taille finale ignorés : l'image est vérifiée par Update.end()
+            consumed = inLen;
+            return 0;
+        }
+
+        while (consumed < inLen && state != G_DATA)
+        {
+            uint8_t c = in[consumed++];
+            switch (state)
+            {
+            case G_HEADER:
+                header[headerLen++] = c;
+                if (headerLen == sizeof(header))
+                {
+                    if (header[0] != 0x1F || header[1] != 0x8B || header[2] != 8)
+                        return -1;
+                    flags = header[3];
+                    nextHeaderField();
+                }
+                break;
+            case G_EXTRA_LEN:
+                extraLen[2 - skip] = c;
+                if (--skip == 0)
+                {
+                    skip = extraLen[0] | (extraLen[1] << 8);
+                    state = G_EXTRA;
+                    if (skip == 0)
+                        nextHeaderField();
+                }
+                break;
+            case G_EXTRA:
+            case G_HCRC:
+                if (--skip == 0)
+                    nextHeaderField();
+                break;
+            case G_NAME:
+            case G_COMMENT:
+                if (c == 0)
+                    nextHeaderField();
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (state != G_DATA)
+            return 0;
+
+        size_t inSize = inLen - consumed;
+        size_t outSize = TINFL_LZ_DICT_SIZE - dictOfs;
+        tinfl_status status = tinfl_decompress(inflator, in + consumed, &inSize, dict, dict + dictOfs, &outSize,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        consumed += inSize;
+        if (status < TINFL_STATUS_DONE)
+            return -1;
+        if (status == TINFL_STATUS_DONE)
+            state = G_TRAILER;
+
+        out = dict + dictOfs;
+        dictOfs = (dictOfs + outSize) & (TINFL_LZ_DICT_SIZE - 1);
+        return (int)outSize;
+    }
+
+    bool finished() const { return state == G_TRAILER; }
+};
+
+// ═══════════════════════════════════════════════════════════
+// HEATSHRINK (LZSS à petite fenêtre)
+// ═══════════════════════════════════════════════════════════
+//
+// Flux : "HS", bits de fenêtre (4..12), bits de lookahead (3..8), puis le
+// flux heatshrink brut (bit 1 + 8 bits = littéral, bit 0 + index + compte =
+// référence arrière). La fenêtre par défaut de tools/compress_fw.py est de
+// 2 Ko.
+
+class HeatshrinkDecoder
+{
+public:
+    static const size_t OUT_SIZE = 256;
+    static const uint8_t MAX_WINDOW_BITS = 12;
+
+private:
+    enum State
+    {
+        H_HEADER,
+        H_TAG,
+        H_LITERAL,
+        H_INDEX,
+        H_COUNT,
+        H_BACKREF
+    };
+
+    State state = H_HEADER;
+    uint8_t header[4];
+    size_t headerLen = 0;
+    uint8_t windowBits = 0;
+    uint8_t lookaheadBits = 0;
+
+    uint8_t *window = nullptr;
+    uint16_t head = 0;
+    uint16_t index = 0;
+    uint16_t count = 0;
+
+    uint32_t acc = 0;
+    uint8_t accBits = 0;
+    uint8_t outBuf[OUT_SIZE];
+
+    // Lecture de bits MSB en premier, reprise possible entre deux blocs
+    int32_t getBits(uint8_t n, const uint8_t *in, size_t inLen, size_t &pos)
+    {
+        while (accBits < n)
+        {
+            if (pos >= inLen)
+                return -1;
+            acc = (acc << 8) | in[pos++];
+            accBits += 8;
+        }
+        accBits -= n;
+        int32_t value = (acc >> accBits) & ((1UL << n) - 1);
+        acc &= (1UL << accBits) - 1;
+        return value;
+    }
+
+public:
+    ~HeatshrinkDecoder() { release(); }
+
+    bool begin()
+    {
+        release();
+        state = H_HEADER;
+        headerLen = 0;
+        acc = accBits = 0;
+        head = 0;
+        return true;
+    }
+
+    void release()
+    {
+        free(window);
+        window = nullptr;
+    }
+
+    int decode(const uint8_t *in, size_t inLen, size_t &consumed, const uint8_t *&out)
+    {
+        consumed = 0;
+        size_t produced = 0;
+        uint16_t mask = (1U << windowBits) - 1;
+
+        while (produced < OUT_SIZE)
+        {
+            int32_t bits;
+            switch (state)
+            {
+            case H_HEADER:
+                if (consumed >= inLen)
+                    goto done;
+                header[headerLen++] = in[consumed++];
+                if (headerLen == sizeof(header))
+                {
+                    windowBits = header[2];
+                    lookaheadBits = header[3];
+                    if (header[0] != 'H' || header[1] != 'S' || windowBits < 4 || windowBits > MAX_WINDOW_BITS ||
+                        lookaheadBits < 3 || lookaheadBits >= windowBits)
+                        return -1;
+                    window = (uint8_t *)calloc(1, 1U << windowBits);
+                    if (!window)
+                        return -1;
+                    mask = (1U << windowBits) - 1;
+                    state = H_TAG;
+                }
+                break;
+
+            case H_TAG:
+                if ((bits = getBits(1, in, inLen, consumed)) < 0)
+                    goto done;
+                state = bits ? H_LITERAL : H_INDEX;
+                break;
+
+            case H_LITERAL:
+                if ((bits = getBits(8, in, inLen, consumed)) < 0)
+                    goto done;
+                window[head++ & mask] = (uint8_t)bits;
+                outBuf[produced++] = (uint8_t)bits;
+                state = H_TAG;
+                break;
+
+            case H_INDEX:
+                if ((bits = getBits(windowBits, in, inLen, consumed)) < 0)
+                    goto done;
+                index = bits + 1;
+                state = H_COUNT;
+                break;
+
+            case H_COUNT:
+                if ((bits = getBits(lookaheadBits, in, inLen, consumed)) < 0)
+                    goto done;
+                count = bits + 1;
+                state = H_BACKREF;
+                break;
+
+            case H_BACKREF:
+                while (count > 0 && produced < OUT_SIZE)
+                {
+                    uint8_t c = window[(uint16_t)(head - index) & mask];
+                    window[head++ & mask] = c;
+                    outBuf[produced++] = c;
+                    count--;
+                }
+                if (count == 0)
+                    state = H_TAG;
+                break;
+            }
+        }
+
+    done:
+        out = outBuf;
+        return (int)produced;
+    }
+
+    // Le flux se termine sur quelques bits de bourrage : seule une
+    // référence arrière en cours de copie indique une troncature.
+    bool finished() const { return state != H_HEADER && state != H_BACKREF && state != H_LITERAL; }
+};
+
+#endif
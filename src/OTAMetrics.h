@@ -0,0 +1,235 @@
+// ============================================
+// OTAMetrics.h - Mesures de débit et de latence des mises à jour OTA
+// ============================================
+#ifndef OTA_METRICS_H
+#define OTA_METRICS_H
+
+#include <Arduino.h>
+
+// Une mise à jour se décompose en phases dont les durées sont cumulées :
+//   transport  lecture du flux (client HTTP, PullOTA uniquement)
+//   process    temps passé dans OTAUpdater::write() : décompression,
+//              application du delta et écriture flash
+//   flash      dont appels à Update.write()
+//   verify     vérification de la base d'un patch delta
+//   finalize   Update.end() : contrôle de l'image et partition de démarrage
+// Le reste de la durée de réception (idle) est passé à attendre le réseau
+// ou à exécuter le reste de la boucle.
+//
+// Update.write() copie les données dans un tampon d'un secteur (4 Ko) et
+// n'accède à la flash que lorsqu'il est plein : effacement du secteur puis
+// programmation. Ces appels sont identifiés par l'avancement de
+// Update.progress() et mesurés à part des simples copies en tampon.
+
+class OTAMetrics
+{
+public:
+    // Histogramme des écritures de secteur : < 5, 10, 20, 50, 100 ms et au-delà
+    static const uint8_t HISTOGRAM_BUCKETS = 6;
+
+    struct Latency
+    {
+        uint32_t count = 0;
+        uint32_t minUs = 0;
+        uint32_t maxUs = 0;
+        uint64_t totalUs = 0;
+
+        void add(uint32_t us)
+        {
+            if (count == 0 || us < minUs)
+                minUs = us;
+            if (us > maxUs)
+                maxUs = us;
+            totalUs += us;
+            count++;
+        }
+
+        uint32_t avgUs() const { return count ? (uint32_t)(totalUs / count) : 0; }
+
+        String toJson() const
+        {
+            return "{\"count\":" + String(count) + ",\"minUs\":" + String(minUs) + ",\"avgUs\":" + String(avgUs()) +
+                   ",\"maxUs\":" + String(maxUs) + "}";
+        }
+    };
+
+private:
+    const char *source = "";
+    bool active = false;
+    bool completed = false;
+    bool succeeded = false;
+
+    unsigned long startUs = 0;
+    unsigned long firstByteUs = 0;
+    unsigned long lastByteUs = 0;
+    unsigned long endUs = 0;
+
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+
+    uint32_t transportUs = 0;
+    uint32_t processUs = 0;
+    uint32_t verifyUs = 0;
+    uint32_t finalizeUs = 0;
+
+    Latency chunks;
+    Latency bufferWrites;
+    Latency sectorWrites;
+    uint32_t sectorHistogram[HISTOGRAM_BUCKETS] = {0};
+
+    static uint32_t bucketLimit(uint8_t i)
+    {
+        static const uint32_t limits[HISTOGRAM_BUCKETS - 1] = {5000, 10000, 20000, 50000, 100000};
+        return limits[i];
+    }
+
+    static uint32_t toMs(uint64_t us) { return (uint32_t)((us + 500) / 1000); }
+
+public:
+    /**
+     * Remet les compteurs à zéro au début d'une mise à jour.
+     *
+     * @param origin Chemin de la mise à jour ("upload", "pull", "elegantota"...).
+     */
+    void begin(const char *origin)
+    {
+        *this = OTAMetrics();
+        source = origin;
+        active = true;
+        startUs = micros();
+    }
+
+    // Bloc reçu (avant traitement) : débit de réception
+    void recordReceive(size_t len)
+    {
+        if (!active)
+            return;
+        unsigned long now = micros();
+        if (bytesIn == 0)
+            firstByteUs = now;
+        lastByteUs = now;
+        bytesIn += len;
+    }
+
+    // Variante cumulative pour les callbacks de progression (ElegantOTA)
+    void recordProgress(size_t total)
+    {
+        if (total > bytesIn)
+            recordReceive(total - bytesIn);
+    }
+
+    void recordTransport(uint32_t us) { transportUs += us; }
+
+    void recordChunk(uint32_t us)
+    {
+        chunks.add(us);
+        processUs += us;
+    }
+
+    void recordFlashWrite(size_t len, uint32_t us, bool sectorFlushed)
+    {
+        bytesOut += len;
+        if (!sectorFlushed)
+        {
+            bufferWrites.add(us);
+            return;
+        }
+        sectorWrites.add(us);
+        uint8_t i = 0;
+        while (i < HISTOGRAM_BUCKETS - 1 && us >= bucketLimit(i))
+            i++;
+        sectorHistogram[i]++;
+    }
+
+    void recordVerify(uint32_t us) { verifyUs += us; }
+    void recordFinalize(uint32_t us) { finalizeUs += us; }
+
+    void end(bool success)
+    {
+        if (!active)
+            return;
+        active = false;
+        completed = true;
+        succeeded = success;
+        endUs = micros();
+    }
+
+    bool isActive() const { return active; }
+    bool hasResult() const { return completed; }
+    bool isSuccess() const { return succeeded; }
+    const char *getSource() const { return source; }
+    size_t getBytesIn() const { return bytesIn; }
+    size_t getBytesOut() const { return bytesOut; }
+
+    uint32_t getTotalMs() const { return toMs((active ? micros() : endUs) - startUs); }
+    uint32_t getReceiveMs() const { return bytesIn ? toMs(lastByteUs - firstByteUs) : 0; }
+
+    // Temps de réception non expliqué par le traitement : attente réseau
+    uint32_t getIdleMs() const
+    {
+        uint32_t busy = toMs((uint64_t)transportUs + processUs);
+        uint32_t receive = getReceiveMs();
+        return receive > busy ? receive - busy : 0;
+    }
+
+    // Débit de réception en octets par seconde
+    uint32_t getThroughput() const
+    {
+        uint32_t us = lastByteUs - firstByteUs;
+        return us ? (uint32_t)((uint64_t)bytesIn * 1000000ULL / us) : 0;
+    }
+
+    const Latency &getChunks() const { return chunks; }
+    const Latency &getBufferWrites() const { return bufferWrites; }
+    const Latency &getSectorWrites() const { return sectorWrites; }
+
+    uint32_t getFlashMs() const { return toMs(bufferWrites.totalUs + sectorWrites.totalUs); }
+
+    /**
+     * Résumé JSON (page /status, publication MQTT).
+     */
+    String toJson() const
+    {
+        String json = "{";
+        json += "\"source\":\"" + String(source) + "\",";
+        json += "\"state\":\"" + String(active ? "running" : (succeeded ? "success" : "failed")) + "\",";
+        json += "\"bytesIn\":" + String(bytesIn) + ",";
+        json += "\"bytesOut\":" + String(bytesOut) + ",";
+        json += "\"throughput\":" + String(getThroughput()) + ",";
+        json += "\"avgChunk\":" + String(chunks.count ? bytesIn / chunks.count : 0) + ",";
+        json += "\"phasesMs\":{";
+        json += "\"total\":" + String(getTotalMs()) + ",";
+        json += "\"receive\":" + String(getReceiveMs()) + ",";
+        json += "\"idle\":" + String(getIdleMs()) + ",";
+        json += "\"transport\":" + String(toMs(transportUs)) + ",";
+        json += "\"process\":" + String(toMs(processUs)) + ",";
+        json += "\"flash\":" + String(getFlashMs()) + ",";
+        json += "\"verify\":" + String(toMs(verifyUs)) + ",";
+        json += "\"finalize\":" + String(toMs(finalizeUs)) + "},";
+        json += "\"chunk\":" + chunks.toJson() + ",";
+        json += "\"bufferWrite\":" + bufferWrites.toJson() + ",";
+        json += "\"sectorWrite\":" + sectorWrites.toJson() + ",";
+        json += "\"sectorHistogram\":[";
+        for (uint8_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            if (i > 0)
+                json += ",";
+            json += String(sectorHistogram[i]);
+        }
+        json += "]}";
+        return json;
+    }
+
+    /**
+     * Résumé d'une ligne pour les logs.
+     */
+    String toString() const
+    {
+        return String(source) + ": " + String(bytesIn) + " octets en " + String(getTotalMs()) + " ms, " +
+               String(getThroughput() / 1024) + " Ko/s, flash " + String(getFlashMs()) + " ms (" +
+               String(sectorWrites.count) + " secteurs, moy " + String(sectorWrites.avgUs()) + " µs, max " +
+               String(sectorWrites.maxUs) + " µs), attente " + String(getIdleMs()) + " ms";
+    }
+};
+
+#endif
@@ -0,0 +1,545 @@
+// ============================================
+// OTAUpdater.h - Mise à jour firmware en flux (image complète ou delta)
+// ============================================
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <Arduino.h>
+#include <Update.h>
+#include <esp_ota_ops.h>
+#include <esp_image_format.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+#include "OTADecompress.h"
+#include "OTAMetrics.h"
+
+// ═══════════════════════════════════════════════════════════
+// SHA-256 incrémental (mbedtls)
+// ═══════════════════════════════════════════════════════════
+
+class Sha256
+{
+private:
+    mbedtls_sha256_context ctx;
+
+public:
+    Sha256() { mbedtls_sha256_init(&ctx); }
+    ~Sha256() { mbedtls_sha256_free(&ctx); }
+
+    void begin() { mbedtls_sha256_starts(&ctx, 0); }
+    void update(const uint8_t *data, size_t len) { mbedtls_sha256_update(&ctx, data, len); }
+    void finish(uint8_t out[32]) { mbedtls_sha256_finish(&ctx, out); }
+
+    static String toHex(const uint8_t digest[32])
+    {
+        static const char hex[] = "0123456789abcdef";
+        char buf[65];
+        for (int i = 0; i < 32; i++)
+        {
+            buf[i * 2] = hex[digest[i] >> 4];
+            buf[i * 2 + 1] = hex[digest[i] & 0x0F];
+        }
+        buf[64] = '\0';
+        return String(buf);
+    }
+};
+
+// ═══════════════════════════════════════════════════════════
+// MISE À JOUR OTA EN FLUX
+// ═══════════════════════════════════════════════════════════
+//
+// Le flux peut être compressé (détecté sur ses premiers octets) :
+//   1F 8B           gzip, décompressé avec l'inflate de la ROM
+//   "HS"            heatshrink (voir OTADecompress.h)
+// Le format est ensuite détecté sur les premiers octets décompressés :
+//   0xE9            image firmware complète, écrite telle quelle
+//   "WDLT"          patch delta appliqué contre la partition en cours
+//
+// Format du patch delta (little-endian, généré par tools/make_delta.py) :
+//   char     magic[4]        "WDLT"
+//   uint32_t baseSize        taille de l'image de base
+//   uint8_t  baseSha256[32]  empreinte des baseSize premiers octets de la base
+//   uint32_t targetSize      taille de l'image reconstruite
+//   uint8_t  targetSha256[32]
+//   puis des entrées jusqu'à produire targetSize octets :
+//     uint32_t diffLen       octets produits = base[pos + i] + diff[i]
+//     uint32_t extraLen      octets copiés tels quels depuis le patch
+//     int32_t  seek          déplacement de pos après le bloc diff
+//     diff[diffLen], extra[extraLen]
+//
+// La base est relue par petits blocs depuis la flash et l'image produite
+// est écrite directement dans la partition OTA inactive : seule une
+// poignée de tampons de CHUNK_SIZE octets est utilisée en RAM.
+
+class OTAUpdater
+{
+public:
+    static const size_t CHUNK_SIZE = 256;
+    static const size_t DELTA_HEADER_SIZE = 76;
+
+    enum Mode
+    {
+        IDLE,
+        RAW,
+        DELTA
+    };
+
+    enum Encoding
+    {
+        ENC_UNKNOWN,
+        ENC_NONE,
+        ENC_GZIP,
+        ENC_HEATSHRINK
+    };
+
+private:
+    enum DeltaState
+    {
+        D_HEADER,
+        D_CONTROL,
+        D_DIFF,
+        D_EXTRA
+    };
+
+    Mode mode = IDLE;
+    bool running = false;
+    bool failed = false;
+    bool completed = false; // end() réussi : image vérifiée et partition de démarrage changée
+    bool ownsUpdate = false; // Update.begin() appelé par cette instance (Update est global)
+    String lastError;
+
+    size_t expectedSize = 0;
+    size_t received = 0;
+    size_t produced = 0;
+
+    uint8_t sniff[4];
+    size_t sniffLen = 0;
+
+    // Décompression
+    Encoding encoding = ENC_UNKNOWN;
+    uint8_t magic[4];
+    size_t magicLen = 0;
+    GzipDecoder gzip;
+    HeatshrinkDecoder heatshrink;
+
+    // Delta
+    DeltaState state = D_HEADER;
+    uint8_t header[DELTA_HEADER_SIZE];
+    size_t headerLen = 0;
+    uint8_t control[12];
+    size_t controlLen = 0;
+    uint32_t baseSize = 0;
+    uint32_t targetSize = 0;
+    uint8_t targetSha[32];
+    uint32_t diffRemaining = 0;
+    uint32_t extraRemaining = 0;
+    int32_t seekAfterDiff = 0;
+    int64_t basePos = 0;
+    const esp_partition_t *basePartition = nullptr;
+    uint8_t baseChunk[CHUNK_SIZE];
+    uint8_t outChunk[CHUNK_SIZE];
+
+    Sha256 outputSha;
+    OTAMetrics metrics;
+
+    static uint32_t readLE32(const uint8_t *p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    bool fail(const String &reason)
+    {
+        lastError = reason;
+        failed = true;
+        completed = false;
+        releaseUpdate();
+        releaseDecoders();
+        running = false;
+        metrics.end(false);
+        return false;
+    }
+
+    // N'interrompt que l'écriture commencée ici, pas celle d'ElegantOTA ou d'un autre OTAUpdater
+    void releaseUpdate()
+    {
+        if (ownsUpdate && Update.isRunning())
+            Update.abort();
+        ownsUpdate = false;
+    }
+
+    bool beginUpdate(size_t size)
+    {
+        if (!Update.begin(size, U_FLASH))
+            return fail(String("Update.begin: ") + Update.errorString());
+        ownsUpdate = true;
+        return true;
+    }
+
+    void releaseDecoders()
+    {
+        gzip.release();
+        heatshrink.release();
+    }
+
+    bool emit(const uint8_t *data, size_t len)
+    {
+        if (mode == DELTA && produced + len > targetSize)
+            return fail("Patch delta: image produite trop grande");
+        // Un secteur est effacé puis programmé lorsque progress() avance
+        size_t before = Update.progress();
+        unsigned long t0 = micros();
+        size_t written = Update.write(const_cast<uint8_t *>(data), len);
+        metrics.recordFlashWrite(len, micros() - t0, Update.progress() != before);
+        if (written != len)
+            return fail(String("Écriture flash échouée: ") + Update.errorString());
+        outputSha.update(data, len);
+        produced += len;
+        return true;
+    }
+
+    bool startRaw()
+    {
+        mode = RAW;
+        // La taille annoncée est celle du flux compressé, pas celle de l'image
+        bool sizeKnown = expectedSize > 0 && encoding == ENC_NONE;
+        return beginUpdate(sizeKnown ? expectedSize : UPDATE_SIZE_UNKNOWN);
+    }
+
+    bool verifyBase(const uint8_t expected[32])
+    {
+        basePartition = esp_ota_get_running_partition();
+        if (basePartition == nullptr || baseSize > basePartition->size)
+            return fail("Patch delta: base invalide");
+
+        unsigned long t0 = micros();
+        Sha256 sha;
+        sha.begin();
+        for (uint32_t offset = 0; offset < baseSize; offset += CHUNK_SIZE)
+        {
+            size_t n = min((uint32_t)CHUNK_SIZE, baseSize - offset);
+            if (esp_partition_read(basePartition, offset, baseChunk, n) != ESP_OK)
+                return fail("Patch delta: lecture de la base échouée");
+            sha.update(baseChunk, n);
+        }
+        uint8_t digest[32];
+        sha.finish(digest);
+        metrics.recordVerify(micros() - t0);
+        if (memcmp(digest, expected, 32) != 0)
+            return fail("Patch delta: le firmware en cours ne correspond pas à la base du patch");
+        return true;
+    }
+
+    bool parseHeader()
+    {
+        baseSize = readLE32(header + 4);
+        targetSize = readLE32(header + 40);
+        memcpy(targetSha, header + 44, 32);
+
+        if (!verifyBase(header + 8))
+            return false;
+        if (!beginUpdate(targetSize))
+            return false;
+
+        basePos = 0;
+        state = D_CONTROL;
+        return true;
+    }
+
+    bool writeDelta(const uint8_t *data, size_t len)
+    {
+        while (len > 0)
+        {
+            switch (state)
+            {
+            case D_HEADER:
+            {
+                size_t n = min(len, DELTA_HEADER_SIZE - headerLen);
+                memcpy(header + headerLen, data, n);
+                headerLen += n;
+                data += n;
+                len -= n;
+                if (headerLen == DELTA_HEADER_SIZE && !parseHeader())
+                    return false;
+                break;
+            }
+
+            case D_CONTROL:
+            {
+                if (produced >= targetSize)
+                    return fail("Patch delta: données après la fin de l'image");
+                size_t n = min(len, sizeof(control) - controlLen);
+                memcpy(control + controlLen, data, n);
+                controlLen += n;
+                data += n;
+                len -= n;
+                if (controlLen == sizeof(control))
+                {
+                    diffRemaining = readLE32(control);
+                    extraRemaining = readLE32(control + 4);
+                    seekAfterDiff = (int32_t)readLE32(control + 8);
+                    controlLen = 0;
+                    if (diffRemaining > 0)
+                    {
+                        state = D_DIFF;
+                    }
+                    else
+                    {
+                        basePos += seekAfterDiff;
+                        state = extraRemaining > 0 ? D_EXTRA : D_CONTROL;
+                    }
+                }
+                break;
+            }
+
+            case D_DIFF:
+            {
+                size_t n = min(min(len, (size_t)diffRemaining), (size_t)CHUNK_SIZE);
+                if (basePos < 0 || basePos + (int64_t)n > (int64_t)baseSize)
+                    return fail("Patch delta: lecture hors de la base");
+                if (esp_partition_read(basePartition, (size_t)basePos, baseChunk, n) != ESP_OK)
+                    return fail("Patch delta: lecture de la base échouée");
+                for (size_t i = 0; i < n; i++)
+                    outChunk[i] = (uint8_t)(baseChunk[i] + data[i]);
+                if (!emit(outChunk, n))
+                    return false;
+                basePos += n;
+                diffRemaining -= n;
+                data += n;
+                len -= n;
+                if (diffRemaining == 0)
+                {
+                    basePos += seekAfterDiff;
+                    state = extraRemaining > 0 ? D_EXTRA : D_CONTROL;
+                }
+                break;
+            }
+
+            case D_EXTRA:
+            {
+                size_t n = min(len, (size_t)extraRemaining);
+                if (!emit(data, n))
+                    return false;
+                extraRemaining -= n;
+                data += n;
+                len -= n;
+                if (extraRemaining == 0)
+                    state = D_CONTROL;
+                break;
+            }
+            }
+        }
+        return true;
+    }
+
+    bool dispatch(const uint8_t *data, size_t len)
+    {
+        if (mode == RAW)
+            return emit(data, len);
+        return writeDelta(data, len);
+    }
+
+    bool decode(const uint8_t *data, size_t len)
+    {
+        if (encoding == ENC_NONE)
+            return consume(data, len);
+
+        for (;;)
+        {
+            size_t used = 0;
+            const uint8_t *out = nullptr;
+            int n = encoding == ENC_GZIP ? gzip.decode(data, len, used, out)
+                                         : heatshrink.decode(data, len, used, out);
+            if (n < 0)
+                return fail("Flux compressé invalide");
+            if (n > 0 && !consume(out, n))
+                return false;
+            data += used;
+            len -= used;
+            // n == 0 : le décodeur attend de nouvelles données
+            if (n == 0 && (used == 0 || len == 0))
+                return true;
+        }
+    }
+
+    // Flux décompressé : détection du format puis écriture
+    bool consume(const uint8_t *data, size_t len)
+    {
+        if (mode == IDLE)
+        {
+            // Les 4 premiers octets suffisent à identifier le format
+            size_t n = min(len, sizeof(sniff) - sniffLen);
+            memcpy(sniff + sniffLen, data, n);
+            sniffLen += n;
+            data += n;
+            len -= n;
+            if (sniffLen < sizeof(sniff))
+                return true;
+
+            if (sniff[0] == ESP_IMAGE_HEADER_MAGIC)
+            {
+                if (!startRaw())
+                    return false;
+            }
+            else if (memcmp(sniff, "WDLT", 4) == 0)
+            {
+                mode = DELTA;
+            }
+            else
+            {
+                return fail("Format de firmware inconnu");
+            }
+
+            if (!dispatch(sniff, sizeof(sniff)))
+                return false;
+        }
+
+        return len == 0 || dispatch(data, len);
+    }
+
+    // Détection de la compression sur les premiers octets reçus
+    bool writeChunk(const uint8_t *data, size_t len)
+    {
+        received += len;
+
+        if (encoding == ENC_UNKNOWN)
+        {
+            size_t n = min(len, sizeof(magic) - magicLen);
+            memcpy(magic + magicLen, data, n);
+            magicLen += n;
+            data += n;
+            len -= n;
+            if (magicLen < sizeof(magic))
+                return true;
+
+            if (magic[0] == 0x1F && magic[1] == 0x8B)
+            {
+                encoding = ENC_GZIP;
+                if (!gzip.begin())
+                    return fail("Mémoire insuffisante pour la décompression gzip");
+            }
+            else if (magic[0] == 'H' && magic[1] == 'S')
+            {
+                encoding = ENC_HEATSHRINK;
+                heatshrink.begin();
+            }
+            else
+            {
+                encoding = ENC_NONE;
+            }
+
+            if (!decode(magic, sizeof(magic)))
+                return false;
+        }
+
+        return len == 0 || decode(data, len);
+    }
+
+public:
+    /**
+     * Démarre une nouvelle mise à jour.
+     *
+     * @param totalSize Taille du flux attendu (0 si inconnue). Utilisée pour
+     *                  réserver la partition lorsqu'une image complète est reçue.
+     * @param source Origine du flux, reprise dans les mesures (getMetrics()).
+     * @return false si une autre mise à jour écrit déjà la flash (voir getError()).
+     */
+    bool begin(size_t totalSize = 0, const char *source = "upload")
+    {
+        if (running)
+            abort();
+        mode = IDLE;
+        running = true;
+        failed = false;
+        completed = false;
+        lastError = "";
+        expectedSize = totalSize;
+        received = produced = 0;
+        sniffLen = headerLen = controlLen = magicLen = 0;
+        encoding = ENC_UNKNOWN;
+        state = D_HEADER;
+        outputSha.begin();
+        metrics.begin(source);
+        if (Update.isRunning())
+            return fail("Mise à jour déjà en cours");
+        return true;
+    }
+
+    /**
+     * Transmet un bloc du flux reçu. Peut être appelé avec des blocs de
+     * taille quelconque (upload HTTP, téléchargement, ...).
+     *
+     * @return false si la mise à jour a échoué (voir getError()).
+     */
+    bool write(const uint8_t *data, size_t len)
+    {
+        if (!running)
+            return false;
+        metrics.recordReceive(len);
+        unsigned long t0 = micros();
+        bool ok = writeChunk(data, len);
+        metrics.recordChunk(micros() - t0);
+        return ok;
+    }
+
+    /**
+     * Termine la mise à jour : vérifie l'image produite puis marque la
+     * nouvelle partition comme partition de démarrage.
+     */
+    bool end()
+    {
+        if (!running)
+            return false;
+
+        if (mode == IDLE)
+            return fail("Flux firmware trop court");
+
+        if ((encoding == ENC_GZIP && !gzip.finished()) || (encoding == ENC_HEATSHRINK && !heatshrink.finished()))
+            return fail("Flux compressé tronqué");
+        releaseDecoders();
+
+        if (mode == DELTA)
+        {
+            if (state != D_CONTROL || produced != targetSize)
+                return fail("Patch delta incomplet");
+
+            uint8_t digest[32];
+            outputSha.finish(digest);
+            if (memcmp(digest, targetSha, 32) != 0)
+                return fail("Patch delta: empreinte de l'image reconstruite invalide");
+        }
+
+        unsigned long t0 = micros();
+        bool ok = Update.end(true);
+        metrics.recordFinalize(micros() - t0);
+        if (!ok)
+            return fail(String("Update.end: ") + Update.errorString());
+
+        ownsUpdate = false;
+        running = false;
+        completed = true;
+        metrics.end(true);
+        return true;
+    }
+
+    void abort()
+    {
+        releaseUpdate();
+        releaseDecoders();
+        running = false;
+        completed = false;
+        metrics.end(false);
+    }
+
+    bool isRunning() const { return running; }
+    bool hasFailed() const { return failed; }
+    // true seulement après un end() réussi, jusqu'au prochain begin()
+    bool isCompleted() const { return completed; }
+    Mode getMode() const { return mode; }
+    size_t getReceived() const { return received; }
+    size_t getWritten() const { return produced; }
+    const String &getError() const { return lastError; }
+    OTAMetrics &getMetrics() { return metrics; }
+    const OTAMetrics &getMetrics() const { return metrics; }
+};
+
+#endif
@@ -0,0 +1,311 @@
+// ============================================
+// PatternPlayer.h - Séquences LED / buzzer jouées par esp_timer et LEDC
+// ============================================
+#ifndef PATTERN_PLAYER_H
+#define PATTERN_PLAYER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <soc/soc_caps.h>
+
+// Un pattern est une liste d'étapes (niveau, durée, rampe ou palier) en
+// flash. Le lecteur la joue depuis la tâche esp_timer : un timer à un coup
+// réarmé à chaque changement d'étape, et toutes les
+// WIFIOTA_PATTERN_FADE_TICK_MS pendant une rampe. loop() n'intervient plus :
+// le clignotement reste régulier pendant connectToWiFi(), une OTA ou un
+// traitement long, exactement quand l'état de l'appareil compte.
+//
+// La sortie est un canal LEDC (PWM 8 bits), ou une tonalité LEDC pour un
+// buzzer passif. Une rampe est une interpolation linéaire entière ; les
+// formes courbes (PULSE) sont des tables de points précalculées, sans
+// sin() à l'exécution.
+//
+//     static const PatternStep SOS[] = {
+//         {255, 0, 150}, {0, 0, 150}, {255, 0, 150}, {0, 0, 150}, {255, 0, 150}, {0, 0, 600},
+//     };
+//     PatternPlayer player;
+//     player.begin(LED_BUILTIN);
+//     player.play(SOS);                 // en boucle
+//     player.play(Patterns::PULSE);
+//
+// play() peut être appelé depuis n'importe quelle tâche ; la table
+// d'étapes doit rester valide tant qu'elle est jouée.
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+#define WIFIOTA_LEDC_PIN_API 1 // core 3.x : LEDC adressé par broche
+#else
+#define WIFIOTA_LEDC_PIN_API 0 // core 2.x : LEDC adressé par canal
+#endif
+
+#ifndef WIFIOTA_PATTERN_PWM_FREQ
+#define WIFIOTA_PATTERN_PWM_FREQ 5000
+#endif
+
+#ifndef WIFIOTA_PATTERN_FADE_TICK_MS
+#define WIFIOTA_PATTERN_FADE_TICK_MS 20
+#endif
+
+// Premier canal LEDC pris par les lecteurs (core 2.x), en descendant, pour
+// laisser les premiers canaux au sketch
+#ifndef WIFIOTA_PATTERN_LEDC_CHANNEL
+#define WIFIOTA_PATTERN_LEDC_CHANNEL (SOC_LEDC_CHANNEL_NUM - 1)
+#endif
+
+struct PatternStep
+{
+    uint8_t level; // 0-255 : luminosité ; buzzer : son si > 0
+    uint8_t fade;  // 1 : rampe depuis le niveau précédent, 0 : palier
+    uint16_t ms;   // durée de l'étape
+};
+
+// Patterns prédéfinis de LEDManager et Buzzer
+namespace Patterns
+{
+    static const PatternStep ON[] = {{255, 0, 1000}};
+    static const PatternStep BLINK_SLOW[] = {{255, 0, 1000}, {0, 0, 1000}};
+    static const PatternStep BLINK_FAST[] = {{255, 0, 200}, {0, 0, 200}};
+    static const PatternStep HEARTBEAT[] = {{255, 0, 100}, {0, 0, 100}, {255, 0, 100}, {0, 0, 1700}};
+
+    // (sin(t * PI / 1000) + 1) * 127 échantillonné toutes les 125 ms, période 2 s
+    static const PatternStep PULSE[] = {
+        {175, 1, 125}, {216, 1, 125}, {244, 1, 125}, {254, 1, 125}, {244, 1, 125}, {216, 1, 125},
+        {175, 1, 125}, {127, 1, 125}, {78, 1, 125},  {37, 1, 125},  {9, 1, 125},   {0, 1, 125},
+        {9, 1, 125},   {37, 1, 125},  {78, 1, 125},  {127, 1, 125},
+    };
+
+    static const PatternStep ALERT[] = {{255, 0, 100}, {0, 0, 100}};
+    static const PatternStep WARNING[] = {{255, 0, 500}, {0, 0, 500}};
+}
+
+class PatternPlayer
+{
+private:
+    int pin = -1;
+    int channel = -1;
+    uint16_t toneFrequency = 0; // 0 : PWM (LED, buzzer actif)
+    esp_timer_handle_t timer = nullptr;
+
+    // demandé par play(), sous lock
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    const PatternStep *requestedSteps = nullptr;
+    size_t requestedCount = 0;
+    bool requestedRepeat = false;
+    uint32_t generation = 0;
+
+    // tâche esp_timer
+    const PatternStep *steps = nullptr;
+    size_t count = 0;
+    bool repeat = false;
+    uint32_t playing = 0;
+    size_t index = 0;
+    uint8_t from = 0; // niveau de départ de la rampe en cours
+    uint64_t stepStartUs = 0;
+    std::atomic<uint8_t> level{0};
+    std::atomic<bool> active{false};
+    bool written = false;
+
+    static void timerCallback(void *arg) { ((PatternPlayer *)arg)->tick(); }
+
+    // Canaux espacés de 2 : sur le core 2.x deux canaux voisins partagent
+    // un timer LEDC, et une tonalité changerait la fréquence de l'autre
+    static int allocateChannel()
+    {
+        static int next = WIFIOTA_PATTERN_LEDC_CHANNEL;
+        if (next < 0)
+            return -1;
+        int c = next;
+        next -= 2;
+        return c;
+    }
+
+    static uint32_t stepUs(const PatternStep &s) { return (s.ms > 0 ? s.ms : 1) * 1000UL; }
+
+    void write(uint8_t value)
+    {
+        if (written && value == level.load(std::memory_order_relaxed))
+            return;
+        level.store(value, std::memory_order_relaxed);
+        written = true;
+#if WIFIOTA_LEDC_PIN_API
+        if (toneFrequency > 0)
+            ledcWriteTone(pin, value > 0 ? toneFrequency : 0);
+        else
+            ledcWrite(pin, value);
+#else
+        if (toneFrequency > 0)
+            ledcWriteTone(channel, value > 0 ? toneFrequency : 0);
+        else
+            ledcWrite(channel, value);
+#endif
+    }
+
+    // Relance le timer tout de suite pour prendre en compte un nouveau
+    // pattern. Si le callback réarme le timer entre stop et start, start
+    // échoue : on recommence.
+    void kick()
+    {
+        if (timer == nullptr)
+            return;
+        for (int attempt = 0; attempt < 3; attempt++)
+        {
+            esp_timer_stop(timer);
+            if (esp_timer_start_once(timer, 0) == ESP_OK)
+                return;
+        }
+    }
+
+public:
+    PatternPlayer() {}
+    PatternPlayer(const PatternPlayer &) = delete;
+    PatternPlayer &operator=(const PatternPlayer &) = delete;
+
+    ~PatternPlayer()
+    {
+        if (timer)
+        {
+            esp_timer_stop(timer);
+            esp_timer_delete(timer);
+        }
+    }
+
+    /**
+     * Attache la broche à LEDC et démarre le pattern demandé avant begin().
+     *
+     * @param tone Fréquence en Hz pour un buzzer passif ; 0 : PWM (LED,
+     *             buzzer actif piloté en tout ou rien).
+     */
+    bool begin(int outputPin, uint16_t tone = 0)
+    {
+        if (timer != nullptr)
+            return true;
+        pin = outputPin;
+        toneFrequency = tone;
+        uint32_t freq = tone > 0 ? tone : WIFIOTA_PATTERN_PWM_FREQ;
+#if WIFIOTA_LEDC_PIN_API
+        if (!ledcAttach(pin, freq, 8))
+            return false;
+#else
+        channel = allocateChannel();
+        if (channel < 0)
+            return false;
+        ledcSetup(channel, freq, 8);
+        ledcAttachPin(pin, channel);
+#endif
+        write(0);
+
+        esp_timer_create_args_t args = {};
+        args.callback = timerCallback;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "pattern";
+        if (esp_timer_create(&args, &timer) != ESP_OK)
+        {
+            timer = nullptr;
+            return false;
+        }
+        kick();
+        return true;
+    }
+
+    /**
+     * Joue une liste d'étapes (nullptr / 0 étape : éteint).
+     *
+     * @param repeatSteps false : s'arrête sur le niveau de la dernière étape.
+     */
+    void play(const PatternStep *patternSteps, size_t stepCount, bool repeatSteps = true)
+    {
+        portENTER_CRITICAL(&lock);
+        requestedSteps = patternSteps;
+        requestedCount = patternSteps ? stepCount : 0;
+        requestedRepeat = repeatSteps;
+        generation++;
+        portEXIT_CRITICAL(&lock);
+        kick();
+    }
+
+    template <size_t N>
+    void play(const PatternStep (&patternSteps)[N], bool repeatSteps = true)
+    {
+        play(patternSteps, N, repeatSteps);
+    }
+
+    void stop() { play(nullptr, 0); }
+
+    /**
+     * Avance le pattern (appelé par le timer ; public pour les tests).
+     */
+    void tick()
+    {
+        uint64_t now = esp_timer_get_time();
+
+        portENTER_CRITICAL(&lock);
+        bool restart = playing != generation;
+        if (restart)
+        {
+            steps = requestedSteps;
+            count = requestedCount;
+            repeat = requestedRepeat;
+            playing = generation;
+        }
+        portEXIT_CRITICAL(&lock);
+
+        if (restart)
+        {
+            index = 0;
+            from = level.load(std::memory_order_relaxed);
+            stepStartUs = now;
+        }
+        if (count == 0)
+        {
+            active.store(false, std::memory_order_relaxed);
+            write(0);
+            return;
+        }
+        active.store(true, std::memory_order_relaxed);
+
+        // étapes écoulées ; après un retard de plus d'un cycle, on repart de maintenant
+        for (size_t skipped = 0; now - stepStartUs >= stepUs(steps[index]); skipped++)
+        {
+            if (skipped > count)
+            {
+                stepStartUs = now;
+                break;
+            }
+            from = steps[index].level;
+            stepStartUs += stepUs(steps[index]);
+            if (++index >= count)
+            {
+                if (!repeat)
+                {
+                    active.store(false, std::memory_order_relaxed);
+                    write(steps[count - 1].level);
+                    return;
+                }
+                index = 0;
+            }
+        }
+
+        const PatternStep &s = steps[index];
+        uint32_t elapsed = (uint32_t)(now - stepStartUs);
+        uint32_t duration = stepUs(s);
+        uint32_t next = duration - elapsed;
+        if (s.fade)
+        {
+            write((uint8_t)(from + ((int32_t)s.level - from) * (int32_t)(elapsed / 1000) / (int32_t)(duration / 1000)));
+            if (next > WIFIOTA_PATTERN_FADE_TICK_MS * 1000UL)
+                next = WIFIOTA_PATTERN_FADE_TICK_MS * 1000UL;
+        }
+        else
+        {
+            write(s.level);
+        }
+        esp_timer_start_once(timer, next);
+    }
+
+    uint8_t getLevel() const { return level.load(std::memory_order_relaxed); }
+    bool isPlaying() const { return active.load(std::memory_order_relaxed); }
+    bool isStarted() const { return timer != nullptr; }
+};
+
+#endif
@@ -0,0 +1,282 @@
+// ============================================
+// PullOTA.h - Téléchargement de firmware par blocs (HTTP/HTTPS)
+// ============================================
+#ifndef PULL_OTA_H
+#define PULL_OTA_H
+
+#include <Arduino.h>
+#include <functional>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include "OTAUpdater.h"
+
+// Le firmware (image complète ou patch delta) est lu par blocs de
+// CHUNK_SIZE octets et transmis directement à OTAUpdater : la RAM utilisée
+// ne dépend pas de la taille de l'image. loop() traite au plus un bloc par
+// appel pour laisser tourner le reste de la boucle (MQTT, serveur web...).
+// start() ne fait que vérifier la demande : la connexion est ouverte par
+// le premier loop(), avec un délai court, hors du callback MQTT.
+
+class PullOTA
+{
+public:
+    static const size_t CHUNK_SIZE = 1024;
+    static const unsigned long STALL_TIMEOUT_MS = 15000;
+    static const uint16_t CONNECT_TIMEOUT_MS = 1000; // connexion, puis en-têtes de la réponse
+
+    enum State
+    {
+        IDLE,
+        CONNECTING,
+        DOWNLOADING,
+        SUCCESS,
+        FAILED
+    };
+
+    typedef std::function<void(size_t done, size_t total)> ProgressCallback;
+    typedef std::function<void(bool success, const String &error)> EndCallback;
+
+private:
+    HTTPClient http;
+    WiFiClient plainClient;
+    WiFiClientSecure secureClient;
+    const char *caCert = nullptr;
+    bool allowInsecure = false;
+
+    OTAUpdater updater;
+    Sha256 sha;
+    uint8_t expectedSha[32];
+
+    State state = IDLE;
+    String lastError;
+    size_t total = 0;
+    size_t done = 0;
+    unsigned long lastData = 0;
+    uint8_t chunk[CHUNK_SIZE];
+
+    ProgressCallback progressCallback = nullptr;
+    EndCallback endCallback = nullptr;
+
+    static bool parseHex(const String &hex, uint8_t out[32])
+    {
+        if (hex.length() != 64)
+            return false;
+        for (int i = 0; i < 32; i++)
+        {
+            uint8_t byte = 0;
+            for (int j = 0; j < 2; j++)
+            {
+                char c = hex[i * 2 + j];
+                byte <<= 4;
+                if (c >= '0' && c <= '9')
+                    byte |= c - '0';
+                else if (c >= 'a' && c <= 'f')
+                    byte |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F')
+                    byte |= c - 'A' + 10;
+                else
+                    return false;
+            }
+            out[i] = byte;
+        }
+        return true;
+    }
+
+    void finish(bool success, const String &error = "")
+    {
+        http.end();
+        if (!success)
+        {
+            updater.abort();
+            lastError = error;
+        }
+        state = success ? SUCCESS : FAILED;
+        if (endCallback)
+            endCallback(success, lastError);
+    }
+
+    // Bloque au plus CONNECT_TIMEOUT_MS pour la connexion et autant pour les en-têtes
+    void connect()
+    {
+        int code = http.GET();
+        if (code != HTTP_CODE_OK)
+        {
+            finish(false, "HTTP " + String(code));
+            return;
+        }
+
+        int size = http.getSize();
+        total = size > 0 ? (size_t)size : 0;
+        sha.begin();
+        if (!updater.begin(total, "pull"))
+        {
+            finish(false, updater.getError());
+            return;
+        }
+        lastData = millis();
+        state = DOWNLOADING;
+        if (progressCallback)
+            progressCallback(0, total);
+    }
+
+    void complete()
+    {
+        uint8_t digest[32];
+        sha.finish(digest);
+        if (memcmp(digest, expectedSha, 32) != 0)
+        {
+            finish(false, "SHA-256 du téléchargement invalide: " + Sha256::toHex(digest));
+            return;
+        }
+        if (!updater.end())
+        {
+            finish(false, updater.getError());
+            return;
+        }
+        finish(true);
+    }
+
+public:
+    /**
+     * Définit le certificat racine utilisé pour les URL HTTPS. Sans
+     * certificat, une URL HTTPS est refusée (voir setInsecure()).
+     */
+    void setCACert(const char *cert) { caCert = cert; }
+
+    /**
+     * Accepte les URL HTTPS sans certificat : TLS chiffre mais le serveur
+     * n'est pas authentifié. L'empreinte SHA-256 reste vérifiée.
+     */
+    void setInsecure(bool allow = true) { allowInsecure = allow; }
+
+    void onProgress(ProgressCallback callback) { progressCallback = callback; }
+    void onEnd(EndCallback callback) { endCallback = callback; }
+
+    /**
+     * Lance le téléchargement d'un firmware.
+     *
+     * @param url URL HTTP ou HTTPS de l'image (ou du patch delta).
+     * @param sha256Hex Empreinte SHA-256 attendue du fichier téléchargé (64 caractères hexadécimaux, obligatoire).
+     * @return false si le téléchargement n'a pas pu démarrer (voir getError()).
+     */
+    bool start(const String &url, const String &sha256Hex)
+    {
+        if (isRunning())
+        {
+            lastError = "Mise à jour déjà en cours";
+            return false;
+        }
+
+        // sans empreinte, n'importe quel message du topic de commande pourrait flasher une image
+        if (!parseHex(sha256Hex, expectedSha))
+        {
+            lastError = sha256Hex.length() == 0 ? "SHA-256 manquant" : "SHA-256 invalide";
+            state = FAILED;
+            return false;
+        }
+
+        bool https = url.startsWith("https://");
+        if (https)
+        {
+            if (caCert)
+                secureClient.setCACert(caCert);
+            else if (allowInsecure)
+                secureClient.setInsecure();
+            else
+            {
+                lastError = "HTTPS sans certificat (setCACert ou setInsecure)";
+                state = FAILED;
+                return false;
+            }
+        }
+
+        // HTTP/1.0 : pas d'encodage chunked, le flux contient uniquement l'image
+        http.useHTTP10(true);
+        http.setConnectTimeout(CONNECT_TIMEOUT_MS);
+        http.setTimeout(CONNECT_TIMEOUT_MS);
+        bool opened = https ? http.begin(secureClient, url) : http.begin(plainClient, url);
+        if (!opened)
+        {
+            lastError = "URL invalide";
+            state = FAILED;
+            return false;
+        }
+
+        total = 0;
+        done = 0;
+        lastError = "";
+        state = CONNECTING;
+        return true;
+    }
+
+    /**
+     * Ouvre la connexion, puis traite au plus un bloc du téléchargement par
+     * appel. À appeler dans loop().
+     */
+    void loop()
+    {
+        if (state == CONNECTING)
+        {
+            connect();
+            return;
+        }
+        if (state != DOWNLOADING)
+            return;
+
+        WiFiClient *stream = http.getStreamPtr();
+        size_t available = stream ? stream->available() : 0;
+
+        if (available == 0)
+        {
+            bool closed = stream == nullptr || !stream->connected();
+            if (total > 0 ? done >= total : closed)
+                complete();
+            else if (closed)
+                finish(false, "Connexion fermée après " + String(done) + " octets");
+            else if (millis() - lastData > STALL_TIMEOUT_MS)
+                finish(false, "Téléchargement bloqué");
+            return;
+        }
+
+        size_t want = min(available, (size_t)CHUNK_SIZE);
+        if (total > 0)
+            want = min(want, total - done);
+        unsigned long t0 = micros();
+        size_t n = stream->readBytes(chunk, want);
+        updater.getMetrics().recordTransport(micros() - t0);
+        if (n == 0)
+            return;
+
+        lastData = millis();
+        sha.update(chunk, n);
+        if (!updater.write(chunk, n))
+        {
+            finish(false, updater.getError());
+            return;
+        }
+        done += n;
+
+        if (progressCallback)
+            progressCallback(done, total);
+
+        if (total > 0 && done >= total)
+            complete();
+    }
+
+    void abort()
+    {
+        if (isRunning())
+            finish(false, "Annulée");
+    }
+
+    // true dès start(), connexion comprise
+    bool isRunning() const { return state == CONNECTING || state == DOWNLOADING; }
+    State getState() const { return state; }
+    size_t getDone() const { return done; }
+    size_t getTotal() const { return total; }
+    const String &getError() const { return lastError; }
+    const OTAMetrics &getMetrics() const { return updater.getMetrics(); }
+};
+
+#endif
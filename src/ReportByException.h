@@ -0,0 +1,251 @@
+// ============================================
+// ReportByException.h - Publication MQTT sur changement (bande morte + battement)
+// ============================================
+#ifndef REPORT_BY_EXCEPTION_H
+#define REPORT_BY_EXCEPTION_H
+
+#include <Arduino.h>
+#include <functional>
+#include "utilities.h"
+#include "mqtt.h"
+
+// Au lieu de publier chaque mesure à intervalle fixe, chaque canal n'est
+// publié que si sa valeur s'écarte de la dernière valeur publiée d'au moins
+// sa bande morte (ChangeDetector), ou si aucun message n'est parti depuis
+// maxSilenceMs (battement : le consommateur distingue un signal stable d'un
+// capteur muet). Les mesures écartées sont comptées par canal.
+//
+// Message publié sur <publishTopic>/<canal> (ou le topic donné) :
+//     {"value":21.50,"reason":"change","suppressed":42}
+// reason vaut "change", "heartbeat" ou "forced" ; suppressed est le nombre
+// de mesures écartées depuis le message précédent.
+//
+// Un échec de publication (broker injoignable) ne perd pas le changement :
+// la dernière mesure est renvoyée toutes les RETRY_MS jusqu'au succès.
+
+#ifndef WIFIOTA_RBE_MAX_CHANNELS
+#define WIFIOTA_RBE_MAX_CHANNELS 8
+#endif
+
+class ReportByException
+{
+public:
+    static const size_t MAX_CHANNELS = WIFIOTA_RBE_MAX_CHANNELS;
+    static const uint32_t DEFAULT_MAX_SILENCE_MS = 15UL * 60 * 1000;
+    static const uint32_t RETRY_MS = 5000;
+
+    typedef std::function<bool(const String &topic, const String &payload)> PublishFunction;
+
+    struct ChannelStats
+    {
+        uint32_t changes = 0;    // publiés sur dépassement de la bande morte
+        uint32_t heartbeats = 0; // publiés à l'expiration du silence
+        uint32_t suppressed = 0; // mesures écartées
+        uint32_t failed = 0;     // publications refusées (broker, OTA...)
+
+        uint32_t published() const { return changes + heartbeats; }
+
+        // Part des mesures non publiées, en %
+        float suppressionRate() const
+        {
+            uint32_t total = published() + suppressed;
+            return total > 0 ? 100.0f * suppressed / total : 0;
+        }
+    };
+
+private:
+    enum Reason
+    {
+        CHANGE,
+        HEARTBEAT,
+        FORCED
+    };
+
+    struct Channel
+    {
+        String name;
+        String topic; // vide : <base>/<name>
+        ChangeDetector detector;
+        uint32_t maxSilenceMs = DEFAULT_MAX_SILENCE_MS;
+        uint8_t decimals = 2;
+        float lastValue = 0;
+        bool hasValue = false;
+        unsigned long lastPublish = 0;
+        unsigned long lastAttempt = 0;
+        bool pending = false; // dernier envoi échoué
+        uint32_t suppressedSinceLast = 0;
+        ChannelStats stats;
+    };
+
+    Channel channels[MAX_CHANNELS];
+    size_t count = 0;
+
+    PublishFunction publishFn;
+    std::function<String()> baseTopic;
+
+    int find(const char *name) const
+    {
+        for (size_t i = 0; i < count; i++)
+            if (channels[i].name == name)
+                return (int)i;
+        return -1;
+    }
+
+    bool send(Channel &c, float value, Reason reason, unsigned long now)
+    {
+        static const char *const REASONS[] = {"change", "heartbeat", "forced"};
+        String payload = "{\"value\":" + String(value, (unsigned int)c.decimals) + ",\"reason\":\"" +
+                         REASONS[reason] + "\",\"suppressed\":" + String(c.suppressedSinceLast) + "}";
+        String topic = c.topic.length() > 0 ? c.topic : baseTopic() + "/" + c.name;
+
+        // la valeur envoyée devient la référence de la bande morte
+        c.detector.reset();
+        c.detector.hasChanged(value);
+        c.lastAttempt = now;
+        c.pending = !publishFn(topic, payload);
+        if (c.pending)
+        {
+            c.stats.failed++;
+            return false;
+        }
+        if (reason == HEARTBEAT)
+            c.stats.heartbeats++;
+        else
+            c.stats.changes++;
+        c.lastPublish = now;
+        c.suppressedSinceLast = 0;
+        return true;
+    }
+
+public:
+    // Publie via MQTTController::publish(), sous son topic de publication
+    explicit ReportByException(MQTTController &mqtt)
+        : publishFn([&mqtt](const String &topic, const String &payload) { return mqtt.publish(topic.c_str(), payload); }),
+          baseTopic([&mqtt]() { return mqtt.getPublishTopic(); }) {}
+
+    // Publication quelconque (autre client, tests)
+    ReportByException(PublishFunction publish, const String &topicPrefix)
+        : publishFn(publish), baseTopic([topicPrefix]() { return topicPrefix; }) {}
+
+    /**
+     * Déclare un canal.
+     *
+     * @param deadband     Écart minimal avec la dernière valeur publiée.
+     * @param maxSilenceMs Republication au plus tard après ce délai (0 : jamais).
+     * @param topic        Topic complet ; vide pour <publishTopic>/<name>.
+     * @return Indice du canal, -1 si la table est pleine ou le nom déjà pris.
+     */
+    int addChannel(const String &name, float deadband, uint32_t maxSilenceMs = DEFAULT_MAX_SILENCE_MS,
+                   uint8_t decimals = 2, const String &topic = "")
+    {
+        if (count >= MAX_CHANNELS || name.length() == 0 || find(name.c_str()) >= 0)
+            return -1;
+        Channel &c = channels[count];
+        c.name = name;
+        c.topic = topic;
+        c.detector = ChangeDetector(deadband);
+        c.maxSilenceMs = maxSilenceMs;
+        c.decimals = decimals;
+        return (int)count++;
+    }
+
+    /**
+     * Nouvelle mesure d'un canal : publiée si elle sort de la bande morte
+     * ou si le silence maximal est dépassé, comptée comme écartée sinon.
+     *
+     * @return true si un message est parti.
+     */
+    bool update(int channel, float value)
+    {
+        if (channel < 0 || (size_t)channel >= count)
+            return false;
+        Channel &c = channels[channel];
+        unsigned long now = millis();
+        c.lastValue = value;
+        c.hasValue = true;
+
+        if (c.pending)
+        {
+            if (now - c.lastAttempt >= RETRY_MS)
+                return send(c, value, CHANGE, now);
+        }
+        else if (c.detector.hasChanged(value))
+        {
+            return send(c, value, CHANGE, now);
+        }
+        else if (c.maxSilenceMs > 0 && now - c.lastPublish >= c.maxSilenceMs)
+        {
+            return send(c, value, HEARTBEAT, now);
+        }
+        c.suppressedSinceLast++;
+        c.stats.suppressed++;
+        return false;
+    }
+
+    bool update(const char *name, float value) { return update(find(name), value); }
+
+    // Publie la dernière mesure sans condition (sur demande d'un superviseur par exemple)
+    bool force(int channel)
+    {
+        if (channel < 0 || (size_t)channel >= count || !channels[channel].hasValue)
+            return false;
+        Channel &c = channels[channel];
+        return send(c, c.lastValue, FORCED, millis());
+    }
+
+    /**
+     * À appeler dans loop() : renvoie les messages en échec et envoie le
+     * battement des canaux que update() n'a pas rafraîchis depuis maxSilenceMs.
+     */
+    void loop()
+    {
+        unsigned long now = millis();
+        for (size_t i = 0; i < count; i++)
+        {
+            Channel &c = channels[i];
+            if (!c.hasValue)
+                continue;
+            if (c.pending)
+            {
+                if (now - c.lastAttempt >= RETRY_MS)
+                    send(c, c.lastValue, CHANGE, now);
+            }
+            else if (c.maxSilenceMs > 0 && now - c.lastPublish >= c.maxSilenceMs)
+            {
+                send(c, c.lastValue, HEARTBEAT, now);
+            }
+        }
+    }
+
+    size_t getChannelCount() const { return count; }
+    const ChannelStats *getStats(int channel) const
+    {
+        return channel >= 0 && (size_t)channel < count ? &channels[channel].stats : nullptr;
+    }
+    const ChannelStats *getStats(const char *name) const { return getStats(find(name)); }
+
+    void resetStats()
+    {
+        for (size_t i = 0; i < count; i++)
+            channels[i].stats = ChannelStats();
+    }
+
+    // {"temperature":{"changes":3,"heartbeats":1,"suppressed":96,"failed":0,"rate":96.0},...}
+    String statsJSON() const
+    {
+        String json = "{";
+        for (size_t i = 0; i < count; i++)
+        {
+            const ChannelStats &s = channels[i].stats;
+            if (i > 0)
+                json += ",";
+            json += "\"" + channels[i].name + "\":{\"changes\":" + String(s.changes) +
+                    ",\"heartbeats\":" + String(s.heartbeats) + ",\"suppressed\":" + String(s.suppressed) +
+                    ",\"failed\":" + String(s.failed) + ",\"rate\":" + String(s.suppressionRate(), 1) + "}";
+        }
+        json += "}";
+        return json;
+    }
+};
+
+#endif
@@ -0,0 +1,160 @@
+// ============================================
+// SpscRing.h - File circulaire sans verrou, un producteur / un consommateur
+// ============================================
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+// Contrairement à CircularBuffer, la file peut être partagée sans section
+// critique entre exactement un producteur et un consommateur : ISR ou tâche
+// d'acquisition d'un côté, loop() de l'autre, éventuellement sur deux cœurs.
+//
+// head n'est écrit que par le producteur, tail que par le consommateur. Les
+// index courent librement et sont ramenés dans le tampon par un masque
+// (SIZE puissance de 2) : pas de division, et head - tail donne toujours le
+// nombre d'éléments, même après débordement de size_t. La publication d'un
+// index (release) rend visibles les éléments copiés avant elle pour l'autre
+// côté (acquire).
+//
+// La file ne remplace jamais d'éléments : push() échoue quand elle est
+// pleine. Les méthodes sont forcées inline : appelées depuis une ISR en
+// IRAM, elles y sont compilées avec elle, sans appel vers la flash. T doit
+// alors rester un type simple (pas de String).
+
+#ifndef WIFIOTA_ISR_INLINE
+#define WIFIOTA_ISR_INLINE inline __attribute__((always_inline))
+#endif
+
+template <typename T, size_t SIZE>
+class SpscRing
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SpscRing: SIZE doit être une puissance de 2");
+
+public:
+    static const size_t MASK = SIZE - 1;
+
+private:
+    T buffer[SIZE];
+    std::atomic<size_t> head{0}; // prochain emplacement écrit (producteur)
+    std::atomic<size_t> tail{0}; // prochain emplacement lu (consommateur)
+
+    static WIFIOTA_ISR_INLINE size_t minSize(size_t a, size_t b) { return a < b ? a : b; }
+
+public:
+    // ═══ Côté producteur ═══
+
+    WIFIOTA_ISR_INLINE bool push(const T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == SIZE)
+            return false;
+        buffer[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Variante par déplacement, pour les éléments non copiables (InplaceFunction)
+    WIFIOTA_ISR_INLINE bool push(T &&item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == SIZE)
+            return false;
+        buffer[h & MASK] = std::move(item);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Ajoute jusqu'à n éléments (en deux copies au plus).
+     *
+     * @return Nombre d'éléments ajoutés, inférieur à n si la file est pleine.
+     */
+    WIFIOTA_ISR_INLINE size_t push_n(const T *items, size_t n)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        n = minSize(n, SIZE - (h - tail.load(std::memory_order_acquire)));
+        size_t first = minSize(n, SIZE - (h & MASK));
+        for (size_t i = 0; i < first; i++)
+            buffer[(h & MASK) + i] = items[i];
+        for (size_t i = first; i < n; i++)
+            buffer[i - first] = items[i];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Zone libre contiguë, pour écrire directement dans la file (DMA,
+     * lecture de capteur...). À valider avec commit().
+     *
+     * @return Nombre d'emplacements disponibles à partir de data.
+     */
+    WIFIOTA_ISR_INLINE size_t prepare(T *&data)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        data = &buffer[h & MASK];
+        return minSize(SIZE - (h - tail.load(std::memory_order_acquire)), SIZE - (h & MASK));
+    }
+
+    WIFIOTA_ISR_INLINE void commit(size_t n) { head.store(head.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    // ═══ Côté consommateur ═══
+
+    WIFIOTA_ISR_INLINE bool pop(T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t)
+            return false;
+        item = std::move(buffer[t & MASK]);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Retire jusqu'à n éléments.
+     *
+     * @return Nombre d'éléments copiés dans items.
+     */
+    WIFIOTA_ISR_INLINE size_t pop_n(T *items, size_t n)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        n = minSize(n, head.load(std::memory_order_acquire) - t);
+        size_t first = minSize(n, SIZE - (t & MASK));
+        for (size_t i = 0; i < first; i++)
+            items[i] = buffer[(t & MASK) + i];
+        for (size_t i = first; i < n; i++)
+            items[i] = buffer[i - first];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Éléments lisibles sans copie. La zone s'arrête à la fin du tampon : un
+     * second appel après consume() donne la suite.
+     *
+     * @return Nombre d'éléments contigus à partir de data.
+     */
+    WIFIOTA_ISR_INLINE size_t peek(const T *&data) const
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        data = &buffer[t & MASK];
+        return minSize(head.load(std::memory_order_acquire) - t, SIZE - (t & MASK));
+    }
+
+    // Libère n éléments lus avec peek()
+    WIFIOTA_ISR_INLINE void consume(size_t n) { tail.store(tail.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    // Vide la file (consommateur uniquement)
+    WIFIOTA_ISR_INLINE void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // ═══ État (instantané, exact du côté qui appelle) ═══
+
+    WIFIOTA_ISR_INLINE size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    WIFIOTA_ISR_INLINE bool isEmpty() const { return size() == 0; }
+    WIFIOTA_ISR_INLINE bool isFull() const { return size() >= SIZE; }
+    static constexpr size_t capacity() { return SIZE; }
+};
+
+#endif
@@ -0,0 +1,501 @@
+// ============================================
+// TaskScheduler.h - Tâches périodiques et différées sur tas binaire
+// ============================================
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include "InplaceFunction.h"
+
+// Les tâches sont rangées dans un tas binaire (min-heap) par échéance :
+// run() ne regarde que la première, et ne coûte donc presque rien tant que
+// rien n'est dû ; ajouter, annuler ou replanifier une tâche coûte
+// O(log n). timeUntilNext() donne le délai jusqu'à la prochaine échéance
+// pour dormir (delay(), vTaskDelay(), light sleep) au lieu de boucler.
+//
+// Les fonctions sont des InplaceFunction : une lambda peut capturer un peu
+// d'état (WIFIOTA_TASK_CAPTURE_SIZE octets), sans allocation. Les noms sont
+// copiés dans un tableau fixe, tronqués à WIFIOTA_TASK_NAME_SIZE - 1.
+//
+// Une tâche périodique garde sa cadence (échéance += intervalle) ; après un
+// retard de plus d'une période, les exécutions manquées sont sautées au
+// lieu d'être rattrapées en rafale.
+//
+// Une tâche peut en ajouter ou en annuler d'autres, ou s'annuler elle-même,
+// depuis sa fonction. Pas de section critique : à utiliser depuis une
+// seule tâche FreeRTOS (loop() en général).
+//
+// Chaque tâche périodique est profilée : durée d'exécution (min/moy/max et
+// histogramme, en µs via micros()), retard du démarrage sur l'échéance (ms),
+// dépassements de budget et périodes sautées. Le budget vaut l'intervalle
+// par défaut ; setBudget() le réduit (tâche de régulation à 10 ms qui ne
+// doit pas dépasser 2 ms par exemple). statsJSON() est servi sur /status
+// par WiFiManagerOTA::setScheduler().
+
+#ifndef WIFIOTA_SCHEDULER_MAX_TASKS
+#define WIFIOTA_SCHEDULER_MAX_TASKS 16
+#endif
+
+#ifndef WIFIOTA_TASK_CAPTURE_SIZE
+#define WIFIOTA_TASK_CAPTURE_SIZE (4 * sizeof(void *))
+#endif
+
+#ifndef WIFIOTA_TASK_NAME_SIZE
+#define WIFIOTA_TASK_NAME_SIZE 16
+#endif
+
+class TaskScheduler
+{
+public:
+    static const size_t MAX_TASKS = WIFIOTA_SCHEDULER_MAX_TASKS;
+    static const uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
+    typedef InplaceFunction<void(), WIFIOTA_TASK_CAPTURE_SIZE> Callback;
+
+    // Appelée après une exécution plus longue que le budget de la tâche
+    typedef InplaceFunction<void(const char *name, uint32_t durationUs, uint32_t budgetUs)> OverrunCallback;
+
+    // Classes de l'histogramme des durées : ≤ 100 µs, 500 µs, 1, 2, 5, 10,
+    // 50 ms, puis tout le reste
+    static const size_t HISTOGRAM_BINS = 8;
+
+    struct TaskProfile
+    {
+        uint32_t runs = 0;
+        uint32_t minUs = 0;
+        uint32_t maxUs = 0;
+        uint64_t totalUs = 0;
+        uint32_t maxLateMs = 0;   // démarrage le plus tardif après l'échéance
+        uint64_t totalLateMs = 0;
+        uint32_t overruns = 0;    // exécutions plus longues que le budget
+        uint32_t skipped = 0;     // périodes sautées après un retard
+        uint32_t histogram[HISTOGRAM_BINS] = {};
+
+        uint32_t avgUs() const { return runs > 0 ? totalUs / runs : 0; }
+        float avgLateMs() const { return runs > 0 ? (float)totalLateMs / runs : 0; }
+
+        static uint32_t binLimitUs(size_t bin)
+        {
+            static const uint32_t LIMITS[HISTOGRAM_BINS - 1] = {100, 500, 1000, 2000, 5000, 10000, 50000};
+            return bin < HISTOGRAM_BINS - 1 ? LIMITS[bin] : 0xFFFFFFFF;
+        }
+
+        void record(uint32_t durationUs, uint32_t lateMs)
+        {
+            if (runs == 0 || durationUs < minUs)
+                minUs = durationUs;
+            if (durationUs > maxUs)
+                maxUs = durationUs;
+            if (lateMs > maxLateMs)
+                maxLateMs = lateMs;
+            runs++;
+            totalUs += durationUs;
+            totalLateMs += lateMs;
+            size_t bin = 0;
+            while (durationUs > binLimitUs(bin))
+                bin++;
+            histogram[bin]++;
+        }
+    };
+
+    // Identifie une tâche ; devient invalide quand elle se termine ou est
+    // annulée, même si son emplacement est réutilisé.
+    struct Handle
+    {
+        uint16_t slot = 0xFFFF;
+        uint16_t generation = 0;
+
+        bool isValid() const { return slot != 0xFFFF; }
+    };
+
+private:
+    static const uint16_t NOT_IN_HEAP = 0xFFFF;
+
+    struct Task
+    {
+        Callback callback;
+        uint32_t due = 0;
+        uint32_t interval = 0; // 0 : une seule exécution (sauf addTask)
+        bool periodic = false;
+        bool used = false;
+        bool cancelled = false; // annulée pendant sa propre exécution
+        uint16_t generation = 0;
+        uint16_t heapPos = NOT_IN_HEAP;
+        uint32_t budgetUs = 0; // 0 : l'intervalle
+        char name[WIFIOTA_TASK_NAME_SIZE];
+        TaskProfile profile;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint16_t heap[MAX_TASKS]; // indices dans tasks, échéance la plus proche en tête
+    size_t heapSize = 0;
+    int running = -1;
+    OverrunCallback overrunCallback;
+
+    // a avant b, même après le débordement de millis() (49 jours)
+    static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+    bool earlier(size_t i, size_t j) const { return before(tasks[heap[i]].due, tasks[heap[j]].due); }
+
+    void place(size_t pos, uint16_t slot)
+    {
+        heap[pos] = slot;
+        tasks[slot].heapPos = pos;
+    }
+
+    void siftUp(size_t pos)
+    {
+        uint16_t slot = heap[pos];
+        while (pos > 0)
+        {
+            size_t parent = (pos - 1) / 2;
+            if (!before(tasks[slot].due, tasks[heap[parent]].due))
+                break;
+            place(pos, heap[parent]);
+            pos = parent;
+        }
+        place(pos, slot);
+    }
+
+    void siftDown(size_t pos)
+    {
+        uint16_t slot = heap[pos];
+        while (true)
+        {
+            size_t child = 2 * pos + 1;
+            if (child >= heapSize)
+                break;
+            if (child + 1 < heapSize && earlier(child + 1, child))
+                child++;
+            if (!before(tasks[heap[child]].due, tasks[slot].due))
+                break;
+            place(pos, heap[child]);
+            pos = child;
+        }
+        place(pos, slot);
+    }
+
+    void push(uint16_t slot)
+    {
+        place(heapSize++, slot);
+        siftUp(heapSize - 1);
+    }
+
+    void unlink(uint16_t slot)
+    {
+        size_t pos = tasks[slot].heapPos;
+        if (pos == NOT_IN_HEAP)
+            return;
+        tasks[slot].heapPos = NOT_IN_HEAP;
+        if (--heapSize == pos)
+            return;
+        // le dernier élément prend la place libérée puis descend ou remonte
+        uint16_t moved = heap[heapSize];
+        place(pos, moved);
+        siftDown(pos);
+        siftUp(tasks[moved].heapPos);
+    }
+
+    void release(uint16_t slot)
+    {
+        Task &t = tasks[slot];
+        t.callback = nullptr;
+        t.used = false;
+        t.cancelled = false;
+        t.generation++;
+    }
+
+    Task *resolve(const Handle &h)
+    {
+        if (h.slot >= MAX_TASKS)
+            return nullptr;
+        Task &t = tasks[h.slot];
+        return t.used && !t.cancelled && t.generation == h.generation ? &t : nullptr;
+    }
+
+    int find(const char *name) const
+    {
+        for (size_t i = 0; i < MAX_TASKS; i++)
+            if (tasks[i].used && !tasks[i].cancelled && strcmp(tasks[i].name, name) == 0)
+                return (int)i;
+        return -1;
+    }
+
+    Handle schedule(uint32_t delayMs, uint32_t intervalMs, bool periodic, Callback &&callback, const char *name)
+    {
+        Handle h;
+        if (!callback)
+            return h;
+        for (uint16_t i = 0; i < MAX_TASKS; i++)
+        {
+            Task &t = tasks[i];
+            if (t.used)
+                continue;
+            t.callback = std::move(callback);
+            t.due = millis() + delayMs;
+            t.interval = intervalMs;
+            t.periodic = periodic;
+            t.used = true;
+            t.budgetUs = 0;
+            t.profile = TaskProfile();
+            strncpy(t.name, name ? name : "", sizeof(t.name) - 1);
+            t.name[sizeof(t.name) - 1] = '\0';
+            push(i);
+            h.slot = i;
+            h.generation = t.generation;
+            return h;
+        }
+        return h;
+    }
+
+public:
+    TaskScheduler()
+    {
+        for (size_t i = 0; i < MAX_TASKS; i++)
+            tasks[i].name[0] = '\0';
+    }
+
+    /**
+     * Exécute callback toutes les intervalMs, la première fois dans
+     * intervalMs (ou firstDelayMs si précisé).
+     *
+     * @return Poignée invalide si les MAX_TASKS emplacements sont pris.
+     */
+    Handle every(uint32_t intervalMs, Callback callback, const char *name = nullptr,
+                 uint32_t firstDelayMs = NO_DEADLINE)
+    {
+        return schedule(firstDelayMs == NO_DEADLINE ? intervalMs : firstDelayMs, intervalMs, true,
+                        std::move(callback), name);
+    }
+
+    // Exécute callback une fois, dans delayMs
+    Handle after(uint32_t delayMs, Callback callback, const char *name = nullptr)
+    {
+        return schedule(delayMs, 0, false, std::move(callback), name);
+    }
+
+    /**
+     * Annule une tâche (aussi depuis sa propre fonction).
+     *
+     * @return false si elle était déjà terminée ou annulée.
+     */
+    bool cancel(Handle &handle)
+    {
+        Task *t = resolve(handle);
+        handle = Handle();
+        if (!t)
+            return false;
+        uint16_t slot = t - tasks;
+        unlink(slot);
+        if ((int)slot == running)
+            t->cancelled = true; // libérée au retour de la fonction
+        else
+            release(slot);
+        return true;
+    }
+
+    bool cancel(const String &name)
+    {
+        int slot = find(name.c_str());
+        if (slot < 0)
+            return false;
+        Handle h;
+        h.slot = slot;
+        h.generation = tasks[slot].generation;
+        return cancel(h);
+    }
+
+    bool isScheduled(const Handle &handle) const
+    {
+        return const_cast<TaskScheduler *>(this)->resolve(handle) != nullptr;
+    }
+
+    /**
+     * Change la période d'une tâche périodique ; la prochaine exécution a
+     * lieu intervalMs après la précédente.
+     */
+    bool setInterval(const Handle &handle, uint32_t intervalMs)
+    {
+        Task *t = resolve(handle);
+        if (!t || !t->periodic)
+            return false;
+        t->due = t->due - t->interval + intervalMs;
+        t->interval = intervalMs;
+        if (t->heapPos != NOT_IN_HEAP)
+        {
+            siftDown(t->heapPos);
+            siftUp(t->heapPos);
+        }
+        return true;
+    }
+
+    /**
+     * Exécute les tâches échues. Chaque tâche s'exécute au plus une fois par
+     * appel, même avec un intervalle nul.
+     */
+    void run()
+    {
+        size_t budget = heapSize;
+        while (heapSize > 0 && budget-- > 0)
+        {
+            // relu à chaque tâche : les précédentes ont pu prendre du temps
+            uint32_t now = millis();
+            uint16_t slot = heap[0];
+            Task &t = tasks[slot];
+            if (before(now, t.due))
+                break;
+
+            unlink(slot);
+            if (!t.periodic)
+            {
+                // emplacement libéré avant l'appel : la fonction peut replanifier
+                Callback callback = std::move(t.callback);
+                release(slot);
+                callback();
+                continue;
+            }
+
+            uint32_t lateMs = now - t.due;
+            t.due += t.interval;
+            if (!before(now, t.due))
+            {
+                // retard > 1 période : pas de rafale
+                if (t.interval > 0)
+                    t.profile.skipped += (now - t.due) / t.interval + 1;
+                t.due = now + t.interval;
+            }
+            push(slot);
+
+            running = slot;
+            uint32_t start = micros();
+            t.callback();
+            uint32_t durationUs = micros() - start;
+            running = -1;
+
+            t.profile.record(durationUs, lateMs);
+            uint32_t budgetUs = t.budgetUs > 0 ? t.budgetUs : t.interval * 1000;
+            if (budgetUs > 0 && durationUs > budgetUs)
+            {
+                t.profile.overruns++;
+                if (overrunCallback)
+                    overrunCallback(t.name, durationUs, budgetUs);
+            }
+            if (t.cancelled)
+                release(slot);
+        }
+    }
+
+    /**
+     * Délai avant la prochaine échéance, en ms : 0 si une tâche est due,
+     * NO_DEADLINE s'il n'y a aucune tâche.
+     *
+     *     delay(min(scheduler.timeUntilNext(), 100UL));
+     */
+    uint32_t timeUntilNext() const
+    {
+        if (heapSize == 0)
+            return NO_DEADLINE;
+        uint32_t now = millis();
+        uint32_t due = tasks[heap[0]].due;
+        return before(now, due) ? due - now : 0;
+    }
+
+    size_t size() const { return heapSize; }
+    static constexpr size_t capacity() { return MAX_TASKS; }
+
+    // ═══ Profilage ═══
+
+    /**
+     * Durée d'exécution maximale tolérée (µs) avant de compter un
+     * dépassement ; 0 pour revenir à l'intervalle.
+     */
+    bool setBudget(const Handle &handle, uint32_t budgetUs)
+    {
+        Task *t = resolve(handle);
+        if (!t)
+            return false;
+        t->budgetUs = budgetUs;
+        return true;
+    }
+
+    void onOverrun(OverrunCallback callback) { overrunCallback = std::move(callback); }
+
+    // Profil d'une tâche périodique, nullptr si elle n'existe plus
+    const TaskProfile *getProfile(const Handle &handle) const
+    {
+        const Task *t = const_cast<TaskScheduler *>(this)->resolve(handle);
+        return t ? &t->profile : nullptr;
+    }
+
+    const TaskProfile *getProfile(const String &name) const
+    {
+        int slot = find(name.c_str());
+        return slot >= 0 ? &tasks[slot].profile : nullptr;
+    }
+
+    void resetProfiles()
+    {
+        for (size_t i = 0; i < MAX_TASKS; i++)
+            tasks[i].profile = TaskProfile();
+    }
+
+    /**
+     * Profil des tâches périodiques, une entrée par tâche (nom, ou #<slot>) :
+     *     {"sensor":{"runs":120,"minUs":85,"avgUs":97,"maxUs":412,"lateAvgMs":0.3,
+     *      "lateMaxMs":4,"overruns":0,"skipped":0,"hist":[118,2,0,0,0,0,0,0]},...}
+     * Peut être appelé depuis une autre tâche (serveur web) : les compteurs
+     * sont lus sans verrou, une entrée peut être incohérente d'une unité.
+     */
+    String statsJSON() const
+    {
+        String json = "{";
+        bool first = true;
+        for (size_t i = 0; i < MAX_TASKS; i++)
+        {
+            const Task &t = tasks[i];
+            if (!t.used || !t.periodic)
+                continue;
+            const TaskProfile &p = t.profile;
+            if (!first)
+                json += ",";
+            first = false;
+            json += "\"" + (t.name[0] ? String(t.name) : "#" + String(i)) + "\":{\"runs\":" + String(p.runs) +
+                    ",\"minUs\":" + String(p.minUs) + ",\"avgUs\":" + String(p.avgUs()) +
+                    ",\"maxUs\":" + String(p.maxUs) + ",\"lateAvgMs\":" + String(p.avgLateMs(), 1) +
+                    ",\"lateMaxMs\":" + String(p.maxLateMs) + ",\"overruns\":" + String(p.overruns) +
+                    ",\"skipped\":" + String(p.skipped) + ",\"hist\":[";
+            for (size_t b = 0; b < HISTOGRAM_BINS; b++)
+                json += (b > 0 ? "," : "") + String(p.histogram[b]);
+            json += "]}";
+        }
+        json += "}";
+        return json;
+    }
+
+    // ═══ Interface historique ═══
+
+    bool addTask(const String &name, unsigned long intervalMs, void (*callback)())
+    {
+        if (!every(intervalMs, callback, name.c_str()).isValid())
+        {
+            Serial.println("Trop de tâches");
+            return false;
+        }
+        Serial.println("Tâche ajoutée: " + name + " (" + String(intervalMs) + "ms)");
+        return true;
+    }
+
+    void setInterval(const String &name, unsigned long newInterval)
+    {
+        int slot = find(name.c_str());
+        if (slot < 0)
+            return;
+        Handle h;
+        h.slot = slot;
+        h.generation = tasks[slot].generation;
+        if (setInterval(h, newInterval))
+            Serial.println("Intervalle modifié: " + name + " -> " + String(newInterval) + "ms");
+    }
+};
+
+#endif
@@ -0,0 +1,659 @@
+// ============================================
+// TimeSeriesStore.h - Historique de mesures sur LittleFS
+// ============================================
+#ifndef TIME_SERIES_STORE_H
+#define TIME_SERIES_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <memory>
+#include <new>
+#include <time.h>
+#include "utilities.h"
+
+// Chaque métrique est conservée à trois résolutions :
+//   niveau 0  valeurs brutes           1 heure
+//   niveau 1  agrégats d'une minute    2 jours
+//   niveau 2  agrégats de 15 minutes   5 semaines
+// Les agrégats (min, max, moyenne, nombre de valeurs) sont calculés au fil
+// de l'eau avec Statistics à partir des valeurs brutes.
+//
+// Un niveau est une suite de segments en ajout seul :
+// <base>/<métrique>/<niveau>/<horodatage du 1er enregistrement en hex>.
+// Quand le segment courant est plein, un nouveau est ouvert et le plus
+// ancien au-delà de la rétention est supprimé : la place occupée est
+// bornée (environ 170 Ko par métrique à 1 Hz).
+//
+// Les valeurs brutes sont gardées en RAM et écrites une fois par minute :
+// une coupure perd au plus la dernière minute de valeurs brutes et
+// l'agrégat de 15 minutes en cours.
+//
+// Les horodatages sont en secondes Unix : sans heure valide (NTP),
+// record() refuse les valeurs.
+//
+// Une Query lit les segments depuis la tâche du serveur web pendant que
+// record() écrit depuis loop(). Tant qu'une Query existe, les segments ne
+// sont pas supprimés : la rétention est appliquée au record() suivant la
+// fin de la lecture.
+
+class TimeSeriesStore
+{
+public:
+    static const uint8_t MAX_METRICS = 4;
+    static const uint8_t NAME_SIZE = 16;
+    static const uint8_t TIERS = 3;
+    static const uint8_t RAW_BUFFER = 60;
+    static const uint8_t MAX_SEGMENTS = 8;
+
+    struct Tier
+    {
+        uint16_t resolution;        // secondes
+        uint16_t recordsPerSegment; // enregistrements par fichier
+        uint8_t segments;           // segments pleins conservés
+    };
+
+    struct __attribute__((packed)) RawRecord
+    {
+        uint32_t t;
+        float value;
+    };
+
+    struct __attribute__((packed)) AggregateRecord
+    {
+        uint32_t t; // début de l'intervalle
+        float min;
+        float max;
+        float avg;
+        uint16_t count;
+    };
+
+    static const Tier &tier(uint8_t level)
+    {
+        static const Tier tiers[TIERS] = {
+            {1, 600, 6},   // 10 min par segment
+            {60, 480, 6},  // 8 h par segment
+            {900, 672, 5}, // 1 semaine par segment
+        };
+        return tiers[level];
+    }
+
+    static size_t recordSize(uint8_t level) { return level == 0 ? sizeof(RawRecord) : sizeof(AggregateRecord); }
+
+    // Heure Unix, 0 tant qu'elle n'est pas synchronisée
+    static uint32_t now()
+    {
+        time_t t = time(nullptr);
+        return t > 1600000000 ? (uint32_t)t : 0;
+    }
+
+private:
+    struct Metric
+    {
+        char name[NAME_SIZE];
+        uint32_t last = 0;
+        RawRecord pending[RAW_BUFFER];
+        uint8_t pendingCount = 0;
+        Statistics bucket[TIERS - 1];
+        uint32_t bucketStart[TIERS - 1] = {0};
+        uint32_t segmentStart[TIERS] = {0};
+        uint16_t segmentCount[TIERS] = {0};
+        uint8_t prunePending = 0; // niveaux dont la suppression attend la fin des lectures
+    };
+
+    fs::FS *fs = nullptr;
+    String base;
+    Metric *metrics[MAX_METRICS] = {nullptr};
+    uint8_t metricCount = 0;
+
+    // Lectures (Query) en cours et suppression en cours, sous readersLock
+    mutable portMUX_TYPE readersLock = portMUX_INITIALIZER_UNLOCKED;
+    mutable uint8_t readers = 0;
+    bool removing = false;
+
+    // false si une Query est ouverte : ne rien supprimer
+    bool beginRemoval()
+    {
+        portENTER_CRITICAL(&readersLock);
+        bool idle = readers == 0;
+        if (idle)
+            removing = true;
+        portEXIT_CRITICAL(&readersLock);
+        return idle;
+    }
+
+    void endRemoval()
+    {
+        portENTER_CRITICAL(&readersLock);
+        removing = false;
+        portEXIT_CRITICAL(&readersLock);
+    }
+
+    // Attend la fin d'une suppression en cours (quelques ms au plus)
+    void acquireReader() const
+    {
+        for (;;)
+        {
+            portENTER_CRITICAL(&readersLock);
+            bool idle = !removing;
+            if (idle)
+                readers++;
+            portEXIT_CRITICAL(&readersLock);
+            if (idle)
+                return;
+            vTaskDelay(1);
+        }
+    }
+
+    void releaseReader() const
+    {
+        portENTER_CRITICAL(&readersLock);
+        readers--;
+        portEXIT_CRITICAL(&readersLock);
+    }
+
+    String dirPath(const char *metric, uint8_t level) const { return base + "/" + metric + "/" + String(level); }
+
+    String segmentPath(const char *metric, uint8_t level, uint32_t start) const
+    {
+        char name[10];
+        snprintf(name, sizeof(name), "/%08lx", (unsigned long)start);
+        return dirPath(metric, level) + name;
+    }
+
+    static bool validName(const char *name)
+    {
+        size_t len = strlen(name);
+        if (len == 0 || len >= NAME_SIZE)
+            return false;
+        for (size_t i = 0; i < len; i++)
+            if (!isalnum((unsigned char)name[i]) && name[i] != '_' && name[i] != '-')
+                return false;
+        return true;
+    }
+
+    Metric *find(const char *name) const
+    {
+        for (uint8_t i = 0; i < metricCount; i++)
+            if (strcmp(metrics[i]->name, name) == 0)
+                return metrics[i];
+        return nullptr;
+    }
+
+    // Ajoute des enregistrements, en ouvrant un nouveau segment si besoin
+    void append(Metric &m, uint8_t level, const uint8_t *data, size_t count)
+    {
+        size_t size = recordSize(level);
+        const Tier &t = tier(level);
+        while (count > 0)
+        {
+            if (m.segmentCount[level] == 0 || m.segmentCount[level] >= t.recordsPerSegment)
+            {
+                memcpy(&m.segmentStart[level], data, sizeof(uint32_t)); // t du 1er enregistrement
+                m.segmentCount[level] = 0;
+                prune(m, level);
+            }
+            size_t n = min(count, (size_t)(t.recordsPerSegment - m.segmentCount[level]));
+            File f = fs->open(segmentPath(m.name, level, m.segmentStart[level]), FILE_APPEND);
+            if (!f)
+                return;
+            f.write(data, n * size);
+            f.close();
+            m.segmentCount[level] += n;
+            data += n * size;
+            count -= n;
+        }
+    }
+
+    // Supprime les segments au-delà de la rétention (segment courant exclu),
+    // ou le note pour plus tard si une Query est ouverte
+    void prune(Metric &m, uint8_t level)
+    {
+        if (!beginRemoval())
+        {
+            m.prunePending |= 1 << level;
+            return;
+        }
+        m.prunePending &= ~(1 << level);
+        uint32_t starts[MAX_SEGMENTS];
+        size_t n = listSegments(m.name, level, starts, MAX_SEGMENTS);
+        uint8_t keep = tier(level).segments;
+        for (size_t i = 0; i + keep < n; i++)
+            if (starts[i] != m.segmentStart[level])
+                fs->remove(segmentPath(m.name, level, starts[i]));
+        endRemoval();
+    }
+
+    void flushRaw(Metric &m)
+    {
+        if (m.pendingCount == 0)
+            return;
+        append(m, 0, (const uint8_t *)m.pending, m.pendingCount);
+        m.pendingCount = 0;
+    }
+
+    void closeBucket(Metric &m, uint8_t level)
+    {
+        Statistics &s = m.bucket[level - 1];
+        if (s.getCount() == 0)
+            return;
+        AggregateRecord r;
+        r.t = m.bucketStart[level - 1];
+        r.min = s.getMin();
+        r.max = s.getMax();
+        r.avg = s.getAverage();
+        r.count = (uint16_t)min(s.getCount(), (uint32_t)UINT16_MAX);
+        append(m, level, (const uint8_t *)&r, 1);
+        s.reset();
+    }
+
+public:
+    ~TimeSeriesStore()
+    {
+        for (uint8_t i = 0; i < metricCount; i++)
+            delete metrics[i];
+    }
+
+    /**
+     * Monte LittleFS (formaté s'il est invalide) et fixe le dossier racine.
+     */
+    bool begin(const char *basePath = "/ts", fs::FS &filesystem = LittleFS)
+    {
+        if (&filesystem == &LittleFS && !LittleFS.begin(true))
+            return false;
+        fs = &filesystem;
+        base = basePath;
+        fs->mkdir(base);
+        return true;
+    }
+
+    /**
+     * Déclare une métrique et reprend ses segments existants.
+     *
+     * @param name Nom court (lettres, chiffres, '_' ou '-', 15 caractères max).
+     */
+    bool addMetric(const char *name)
+    {
+        if (fs == nullptr || !validName(name))
+            return false;
+        if (find(name))
+            return true;
+        if (metricCount >= MAX_METRICS)
+            return false;
+        Metric *m = new (std::nothrow) Metric();
+        if (m == nullptr)
+            return false;
+        strncpy(m->name, name, NAME_SIZE);
+        fs->mkdir(base + "/" + name);
+        for (uint8_t level = 0; level < TIERS; level++)
+        {
+            fs->mkdir(dirPath(name, level));
+            uint32_t starts[MAX_SEGMENTS];
+            size_t n = listSegments(name, level, starts, MAX_SEGMENTS);
+            if (n == 0)
+                continue;
+            m->segmentStart[level] = starts[n - 1];
+            File f = fs->open(segmentPath(name, level, starts[n - 1]), FILE_READ);
+            m->segmentCount[level] = f ? f.size() / recordSize(level) : 0;
+        }
+        metrics[metricCount++] = m;
+        return true;
+    }
+
+    /**
+     * Enregistre une valeur.
+     *
+     * @param timestamp Secondes Unix, heure courante si 0.
+     * @return false si la métrique est inconnue, l'heure invalide ou antérieure à la précédente.
+     */
+    bool record(const char *name, float value, uint32_t timestamp = 0)
+    {
+        Metric *m = find(name);
+        uint32_t t = timestamp ? timestamp : now();
+        if (m == nullptr || t == 0 || t < m->last)
+            return false;
+        m->last = t;
+
+        for (uint8_t level = 0; m->prunePending && level < TIERS; level++)
+            if (m->prunePending & (1 << level))
+                prune(*m, level);
+
+        bool minuteClosed = false;
+        for (uint8_t level = 1; level < TIERS; level++)
+        {
+            uint32_t start = t - t % tier(level).resolution;
+            if (start != m->bucketStart[level - 1])
+            {
+                closeBucket(*m, level);
+                m->bucketStart[level - 1] = start;
+                minuteClosed |= level == 1;
+            }
+            m->bucket[level - 1].addValue(value);
+        }
+
+        m->pending[m->pendingCount++] = {t, value};
+        if (m->pendingCount >= RAW_BUFFER || minuteClosed)
+            flushRaw(*m);
+        return true;
+    }
+
+    // Écrit les valeurs brutes en attente (avant un redémarrage par exemple)
+    void flush()
+    {
+        for (uint8_t i = 0; i < metricCount; i++)
+            flushRaw(*metrics[i]);
+    }
+
+    /**
+     * Efface l'historique de toutes les métriques.
+     *
+     * @return false si une lecture /api/history est restée ouverte plus de timeoutMs.
+     */
+    bool clear(uint32_t timeoutMs = 1000)
+    {
+        unsigned long start = millis();
+        while (!beginRemoval())
+        {
+            if (millis() - start >= timeoutMs)
+                return false;
+            vTaskDelay(1);
+        }
+        for (uint8_t i = 0; i < metricCount; i++)
+        {
+            Metric &m = *metrics[i];
+            for (uint8_t level = 0; level < TIERS; level++)
+            {
+                uint32_t starts[MAX_SEGMENTS];
+                size_t n = listSegments(m.name, level, starts, MAX_SEGMENTS);
+                for (size_t j = 0; j < n; j++)
+                    fs->remove(segmentPath(m.name, level, starts[j]));
+                m.segmentCount[level] = 0;
+            }
+            for (uint8_t level = 1; level < TIERS; level++)
+            {
+                m.bucket[level - 1].reset();
+                m.bucketStart[level - 1] = 0;
+            }
+            m.pendingCount = 0;
+            m.last = 0;
+            m.prunePending = 0;
+        }
+        endRemoval();
+        return true;
+    }
+
+    /**
+     * Début des segments d'un niveau, du plus ancien au plus récent.
+     *
+     * @return Nombre de segments trouvés (au plus max).
+     */
+    size_t listSegments(const char *metric, uint8_t level, uint32_t *starts, size_t max) const
+    {
+        File dir = fs->open(dirPath(metric, level), FILE_READ);
+        if (!dir || !dir.isDirectory())
+            return 0;
+        size_t n = 0;
+        for (File f = dir.openNextFile(); f; f = dir.openNextFile())
+        {
+            const char *name = strrchr(f.name(), '/');
+            uint32_t start = strtoul(name ? name + 1 : f.name(), nullptr, 16);
+            // insertion triée ; au-delà de max, les plus récents sont gardés
+            size_t i;
+            if (n < max)
+                i = n++;
+            else if (start > starts[0])
+            {
+                memmove(starts, starts + 1, (max - 1) * sizeof(uint32_t));
+                i = max - 1;
+            }
+            else
+                continue;
+            while (i > 0 && starts[i - 1] > start)
+            {
+                starts[i] = starts[i - 1];
+                i--;
+            }
+            starts[i] = start;
+        }
+        return n;
+    }
+
+    String metricsJson() const
+    {
+        String json = "{\"metrics\":[";
+        for (uint8_t i = 0; i < metricCount; i++)
+        {
+            if (i > 0)
+                json += ",";
+            json += "\"" + String(metrics[i]->name) + "\"";
+        }
+        return json + "]}";
+    }
+
+    // ═══ Lecture en flux ═══
+
+    class Query
+    {
+    private:
+        const TimeSeriesStore &store;
+        char metric[NAME_SIZE];
+        uint8_t level;
+        uint32_t from, to, step;
+
+        uint32_t starts[MAX_SEGMENTS];
+        size_t segments = 0;
+        size_t segment = 0;
+        File file;
+        uint8_t records[16 * sizeof(AggregateRecord)];
+        size_t recordCount = 0, recordPos = 0;
+
+        // point de sortie en cours
+        uint32_t pointStart = 0;
+        float pointMin = 0, pointMax = 0;
+        double pointSum = 0;
+        uint32_t pointCount = 0;
+        uint32_t points = 0;
+
+        enum
+        {
+            HEADER,
+            POINTS,
+            FOOTER,
+            DONE
+        } state = HEADER;
+        char line[96];
+        size_t lineLen = 0, linePos = 0;
+
+        bool nextRecord(AggregateRecord &r)
+        {
+            while (recordPos >= recordCount)
+            {
+                if (!file)
+                {
+                    // saute les segments entièrement antérieurs à from
+                    while (segment + 1 < segments && starts[segment + 1] <= from)
+                        segment++;
+                    if (segment >= segments || starts[segment] > to)
+                        return false;
+                    file = store.fs->open(store.segmentPath(metric, level, starts[segment++]), FILE_READ);
+                    if (!file)
+                        continue;
+                }
+                size_t size = recordSize(level);
+                recordCount = file.read(records, sizeof(records) / size * size) / size;
+                recordPos = 0;
+                if (recordCount == 0)
+                    file.close();
+            }
+            const uint8_t *p = records + recordPos++ * recordSize(level);
+            if (level == 0)
+            {
+                RawRecord raw;
+                memcpy(&raw, p, sizeof(raw));
+                r = {raw.t, raw.value, raw.value, raw.value, 1};
+            }
+            else
+                memcpy(&r, p, sizeof(r));
+            return true;
+        }
+
+        // Prépare la ligne suivante, false quand il n'y en a plus
+        bool nextLine()
+        {
+            switch (state)
+            {
+            case HEADER:
+                lineLen = snprintf(line, sizeof(line),
+                                   "{\"metric\":\"%s\",\"resolution\":%u,\"step\":%lu,\"from\":%lu,\"to\":%lu,\"points\":[",
+                                   metric, tier(level).resolution, (unsigned long)step, (unsigned long)from,
+                                   (unsigned long)to);
+                state = POINTS;
+                return true;
+            case POINTS:
+            {
+                AggregateRecord r;
+                while (nextRecord(r))
+                {
+                    if (r.t < from)
+                        continue;
+                    if (r.t > to)
+                        break;
+                    uint32_t start = r.t - r.t % step;
+                    if (pointCount > 0 && start != pointStart)
+                    {
+                        formatPoint();
+                        addToPoint(start, r);
+                        return true;
+                    }
+                    addToPoint(start, r);
+                }
+                state = FOOTER;
+                if (pointCount > 0)
+                {
+                    formatPoint();
+                    return true;
+                }
+                return nextLine();
+            }
+            case FOOTER:
+                lineLen = snprintf(line, sizeof(line), "]}");
+                state = DONE;
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void addToPoint(uint32_t start, const AggregateRecord &r)
+        {
+            if (pointCount == 0)
+            {
+                pointStart = start;
+                pointMin = r.min;
+                pointMax = r.max;
+            }
+            pointMin = min(pointMin, r.min);
+            pointMax = max(pointMax, r.max);
+            pointSum += (double)r.avg * r.count;
+            pointCount += r.count;
+        }
+
+        void formatPoint()
+        {
+            lineLen = snprintf(line, sizeof(line), "%s[%lu,%.6g,%.6g,%.6g,%lu]", points ? "," : "",
+                               (unsigned long)pointStart, pointMin, pointMax, pointSum / pointCount,
+                               (unsigned long)pointCount);
+            points++;
+            pointSum = 0;
+            pointCount = 0;
+        }
+
+    public:
+        Query(const TimeSeriesStore &owner, const char *name, uint8_t tierLevel, uint32_t fromTs, uint32_t toTs,
+              uint32_t stepSec)
+            : store(owner), level(tierLevel), from(fromTs), to(toTs), step(stepSec)
+        {
+            strncpy(metric, name, NAME_SIZE);
+            store.acquireReader();
+            segments = store.listSegments(metric, level, starts, MAX_SEGMENTS);
+        }
+
+        ~Query()
+        {
+            if (file)
+                file.close();
+            store.releaseReader();
+        }
+
+        Query(const Query &) = delete;
+        Query &operator=(const Query &) = delete;
+
+        /**
+         * Remplit buffer avec la suite de la réponse JSON.
+         *
+         * @return Octets écrits, 0 à la fin.
+         */
+        size_t read(uint8_t *buffer, size_t maxLen)
+        {
+            size_t written = 0;
+            while (written < maxLen)
+            {
+                if (linePos == lineLen)
+                {
+                    if (!nextLine())
+                        break;
+                    lineLen = min(lineLen, sizeof(line) - 1);
+                    linePos = 0;
+                }
+                size_t n = min(maxLen - written, lineLen - linePos);
+                memcpy(buffer + written, line + linePos, n);
+                linePos += n;
+                written += n;
+            }
+            return written;
+        }
+
+        uint8_t getLevel() const { return level; }
+        uint32_t getStep() const { return step; }
+    };
+
+    /**
+     * Prépare une lecture. Le niveau le plus grossier dont la résolution ne
+     * dépasse pas step et qui remonte jusqu'à from est choisi ; step est
+     * arrondi à un multiple de sa résolution.
+     *
+     * @param from Début en secondes Unix (to - 1 h si 0).
+     * @param to Fin en secondes Unix (maintenant si 0).
+     * @param step Intervalle des points en secondes (résolution du niveau si 0).
+     * @return nullptr si la métrique est inconnue.
+     */
+    std::shared_ptr<Query> query(const char *name, uint32_t from = 0, uint32_t to = 0, uint32_t step = 0) const
+    {
+        Metric *m = find(name);
+        if (m == nullptr)
+            return nullptr;
+        if (to == 0)
+            to = m->last ? m->last : now();
+        if (from == 0 || from > to)
+            from = to > 3600 ? to - 3600 : 0;
+
+        int8_t chosen = -1;
+        for (uint8_t level = 0; level < TIERS; level++)
+        {
+            // un niveau qui n'a encore rien supprimé contient tout l'historique
+            uint32_t starts[MAX_SEGMENTS];
+            size_t n = listSegments(name, level, starts, MAX_SEGMENTS);
+            bool covers = n > 0 && (starts[0] <= from || n <= tier(level).segments);
+            if (covers && (chosen < 0 || tier(level).resolution <= step))
+                chosen = level;
+        }
+        if (chosen < 0)
+            chosen = TIERS - 1;
+
+        uint32_t resolution = tier(chosen).resolution;
+        step = step < resolution ? resolution : step - step % resolution;
+        return std::make_shared<Query>(*this, m->name, chosen, from, to, step);
+    }
+};
+
+#endif
@@ -0,0 +1,9 @@
+// ============================================
+// TimeSync.cpp - Heure conservée en mémoire RTC
+// ============================================
+#include <esp_attr.h>
+#include "TimeSync.h"
+
+// Non initialisé au démarrage : survit au deep sleep et à ESP.restart(),
+// pas à une coupure d'alimentation (le checksum l'écarte alors).
+RTC_NOINIT_ATTR TimeSync::PersistedTime TimeSync::rtcTime;
@@ -1,44 +1,690 @@
 #pragma once
 #include <Arduino.h>
+#include <atomic>
 #include <time.h>
+#include <sys/time.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <esp_private/esp_clk.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "Hash.h"
+#include "InplaceFunction.h"
+
+// L'heure est synchronisée en arrière-plan par le client SNTP de lwIP :
+// begin() rend la main tout de suite et onSync() prévient quand l'heure est
+// réglée. Le démarrage n'attend plus le réseau ; waitForSync() reste
+// disponible pour un sketch qui préfère bloquer.
+//
+// Les horodatages (télémétrie, logs) passent par un cache : la date
+// décomposée est calculée une fois par seconde (une fois par minute pour
+// localtime_r(), les secondes sont mises à jour en place), puis chaque appel
+// ne fait que copier ce texte et ajouter les millisecondes dans le tampon de
+// l'appelant. Aucune allocation, utilisable depuis n'importe quelle tâche.
+//
+//     char ts[TimeSync::ISO8601_SIZE];
+//     TimeSync::formatIso8601(ts, sizeof(ts));        // 2024-05-01T14:34:56.789+02:00
+//     TimeSync::formatIso8601(ts, sizeof(ts), true);  // 2024-05-01T12:34:56.789Z
+//     int64_t ms = TimeSync::epochMs();                // 1714566896789
+//
+// Avec plusieurs serveurs, une tâche brève les interroge une fois le Wi-Fi
+// connecté et place le plus rapide en tête de SNTP. À chaque
+// synchronisation, l'écart entre l'heure reçue et l'heure prévue par
+// l'horloge locale donne l'offset, et l'offset rapporté au temps écoulé la
+// dérive (ppm) ; l'intervalle de resynchronisation est choisi pour que
+// l'erreur reste sous WIFIOTA_TIME_MAX_ERROR_MS.
+//
+// L'heure de la dernière synchronisation est gardée en mémoire RTC avec le
+// compteur RTC, qui continue pendant le deep sleep et les redémarrages
+// logiciels : restore(), appelé par begin() ou plus tôt dans setup(), remet
+// l'horloge à l'heure sans réseau, pour horodater les mesures prises avant
+// la connexion.
+
+#ifndef WIFIOTA_TIME_MAX_ERROR_MS
+#define WIFIOTA_TIME_MAX_ERROR_MS 250 // erreur visée entre deux synchronisations
+#endif
+
+#ifndef WIFIOTA_TIME_MIN_SYNC_S
+#define WIFIOTA_TIME_MIN_SYNC_S 900
+#endif
+
+#ifndef WIFIOTA_TIME_MAX_SYNC_S
+#define WIFIOTA_TIME_MAX_SYNC_S 86400
+#endif
+
+#ifndef WIFIOTA_TIME_PROBE_TIMEOUT_MS
+#define WIFIOTA_TIME_PROBE_TIMEOUT_MS 1000
+#endif
 
 namespace TimeSync
 {
     // ===============================
-    //  Paramètres NTP et Fuseau horaire
+    //  Paramètres NTP
     // ===============================
     static const char *NTP_SERVER = "time.google.com";
-    static const unsigned long TIMEOUT_MS = 20000; // 20 sec
-    static long gmtOffset_sec = 0;                 // Décalage GMT (en secondes)
-    static int daylightOffset_sec = 0;             // Offset heure d’été (en secondes)
+    static const unsigned long TIMEOUT_MS = 20000;  // waitForSync() par défaut
+    static const time_t VALID_AFTER = 1600000000;   // heure plausible (septembre 2020)
+    static const size_t ISO8601_SIZE = 30;          // "YYYY-MM-DDTHH:MM:SS.mmm+hh:mm" + '\0'
+    static const size_t EPOCH_MS_SIZE = 21;         // int64 en décimal + '\0'
+    static const size_t MAX_SERVERS = 3;            // serveurs acceptés par configTime()
+    static const uint32_t DEFAULT_SYNC_S = 3600;    // intervalle SNTP par défaut d'ESP-IDF
+    static const int64_t DRIFT_MIN_WINDOW_US = 600000000LL; // 10 min entre deux mesures de dérive
+    static const int64_t MAX_SLEW_US = 1000000;     // au-delà : saut d'heure, pas une dérive
+
+    // Appelé dans la tâche lwIP (tcpip) : rester bref
+    typedef InplaceFunction<void(const struct timeval &)> SyncCallback;
 
     // ===============================
-    //  Initialisation de l'heure
+    //  État partagé (une seule instance pour tout le programme)
     // ===============================
-    inline void begin(long gmtOffset = 0, int daylightOffset = 0)
+    struct ServerInfo
     {
-        gmtOffset_sec = gmtOffset;
-        daylightOffset_sec = daylightOffset;
+        const char *name;
+        int32_t delayMs;  // aller-retour mesuré, -1 : pas de réponse
+        int32_t offsetMs; // heure du serveur - heure locale
+    };
 
-        configTime(gmtOffset_sec, daylightOffset_sec, NTP_SERVER);
-        Serial.print("[TimeSync] Waiting for time sync");
+    struct State
+    {
+        long gmtOffset = 0;     // décalage GMT (en secondes)
+        int daylightOffset = 0; // offset heure d'été (en secondes)
+        SyncCallback onSync;
+        std::atomic<uint32_t> syncCount{0};
+        std::atomic<uint32_t> lastSyncMs{0};
 
-        unsigned long start = millis();
-        time_t now = 0;
+        // sous lock : serveurs (le plus rapide en tête après la sonde) et mesures
+        portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+        ServerInfo servers[MAX_SERVERS];
+        size_t serverCount = 0;
+        bool probed = false;
+        bool hasReference = false;
+        int64_t refEpochUs = 0; // heure reçue à la dernière synchronisation
+        int64_t refMonoUs = 0;  // esp_timer au même instant
+        int64_t offsetUs = 0;   // correction appliquée par la dernière synchronisation
+        float driftPpm = 0;     // > 0 : l'horloge locale retarde
+        uint32_t driftSamples = 0;
+        uint32_t intervalS = DEFAULT_SYNC_S;
+        bool restored = false;
+    };
+
+    // Dernière heure connue, en mémoire RTC (TimeSync.cpp)
+    struct PersistedTime
+    {
+        uint32_t magic;
+        uint32_t checksum; // FNV-1a de la suite
+        int64_t epochUs;
+        uint64_t rtcUs; // compteur RTC au même instant
+        float driftPpm;
+    };
+
+    static const uint32_t PERSIST_MAGIC = 0x54494D45; // "TIME"
+    extern PersistedTime rtcTime;
+
+    inline State &state()
+    {
+        static State s;
+        return s;
+    }
+
+    // Seconde déjà formatée
+    struct CacheEntry
+    {
+        time_t second = -1;
+        uint8_t tmSec = 0;
+        char text[20];  // "YYYY-MM-DDTHH:MM:SS"
+        char zone[7];   // "Z" ou "+hh:mm"
+    };
+
+    struct Cache
+    {
+        portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+        CacheEntry entry;
+    };
+
+    inline Cache &cache(bool utc)
+    {
+        static Cache utcCache;
+        static Cache localCache;
+        return utc ? utcCache : localCache;
+    }
+
+    // ===============================
+    //  Formatage
+    // ===============================
+    inline char *put2(char *p, unsigned v)
+    {
+        p[0] = '0' + v / 10 % 10;
+        p[1] = '0' + v % 10;
+        return p + 2;
+    }
+
+    // Jours depuis le 1970-01-01 d'une date civile (Hinnant)
+    inline int32_t daysFromCivil(int32_t y, unsigned m, unsigned d)
+    {
+        y -= m <= 2;
+        int32_t era = (y >= 0 ? y : y - 399) / 400;
+        unsigned yoe = (unsigned)(y - era * 400);
+        unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + (int32_t)doe - 719468;
+    }
+
+    inline void fillEntry(CacheEntry &e, time_t t, bool utc)
+    {
+        struct tm tm;
+        if (utc)
+            gmtime_r(&t, &tm);
+        else
+            localtime_r(&t, &tm);
+
+        char *p = e.text;
+        unsigned year = (unsigned)(tm.tm_year + 1900);
+        p = put2(p, year / 100);
+        p = put2(p, year % 100);
+        *p++ = '-';
+        p = put2(p, tm.tm_mon + 1);
+        *p++ = '-';
+        p = put2(p, tm.tm_mday);
+        *p++ = 'T';
+        p = put2(p, tm.tm_hour);
+        *p++ = ':';
+        p = put2(p, tm.tm_min);
+        *p++ = ':';
+        p = put2(p, tm.tm_sec);
+        *p = '\0';
+
+        if (utc)
+        {
+            strcpy(e.zone, "Z");
+        }
+        else
+        {
+            // décalage réel, quel que soit le réglage de TZ
+            int64_t local = (int64_t)daysFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) * 86400 +
+                            tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+            long offset = (long)(local - (int64_t)t) / 60;
+            char *z = e.zone;
+            *z++ = offset < 0 ? '-' : '+';
+            if (offset < 0)
+                offset = -offset;
+            z = put2(z, offset / 60);
+            *z++ = ':';
+            z = put2(z, offset % 60);
+            *z = '\0';
+        }
+        e.second = t;
+        e.tmSec = tm.tm_sec;
+    }
+
+    // Entrée de la seconde t, recalculée au besoin
+    inline void lookup(time_t t, bool utc, CacheEntry &out)
+    {
+        Cache &c = cache(utc);
+        portENTER_CRITICAL(&c.lock);
+        out = c.entry;
+        portEXIT_CRITICAL(&c.lock);
+        if (out.second == t)
+            return;
+
+        // même minute : seules les secondes changent
+        if (out.second >= 0 && t > out.second && t - out.second < 60 - out.tmSec)
+        {
+            out.tmSec += (uint8_t)(t - out.second);
+            put2(out.text + 17, out.tmSec);
+            out.second = t;
+        }
+        else
+        {
+            fillEntry(out, t, utc);
+        }
+        portENTER_CRITICAL(&c.lock);
+        c.entry = out;
+        portEXIT_CRITICAL(&c.lock);
+    }
+
+    /**
+     * Écrit tv en ISO-8601 avec millisecondes dans out.
+     *
+     * @param utc true : "...Z", false : heure locale avec son décalage.
+     * @return Longueur écrite, 0 si out est trop petit.
+     */
+    inline size_t formatIso8601(const struct timeval &tv, char *out, size_t size, bool utc = false)
+    {
+        CacheEntry e;
+        lookup(tv.tv_sec, utc, e);
+        size_t zoneLength = strlen(e.zone);
+        size_t length = 19 + 4 + zoneLength;
+        if (size <= length)
+            return 0;
+        memcpy(out, e.text, 19);
+        unsigned ms = (unsigned)(tv.tv_usec / 1000);
+        out[19] = '.';
+        out[20] = '0' + ms / 100;
+        put2(out + 21, ms % 100);
+        memcpy(out + 23, e.zone, zoneLength + 1);
+        return length;
+    }
+
+    inline size_t formatIso8601(char *out, size_t size, bool utc = false)
+    {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        return formatIso8601(tv, out, size, utc);
+    }
 
-        while (millis() - start < TIMEOUT_MS)
+    inline int64_t epochMs()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    }
+
+    // Millisecondes Unix en décimal ; longueur écrite, 0 si out est trop petit
+    inline size_t formatEpochMs(int64_t ms, char *out, size_t size)
+    {
+        char digits[EPOCH_MS_SIZE];
+        size_t n = 0;
+        bool negative = ms < 0;
+        uint64_t v = negative ? (uint64_t)(-ms) : (uint64_t)ms;
+        do
         {
-            time(&now);
-            if (now > 100000)
+            digits[n++] = '0' + v % 10;
+            v /= 10;
+        } while (v > 0);
+        size_t length = n + (negative ? 1 : 0);
+        if (size <= length)
+            return 0;
+        char *p = out;
+        if (negative)
+            *p++ = '-';
+        while (n > 0)
+            *p++ = digits[--n];
+        *p = '\0';
+        return length;
+    }
+
+    inline size_t formatEpochMs(char *out, size_t size) { return formatEpochMs(epochMs(), out, size); }
+
+    // ===============================
+    //  Offset, dérive et intervalle
+    // ===============================
+
+    /**
+     * Enregistre une synchronisation : heure reçue (epochUs) et esp_timer au
+     * même instant. Met à jour offset, dérive et intervalle conseillé.
+     *
+     * @return Intervalle de resynchronisation en secondes.
+     */
+    inline uint32_t recordSync(int64_t epochUs, int64_t monoUs)
+    {
+        State &s = state();
+        portENTER_CRITICAL(&s.lock);
+        if (s.hasReference)
+        {
+            int64_t elapsed = monoUs - s.refMonoUs;
+            s.offsetUs = epochUs - (s.refEpochUs + elapsed);
+            int64_t magnitude = s.offsetUs < 0 ? -s.offsetUs : s.offsetUs;
+            if (elapsed >= DRIFT_MIN_WINDOW_US && magnitude < MAX_SLEW_US)
             {
-                Serial.println("\n[TimeSync] Time synchronized.");
-                return;
+                float ppm = (float)s.offsetUs * 1e6f / (float)elapsed;
+                s.driftPpm = s.driftSamples == 0 ? ppm : s.driftPpm + (ppm - s.driftPpm) * 0.25f;
+                s.driftSamples++;
+
+                // intervalle au bout duquel la dérive atteint l'erreur visée
+                float drift = s.driftPpm < 0 ? -s.driftPpm : s.driftPpm;
+                float seconds = drift > 0.01f ? WIFIOTA_TIME_MAX_ERROR_MS * 1000.0f / drift : WIFIOTA_TIME_MAX_SYNC_S;
+                if (seconds < WIFIOTA_TIME_MIN_SYNC_S)
+                    seconds = WIFIOTA_TIME_MIN_SYNC_S;
+                if (seconds > WIFIOTA_TIME_MAX_SYNC_S)
+                    seconds = WIFIOTA_TIME_MAX_SYNC_S;
+                s.intervalS = (uint32_t)seconds;
             }
-            Serial.print(".");
-            delay(500);
         }
+        s.hasReference = true;
+        s.refEpochUs = epochUs;
+        s.refMonoUs = monoUs;
+        uint32_t interval = s.intervalS;
+        portEXIT_CRITICAL(&s.lock);
+        return interval;
+    }
+
+    inline int64_t getOffsetUs()
+    {
+        State &s = state();
+        portENTER_CRITICAL(&s.lock);
+        int64_t v = s.offsetUs;
+        portEXIT_CRITICAL(&s.lock);
+        return v;
+    }
+
+    inline float getDriftPpm()
+    {
+        State &s = state();
+        portENTER_CRITICAL(&s.lock);
+        float v = s.driftPpm;
+        portEXIT_CRITICAL(&s.lock);
+        return v;
+    }
 
-        Serial.println("\n[TimeSync] Failed to sync time within timeout.");
+    inline uint32_t getSyncIntervalS()
+    {
+        State &s = state();
+        portENTER_CRITICAL(&s.lock);
+        uint32_t v = s.intervalS;
+        portEXIT_CRITICAL(&s.lock);
+        return v;
+    }
+
+    // ===============================
+    //  Persistance en mémoire RTC
+    // ===============================
+    inline uint32_t persistedChecksum(const PersistedTime &p)
+    {
+        const uint8_t *data = (const uint8_t *)&p + offsetof(PersistedTime, epochUs);
+        return Hash::fnv1a(data, sizeof(PersistedTime) - offsetof(PersistedTime, epochUs));
+    }
+
+    inline void save(int64_t epochUs, uint64_t rtcUs, float driftPpm)
+    {
+        rtcTime.epochUs = epochUs;
+        rtcTime.rtcUs = rtcUs;
+        rtcTime.driftPpm = driftPpm;
+        rtcTime.checksum = persistedChecksum(rtcTime);
+        rtcTime.magic = PERSIST_MAGIC;
+    }
+
+    /**
+     * Heure déduite de la mémoire RTC pour une valeur du compteur RTC.
+     *
+     * @return false si rien de valide n'a été gardé (coupure d'alimentation).
+     */
+    inline bool restoredTime(uint64_t rtcNowUs, struct timeval &out)
+    {
+        if (rtcTime.magic != PERSIST_MAGIC || rtcTime.checksum != persistedChecksum(rtcTime) ||
+            rtcNowUs < rtcTime.rtcUs)
+            return false;
+        int64_t epochUs = rtcTime.epochUs + (int64_t)(rtcNowUs - rtcTime.rtcUs);
+        out.tv_sec = (time_t)(epochUs / 1000000);
+        out.tv_usec = (suseconds_t)(epochUs % 1000000);
+        return true;
+    }
+
+    // Garde l'heure courante en mémoire RTC (fait à chaque synchronisation)
+    inline void persist()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        if (tv.tv_sec <= VALID_AFTER)
+            return;
+        save((int64_t)tv.tv_sec * 1000000 + tv.tv_usec, esp_clk_rtc_time(), getDriftPpm());
+    }
+
+    /**
+     * Remet l'horloge à l'heure depuis la mémoire RTC si elle n'est pas
+     * réglée (redémarrage logiciel, réveil). Sans réseau.
+     *
+     * @return true si l'heure a été restaurée.
+     */
+    inline bool restore()
+    {
+        State &s = state();
+        if (s.restored)
+            return true;
+        struct timeval tv;
+        if (time(nullptr) > VALID_AFTER || !restoredTime(esp_clk_rtc_time(), tv) || tv.tv_sec <= VALID_AFTER)
+            return false;
+        settimeofday(&tv, nullptr);
+        portENTER_CRITICAL(&s.lock);
+        s.restored = true;
+        s.driftPpm = rtcTime.driftPpm;
+        portEXIT_CRITICAL(&s.lock);
+        return true;
+    }
+
+    inline bool wasRestored() { return state().restored; }
+
+    // ===============================
+    //  Choix du serveur
+    // ===============================
+    inline int64_t ntpToEpochUs(const uint8_t *p)
+    {
+        uint32_t seconds = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+        uint32_t fraction = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
+        return ((int64_t)seconds - 2208988800LL) * 1000000 + (int64_t)(((uint64_t)fraction * 1000000) >> 32);
+    }
+
+    /**
+     * Décode une réponse NTP (48 octets) reçue pour une requête partie à
+     * t1Us et revenue à t4Us (heure locale).
+     *
+     * @return false si le paquet n'est pas une réponse serveur valide.
+     */
+    inline bool parseNtpReply(const uint8_t *packet, size_t length, int64_t t1Us, int64_t t4Us, int64_t &offsetUs,
+                              int64_t &delayUs)
+    {
+        if (length < 48 || (packet[0] & 0x07) != 4 || packet[1] == 0 || packet[1] > 15)
+            return false; // pas mode serveur, ou stratum invalide (0 = kiss-o'-death)
+        int64_t t2 = ntpToEpochUs(packet + 32); // réception serveur
+        int64_t t3 = ntpToEpochUs(packet + 40); // émission serveur
+        offsetUs = ((t2 - t1Us) + (t3 - t4Us)) / 2;
+        delayUs = (t4Us - t1Us) - (t3 - t2);
+        return true;
+    }
+
+    inline int64_t nowUs()
+    {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    }
+
+    // Interroge un serveur ; false sans réponse dans WIFIOTA_TIME_PROBE_TIMEOUT_MS
+    inline bool probeServer(WiFiUDP &udp, const char *name, ServerInfo &info)
+    {
+        info.delayMs = -1;
+        IPAddress ip;
+        if (!WiFi.hostByName(name, ip))
+            return false;
+        while (udp.parsePacket() > 0)
+            udp.flush(); // réponse en retard d'un autre serveur
+
+        uint8_t packet[48] = {0};
+        packet[0] = 0x23; // version 4, mode client
+        int64_t t1 = nowUs();
+        udp.beginPacket(ip, 123);
+        udp.write(packet, sizeof(packet));
+        udp.endPacket();
+
+        unsigned long start = millis();
+        while (millis() - start < WIFIOTA_TIME_PROBE_TIMEOUT_MS)
+        {
+            if (udp.parsePacket() >= (int)sizeof(packet))
+            {
+                int64_t t4 = nowUs();
+                udp.read(packet, sizeof(packet));
+                udp.flush();
+                int64_t offset, delayUs;
+                if (!parseNtpReply(packet, sizeof(packet), t1, t4, offset, delayUs))
+                    return false;
+                info.delayMs = (int32_t)(delayUs / 1000);
+                int64_t offsetMs = offset / 1000;
+                info.offsetMs = offsetMs > INT32_MAX ? INT32_MAX : offsetMs < INT32_MIN ? INT32_MIN : (int32_t)offsetMs;
+                return true;
+            }
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+        return false;
+    }
+
+    inline void startSntp()
+    {
+        State &s = state();
+        const char *names[MAX_SERVERS] = {nullptr, nullptr, nullptr};
+        portENTER_CRITICAL(&s.lock);
+        for (size_t i = 0; i < s.serverCount; i++)
+            names[i] = s.servers[i].name;
+        uint32_t interval = s.intervalS;
+        portEXIT_CRITICAL(&s.lock);
+        sntp_set_sync_interval(interval * 1000);
+        configTime(s.gmtOffset, s.daylightOffset, names[0], names[1], names[2]);
+    }
+
+    // Tâche lancée par begin() : attend le Wi-Fi, mesure chaque serveur, met le plus rapide en tête
+    inline void probeTask(void *)
+    {
+        State &s = state();
+        unsigned long start = millis();
+        while (WiFi.status() != WL_CONNECTED && millis() - start < 120000)
+            vTaskDelay(pdMS_TO_TICKS(500));
+
+        if (WiFi.status() == WL_CONNECTED)
+        {
+            WiFiUDP udp;
+            udp.begin(0);
+            ServerInfo results[MAX_SERVERS];
+            portENTER_CRITICAL(&s.lock);
+            size_t count = s.serverCount;
+            for (size_t i = 0; i < count; i++)
+                results[i] = s.servers[i];
+            portEXIT_CRITICAL(&s.lock);
+            for (size_t i = 0; i < count; i++)
+                probeServer(udp, results[i].name, results[i]);
+            udp.stop();
+
+            // tri par aller-retour, serveurs muets à la fin
+            for (size_t i = 1; i < count; i++)
+                for (size_t j = i; j > 0; j--)
+                {
+                    ServerInfo &a = results[j - 1];
+                    ServerInfo &b = results[j];
+                    bool swap = a.delayMs < 0 ? b.delayMs >= 0 : (b.delayMs >= 0 && b.delayMs < a.delayMs);
+                    if (!swap)
+                        break;
+                    ServerInfo tmp = a;
+                    a = b;
+                    b = tmp;
+                }
+
+            portENTER_CRITICAL(&s.lock);
+            bool reorder = strcmp(s.servers[0].name, results[0].name) != 0;
+            for (size_t i = 0; i < count; i++)
+                s.servers[i] = results[i];
+            s.probed = true;
+            portEXIT_CRITICAL(&s.lock);
+            if (reorder)
+                startSntp();
+            if (results[0].delayMs >= 0)
+                Serial.printf("[TimeSync] Fastest NTP server: %s (%d ms)\n", results[0].name, (int)results[0].delayMs);
+            else
+                Serial.println("[TimeSync] No NTP server answered the probe");
+        }
+        vTaskDelete(nullptr);
+    }
+
+    // ===============================
+    //  Synchronisation SNTP
+    // ===============================
+    inline void syncNotification(struct timeval *tv)
+    {
+        State &s = state();
+        uint32_t interval = recordSync((int64_t)tv->tv_sec * 1000000 + tv->tv_usec, esp_timer_get_time());
+        sntp_set_sync_interval(interval * 1000); // pris en compte à la prochaine attente
+        persist();
+        s.syncCount.fetch_add(1, std::memory_order_relaxed);
+        s.lastSyncMs.store(millis(), std::memory_order_relaxed);
+        if (s.onSync)
+            s.onSync(*tv);
+    }
+
+    /**
+     * Fonction appelée à chaque synchronisation réussie, à définir avant
+     * begin().
+     */
+    inline void onSync(SyncCallback callback) { state().onSync = std::move(callback); }
+
+    /**
+     * Restaure l'heure gardée en RTC, démarre SNTP en arrière-plan et rend
+     * la main immédiatement.
+     *
+     * @param servers Jusqu'à MAX_SERVERS noms (chaînes constantes) ; avec
+     *                plusieurs, le plus rapide est mis en tête une fois le
+     *                Wi-Fi connecté.
+     */
+    inline void begin(long gmtOffset, int daylightOffset, const char *const *servers, size_t count)
+    {
+        State &s = state();
+        s.gmtOffset = gmtOffset;
+        s.daylightOffset = daylightOffset;
+        if (count > MAX_SERVERS)
+            count = MAX_SERVERS;
+        if (count == 0)
+        {
+            servers = &NTP_SERVER;
+            count = 1;
+        }
+        portENTER_CRITICAL(&s.lock);
+        for (size_t i = 0; i < count; i++)
+            s.servers[i] = {servers[i], -1, 0};
+        s.serverCount = count;
+        s.probed = false;
+        portEXIT_CRITICAL(&s.lock);
+
+        if (restore())
+            Serial.println("[TimeSync] Time restored from RTC memory");
+
+        sntp_set_time_sync_notification_cb(syncNotification);
+        startSntp();
+
+        // le fuseau a pu changer : l'heure locale en cache n'est plus valable
+        Cache &local = cache(false);
+        portENTER_CRITICAL(&local.lock);
+        local.entry.second = -1;
+        portEXIT_CRITICAL(&local.lock);
+        Serial.printf("[TimeSync] SNTP started (%s)\n", servers[0]);
+
+        if (count > 1)
+            xTaskCreate(probeTask, "ntp_probe", 4096, nullptr, 1, nullptr);
+    }
+
+    inline void begin(long gmtOffset = 0, int daylightOffset = 0, const char *server = NTP_SERVER)
+    {
+        begin(gmtOffset, daylightOffset, &server, 1);
+    }
+
+    // Serveur en tête de SNTP (le plus rapide après la sonde)
+    inline const char *getServer()
+    {
+        State &s = state();
+        portENTER_CRITICAL(&s.lock);
+        const char *name = s.serverCount > 0 ? s.servers[0].name : NTP_SERVER;
+        portEXIT_CRITICAL(&s.lock);
+        return name;
+    }
+
+    // Au moins une synchronisation depuis le démarrage
+    inline bool isSynced() { return state().syncCount.load(std::memory_order_relaxed) > 0; }
+
+    // Horloge réglée (SNTP, RTC ou settimeofday())
+    inline bool isValid() { return time(nullptr) > VALID_AFTER; }
+
+    inline uint32_t getSyncCount() { return state().syncCount.load(std::memory_order_relaxed); }
+    inline unsigned long getLastSyncMillis() { return state().lastSyncMs.load(std::memory_order_relaxed); }
+
+    /**
+     * Attend la première synchronisation (bloquant, à éviter au démarrage).
+     *
+     * @return false si timeoutMs s'est écoulé avant.
+     */
+    inline bool waitForSync(unsigned long timeoutMs = TIMEOUT_MS)
+    {
+        unsigned long start = millis();
+        while (!isSynced())
+        {
+            if (millis() - start >= timeoutMs)
+                return false;
+            delay(100);
+        }
+        return true;
     }
 
     // ===============================
@@ -46,13 +692,10 @@ namespace TimeSync
     // ===============================
     inline String timestamp()
     {
-        time_t now;
-        struct tm timeinfo;
-        time(&now);
-        localtime_r(&now, &timeinfo);
-
-        char buffer[30];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        char buffer[ISO8601_SIZE];
+        formatIso8601(buffer, sizeof(buffer));
+        buffer[10] = ' ';
+        buffer[19] = '\0';
         return String(buffer);
     }
 
@@ -61,26 +704,63 @@ namespace TimeSync
     // ===============================
     inline String shortTime()
     {
-        time_t now;
-        struct tm timeinfo;
-        time(&now);
-        localtime_r(&now, &timeinfo);
-
-        char buffer[12];
-        strftime(buffer, sizeof(buffer), "%H:%M:%S", &timeinfo);
-        return String(buffer);
+        char buffer[ISO8601_SIZE];
+        formatIso8601(buffer, sizeof(buffer));
+        buffer[19] = '\0';
+        return String(buffer + 11);
     }
 
     // ===============================
     //  Infos de débogage
     // ===============================
+    // {"synced":true,"restored":false,"syncs":3,"server":"time.google.com","offsetUs":-1840,"driftPpm":4.2,
+    //  "intervalS":59523,"servers":[{"name":"time.google.com","delayMs":18,"offsetMs":-2},...]}
+    inline String statusJSON()
+    {
+        State &s = state();
+        ServerInfo servers[MAX_SERVERS];
+        portENTER_CRITICAL(&s.lock);
+        size_t count = s.serverCount;
+        for (size_t i = 0; i < count; i++)
+            servers[i] = s.servers[i];
+        bool probed = s.probed;
+        int64_t offset = s.offsetUs;
+        float drift = s.driftPpm;
+        uint32_t interval = s.intervalS;
+        portEXIT_CRITICAL(&s.lock);
+
+        String json = "{\"synced\":" + String(isSynced() ? "true" : "false") +
+                      ",\"restored\":" + String(wasRestored() ? "true" : "false") +
+                      ",\"syncs\":" + String(getSyncCount()) + ",\"server\":\"" + String(getServer()) +
+                      "\",\"offsetUs\":" + String((long)offset) + ",\"driftPpm\":" + String(drift, 2) +
+                      ",\"intervalS\":" + String(interval) + ",\"servers\":[";
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i > 0)
+                json += ",";
+            json += "{\"name\":\"" + String(servers[i].name) + "\"";
+            if (probed)
+                json += ",\"delayMs\":" + String(servers[i].delayMs) + ",\"offsetMs\":" + String(servers[i].offsetMs);
+            json += "}";
+        }
+        json += "]}";
+        return json;
+    }
+
     inline void info()
     {
+        State &s = state();
+        char now[ISO8601_SIZE];
+        formatIso8601(now, sizeof(now));
         Serial.println("===== TimeSync Info =====");
-        Serial.printf("NTP Server: %s\n", NTP_SERVER);
-        Serial.printf("GMT Offset: %ld sec (%.1f h)\n", gmtOffset_sec, gmtOffset_sec / 3600.0);
-        Serial.printf("DST Offset: %d sec (%.1f h)\n", daylightOffset_sec, daylightOffset_sec / 3600.0);
-        Serial.printf("Current Time: %s\n", timestamp().c_str());
+        Serial.printf("NTP Server: %s\n", getServer());
+        Serial.printf("GMT Offset: %ld sec (%.1f h)\n", s.gmtOffset, s.gmtOffset / 3600.0);
+        Serial.printf("DST Offset: %d sec (%.1f h)\n", s.daylightOffset, s.daylightOffset / 3600.0);
+        Serial.printf("Synced: %s (%u syncs, last at %lu ms)\n", isSynced() ? "yes" : "no",
+                      (unsigned)getSyncCount(), getLastSyncMillis());
+        Serial.printf("Offset: %ld us, drift: %.2f ppm, resync every %u s\n", (long)getOffsetUs(), getDriftPpm(),
+                      (unsigned)getSyncIntervalS());
+        Serial.printf("Current Time: %s\n", now);
         Serial.println("=========================");
     }
 }
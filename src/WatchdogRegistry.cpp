@@ -0,0 +1,9 @@
+// ============================================
+// WatchdogRegistry.cpp - Post-mortem en mémoire RTC
+// ============================================
+#include <esp_attr.h>
+#include "WatchdogRegistry.h"
+
+// Non initialisé au démarrage : survit à ESP.restart() et aux resets des
+// watchdogs, pas à une coupure d'alimentation (le checksum l'écarte alors).
+RTC_NOINIT_ATTR WatchdogRegistry::PostMortem WatchdogRegistry::rtcRecord;
@@ -0,0 +1,444 @@
+// ============================================
+// WatchdogRegistry.h - Surveillance groupée des watchdogs, blocages de loop() et post-mortem
+// ============================================
+#ifndef WATCHDOG_REGISTRY_H
+#define WATCHDOG_REGISTRY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <esp_task_wdt.h>
+#include <esp_system.h>
+#include "Hash.h"
+#include "InplaceFunction.h"
+#include "utilities.h"
+#include "mqtt.h"
+
+// Les SoftwareWatchdog enregistrés sont vérifiés ensemble par un timer
+// esp_timer (tâche esp_timer, priorité haute) : la vérification a lieu même
+// quand loop() est bloquée. loopTick(), appelé à chaque tour de loop(),
+// mesure la durée des itérations (moyenne, max, P50/P95/P99) et réarme le
+// watchdog de tâches de l'ESP (TWDT) auquel begin() abonne loop().
+//
+// Quand un watchdog expire ou que loop() ne tourne plus depuis
+// loopStallMs, un post-mortem est écrit en mémoire RTC (conservée lors d'un
+// redémarrage logiciel) : cause, watchdogs et temps depuis leur dernier
+// feed(), statistiques de loop(), état des tâches surveillées. Puis l'ESP
+// redémarre, sans attente. Au démarrage suivant, begin() récupère ce
+// post-mortem ; publishPostMortem() l'envoie dès que MQTT est connecté,
+// avec la cause matérielle du redémarrage (TWDT, panic, brownout...).
+//
+// Choisir loopStallMs inférieur au délai du TWDT (5 s par défaut) : le
+// TWDT ne laisse pas de post-mortem, il reste le filet de sécurité.
+
+#ifndef WIFIOTA_WATCHDOG_MAX
+#define WIFIOTA_WATCHDOG_MAX 8
+#endif
+
+#ifndef WIFIOTA_WATCHDOG_MAX_TASKS
+#define WIFIOTA_WATCHDOG_MAX_TASKS 8
+#endif
+
+class WatchdogRegistry
+{
+public:
+    static const size_t MAX_WATCHDOGS = WIFIOTA_WATCHDOG_MAX;
+    static const size_t MAX_TASKS = WIFIOTA_WATCHDOG_MAX_TASKS;
+    static const size_t NAME_SIZE = 16;
+
+    enum Cause : uint8_t
+    {
+        WATCHDOG,
+        LOOP_STALL
+    };
+
+    // Enregistrement conservé en mémoire RTC : types simples uniquement
+    struct PostMortem
+    {
+        uint32_t magic;
+        uint32_t checksum; // FNV-1a de la suite
+        uint32_t uptimeMs;
+        uint8_t cause;
+        char culprit[NAME_SIZE];
+
+        uint8_t watchdogCount;
+        struct
+        {
+            char name[NAME_SIZE];
+            uint32_t timeoutMs;
+            uint32_t sinceFeedMs;
+            uint8_t enabled;
+        } watchdogs[MAX_WATCHDOGS];
+
+        struct
+        {
+            uint32_t iterations;
+            uint32_t sinceLastMs; // depuis le dernier loopTick()
+            uint32_t avgUs;
+            uint32_t maxUs;
+            uint32_t p50Us;
+            uint32_t p95Us;
+            uint32_t p99Us;
+        } loop;
+
+        uint8_t taskCount;
+        struct
+        {
+            char name[NAME_SIZE];
+            uint8_t state; // eTaskState
+            uint8_t priority;
+            uint32_t stackFree; // octets
+        } tasks[MAX_TASKS];
+    };
+
+    // Appelée après l'écriture du post-mortem, juste avant le redémarrage
+    // (depuis la tâche esp_timer : rester bref, ne rien attendre de loop())
+    typedef InplaceFunction<void(const PostMortem &)> StallCallback;
+
+private:
+    static const uint32_t MAGIC = 0x57444F47; // "WDOG"
+
+    // Défini dans WatchdogRegistry.cpp (RTC_NOINIT_ATTR)
+    static PostMortem rtcRecord;
+
+    SoftwareWatchdog *watchdogs[MAX_WATCHDOGS];
+    size_t watchdogCount = 0;
+    TaskHandle_t tasks[MAX_TASKS];
+    size_t taskCount = 0;
+
+    esp_timer_handle_t timer = nullptr;
+    uint32_t loopStallMs = 0;
+    bool taskWdt = false;
+    bool restart = true;
+    bool stalled = false; // déjà signalé, jusqu'au retour à la normale
+    StallCallback stallCallback;
+
+    // loop(), lus par le timer
+    std::atomic<uint32_t> lastLoopMs{0};
+    uint32_t lastLoopUs = 0;
+    uint32_t iterations = 0;
+    uint64_t totalLoopUs = 0;
+    uint32_t maxLoopUs = 0;
+    Percentiles loopLatency;
+
+    PostMortem previous;
+    bool hasPrevious = false;
+    bool reportPending = false;
+    esp_reset_reason_t resetReason = ESP_RST_UNKNOWN;
+
+    static void timerCallback(void *arg) { ((WatchdogRegistry *)arg)->check(); }
+
+    static uint32_t checksum(const PostMortem &pm)
+    {
+        const uint8_t *data = (const uint8_t *)&pm + offsetof(PostMortem, uptimeMs);
+        return Hash::fnv1a(data, sizeof(PostMortem) - offsetof(PostMortem, uptimeMs));
+    }
+
+    static void copyName(char *dst, const char *src)
+    {
+        strncpy(dst, src, NAME_SIZE - 1);
+        dst[NAME_SIZE - 1] = '\0';
+    }
+
+    // temps écoulé depuis since, 0 si since a été mis à jour après now (autre tâche)
+    static uint32_t elapsed(uint32_t now, uint32_t since)
+    {
+        int32_t d = (int32_t)(now - since);
+        return d > 0 ? (uint32_t)d : 0;
+    }
+
+    void record(Cause cause, const char *culprit, uint32_t now)
+    {
+        PostMortem &pm = rtcRecord;
+        memset(&pm, 0, sizeof(pm));
+        pm.uptimeMs = now;
+        pm.cause = cause;
+        copyName(pm.culprit, culprit);
+
+        pm.watchdogCount = watchdogCount;
+        for (size_t i = 0; i < watchdogCount; i++)
+        {
+            const SoftwareWatchdog &wd = *watchdogs[i];
+            copyName(pm.watchdogs[i].name, wd.getName().c_str());
+            pm.watchdogs[i].timeoutMs = wd.getTimeout();
+            pm.watchdogs[i].sinceFeedMs = elapsed(now, wd.getLastFeed());
+            pm.watchdogs[i].enabled = wd.isEnabled();
+        }
+
+        pm.loop.iterations = iterations;
+        pm.loop.sinceLastMs = elapsed(now, lastLoopMs.load(std::memory_order_relaxed));
+        pm.loop.avgUs = iterations > 1 ? totalLoopUs / (iterations - 1) : 0;
+        pm.loop.maxUs = maxLoopUs;
+        pm.loop.p50Us = loopLatency.getP50();
+        pm.loop.p95Us = loopLatency.getP95();
+        pm.loop.p99Us = loopLatency.getP99();
+
+        pm.taskCount = taskCount;
+        for (size_t i = 0; i < taskCount; i++)
+        {
+            copyName(pm.tasks[i].name, pcTaskGetName(tasks[i]));
+            pm.tasks[i].state = eTaskGetState(tasks[i]);
+            pm.tasks[i].priority = uxTaskPriorityGet(tasks[i]);
+            pm.tasks[i].stackFree = uxTaskGetStackHighWaterMark(tasks[i]);
+        }
+
+        pm.checksum = checksum(pm);
+        pm.magic = MAGIC;
+    }
+
+    static const char *causeName(uint8_t cause) { return cause == LOOP_STALL ? "loop_stall" : "watchdog"; }
+
+    static const char *stateName(uint8_t state)
+    {
+        static const char *const NAMES[] = {"running", "ready", "blocked", "suspended", "deleted"};
+        return state < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[state] : "invalid";
+    }
+
+    static const char *resetReasonName(esp_reset_reason_t reason)
+    {
+        switch (reason)
+        {
+        case ESP_RST_POWERON:
+            return "poweron";
+        case ESP_RST_EXT:
+            return "external";
+        case ESP_RST_SW:
+            return "software";
+        case ESP_RST_PANIC:
+            return "panic";
+        case ESP_RST_INT_WDT:
+            return "int_wdt";
+        case ESP_RST_TASK_WDT:
+            return "task_wdt";
+        case ESP_RST_WDT:
+            return "wdt";
+        case ESP_RST_DEEPSLEEP:
+            return "deepsleep";
+        case ESP_RST_BROWNOUT:
+            return "brownout";
+        default:
+            return "unknown";
+        }
+    }
+
+    static bool abnormal(esp_reset_reason_t reason)
+    {
+        return reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT ||
+               reason == ESP_RST_WDT || reason == ESP_RST_BROWNOUT;
+    }
+
+public:
+    WatchdogRegistry() {}
+    WatchdogRegistry(const WatchdogRegistry &) = delete;
+    WatchdogRegistry &operator=(const WatchdogRegistry &) = delete;
+
+    ~WatchdogRegistry()
+    {
+        if (timer != nullptr)
+        {
+            esp_timer_stop(timer);
+            esp_timer_delete(timer);
+        }
+    }
+
+    // Ajoute un watchdog à la vérification groupée (le watchdog doit survivre au registre)
+    bool watch(SoftwareWatchdog &watchdog)
+    {
+        if (watchdogCount >= MAX_WATCHDOGS)
+            return false;
+        watchdogs[watchdogCount++] = &watchdog;
+        return true;
+    }
+
+    // Ajoute une tâche FreeRTOS (workers, drain des logs...) aux états du
+    // post-mortem ; elle ne doit jamais être supprimée ensuite
+    bool watchTask(TaskHandle_t task)
+    {
+        if (task == nullptr || taskCount >= MAX_TASKS)
+            return false;
+        for (size_t i = 0; i < taskCount; i++)
+            if (tasks[i] == task)
+                return true;
+        tasks[taskCount++] = task;
+        return true;
+    }
+
+    /**
+     * Récupère le post-mortem du démarrage précédent et démarre la
+     * surveillance. À appeler depuis setup() (la tâche de loop()).
+     *
+     * @param checkPeriodMs Période de vérification (0 : seulement par check()).
+     * @param stallMs       Blocage de loop() toléré (0 : pas de surveillance de loop()).
+     * @param useTaskWdt    Abonne loop() au watchdog de tâches de l'ESP.
+     */
+    bool begin(uint32_t checkPeriodMs = 500, uint32_t stallMs = 3000, bool useTaskWdt = true)
+    {
+        resetReason = esp_reset_reason();
+        if (rtcRecord.magic == MAGIC && rtcRecord.checksum == checksum(rtcRecord))
+        {
+            previous = rtcRecord;
+            hasPrevious = true;
+        }
+        rtcRecord.magic = 0;
+        reportPending = hasPrevious || abnormal(resetReason);
+
+        loopStallMs = stallMs;
+        lastLoopMs.store(millis(), std::memory_order_relaxed);
+        watchTask(xTaskGetCurrentTaskHandle());
+
+        if (useTaskWdt && !taskWdt)
+            taskWdt = esp_task_wdt_add(nullptr) == ESP_OK;
+
+        if (checkPeriodMs == 0 || timer != nullptr)
+            return true;
+        esp_timer_create_args_t args = {};
+        args.callback = timerCallback;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "watchdogs";
+        if (esp_timer_create(&args, &timer) != ESP_OK)
+        {
+            timer = nullptr;
+            return false;
+        }
+        return esp_timer_start_periodic(timer, (uint64_t)checkPeriodMs * 1000) == ESP_OK;
+    }
+
+    /**
+     * À appeler au début de chaque tour de loop() : mesure l'itération
+     * précédente et réarme le TWDT.
+     */
+    void loopTick()
+    {
+        uint32_t nowUs = micros();
+        if (iterations > 0)
+        {
+            uint32_t duration = nowUs - lastLoopUs;
+            totalLoopUs += duration;
+            if (duration > maxLoopUs)
+                maxLoopUs = duration;
+            loopLatency.addValue(duration);
+        }
+        lastLoopUs = nowUs;
+        iterations++;
+        lastLoopMs.store(millis(), std::memory_order_relaxed);
+        if (taskWdt)
+            esp_task_wdt_reset();
+    }
+
+    /**
+     * Vérifie tous les watchdogs et loop() ; appelé par le timer de begin().
+     * Au premier blocage : post-mortem, onStall(), puis redémarrage.
+     *
+     * @return true si un blocage est en cours.
+     */
+    bool check()
+    {
+        uint32_t now = millis();
+        const char *culprit = nullptr;
+        Cause cause = WATCHDOG;
+        for (size_t i = 0; i < watchdogCount && culprit == nullptr; i++)
+        {
+            const SoftwareWatchdog &wd = *watchdogs[i];
+            if (wd.isEnabled() && elapsed(now, wd.getLastFeed()) > wd.getTimeout())
+                culprit = wd.getName().c_str();
+        }
+        if (culprit == nullptr && loopStallMs > 0 &&
+            elapsed(now, lastLoopMs.load(std::memory_order_relaxed)) > loopStallMs)
+        {
+            culprit = "loop";
+            cause = LOOP_STALL;
+        }
+
+        if (culprit == nullptr)
+        {
+            stalled = false;
+            return false;
+        }
+        if (stalled)
+            return true;
+        stalled = true;
+
+        record(cause, culprit, now);
+        if (stallCallback)
+            stallCallback(rtcRecord);
+        if (restart)
+            ESP.restart();
+        return true;
+    }
+
+    // false : post-mortem et onStall() sans redémarrage (tests, mise au point)
+    void setRestart(bool enabled) { restart = enabled; }
+    void onStall(StallCallback callback) { stallCallback = std::move(callback); }
+
+    // ═══ Démarrage suivant ═══
+
+    bool hasPostMortem() const { return hasPrevious; }
+    const PostMortem &getPostMortem() const { return previous; }
+    esp_reset_reason_t getResetReason() const { return resetReason; }
+
+    /**
+     * Post-mortem du démarrage précédent :
+     *     {"resetReason":"software","cause":"loop_stall","culprit":"loop","uptimeMs":..,
+     *      "watchdogs":[{"name":"mqtt","timeoutMs":..,"sinceFeedMs":..,"enabled":true}],
+     *      "loop":{"iterations":..,"sinceLastMs":..,"avgUs":..,"maxUs":..,"p50Us":..,"p95Us":..,"p99Us":..},
+     *      "tasks":[{"name":"loopTask","state":"running","priority":1,"stackFree":..}]}
+     * Sans post-mortem, seulement {"resetReason":".."}.
+     */
+    String postMortemJSON() const
+    {
+        String json = "{\"resetReason\":\"" + String(resetReasonName(resetReason)) + "\"";
+        if (!hasPrevious)
+            return json + "}";
+
+        const PostMortem &pm = previous;
+        json += ",\"cause\":\"" + String(causeName(pm.cause)) + "\",\"culprit\":\"" + String(pm.culprit) +
+                "\",\"uptimeMs\":" + String(pm.uptimeMs) + ",\"watchdogs\":[";
+        for (size_t i = 0; i < pm.watchdogCount && i < MAX_WATCHDOGS; i++)
+        {
+            if (i > 0)
+                json += ",";
+            json += "{\"name\":\"" + String(pm.watchdogs[i].name) + "\",\"timeoutMs\":" +
+                    String(pm.watchdogs[i].timeoutMs) + ",\"sinceFeedMs\":" + String(pm.watchdogs[i].sinceFeedMs) +
+                    ",\"enabled\":" + (pm.watchdogs[i].enabled ? "true" : "false") + "}";
+        }
+        json += "],\"loop\":{\"iterations\":" + String(pm.loop.iterations) + ",\"sinceLastMs\":" +
+                String(pm.loop.sinceLastMs) + ",\"avgUs\":" + String(pm.loop.avgUs) + ",\"maxUs\":" +
+                String(pm.loop.maxUs) + ",\"p50Us\":" + String(pm.loop.p50Us) + ",\"p95Us\":" +
+                String(pm.loop.p95Us) + ",\"p99Us\":" + String(pm.loop.p99Us) + "},\"tasks\":[";
+        for (size_t i = 0; i < pm.taskCount && i < MAX_TASKS; i++)
+        {
+            if (i > 0)
+                json += ",";
+            json += "{\"name\":\"" + String(pm.tasks[i].name) + "\",\"state\":\"" + stateName(pm.tasks[i].state) +
+                    "\",\"priority\":" + String(pm.tasks[i].priority) + ",\"stackFree\":" +
+                    String(pm.tasks[i].stackFree) + "}";
+        }
+        return json + "]}";
+    }
+
+    /**
+     * Publie le post-mortem (ou une cause de redémarrage anormale) sur
+     * <publishTopic>/postmortem, une seule fois. À appeler dans loop() :
+     * ne fait rien tant que MQTT n'est pas connecté.
+     *
+     * @return true quand il n'y a plus rien à publier.
+     */
+    bool publishPostMortem(MQTTController &mqtt)
+    {
+        if (!reportPending)
+            return true;
+        if (!mqtt.isConnected() || !mqtt.publish((mqtt.getPublishTopic() + "/postmortem").c_str(), postMortemJSON()))
+            return false;
+        reportPending = false;
+        return true;
+    }
+
+    // ═══ Statistiques de loop() ═══
+
+    uint32_t getLoopIterations() const { return iterations; }
+    uint32_t getLoopMaxUs() const { return maxLoopUs; }
+    const Percentiles &getLoopLatency() const { return loopLatency; }
+};
+
+#endif
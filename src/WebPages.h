@@ -104,9 +104,11 @@ namespace WebPages
       <a href="/config" class="nav-link"><span class="emoji">⚙️</span> WiFi</a>
       <a href="/mqtt" class="nav-link"><span class="emoji">📡</span> MQTT</a>
       <a href="/update" class="nav-link"><span class="emoji">⬆️</span> OTA</a>
+      <a href="/ota" class="nav-link"><span class="emoji">🧩</span> OTA Delta</a>
       <a href="/reboot" class="nav-link"><span class="emoji">🔄</span> Reboot</a>
       <a href="/reset" class="nav-link danger"><span class="emoji">❌</span> Reset</a>
       <a href="/status" class="nav-link"><span class="emoji">📊</span> Status</a>
+      <a href="/logs" class="nav-link"><span class="emoji">📜</span> Logs</a>
     </div>
   </div>
 </body>
@@ -312,6 +314,80 @@ namespace WebPages
     <a href="/" class="back-link">← Retour</a>
   </div>
 </body>
+</html>
+  )rawliteral";
+
+  const char OTA_UPLOAD_HTML[] PROGMEM = R"rawliteral(
+<!DOCTYPE html>
+<html lang="fr">
+<head>
+  <meta charset="UTF-8">
+  <meta name="viewport" content="width=device-width, initial-scale=1.0">
+  <title>TSPM-OTA</title>
+  <style>
+    * { margin: 0; padding: 0; box-sizing: border-box; }
+    body { 
+      font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif;
+      background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
+      min-height: 100vh;
+      display: flex;
+      justify-content: center;
+      align-items: center;
+      padding: 20px;
+    }
+    .container { 
+      background: white;
+      border-radius: 20px;
+      box-shadow: 0 20px 60px rgba(0,0,0,0.3);
+      max-width: 500px;
+      width: 100%;
+      padding: 40px;
+    }
+    h1 { color: #333; margin-bottom: 10px; text-align: center; }
+    .subtitle { text-align: center; color: #666; margin-bottom: 30px; font-size: 14px; }
+    input { width: 100%; padding: 12px; border: 2px solid #e0e0e0; border-radius: 8px; margin-bottom: 20px; }
+    progress { width: 100%; height: 20px; margin-bottom: 20px; }
+    button {
+      width: 100%;
+      padding: 15px;
+      background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
+      color: white;
+      border: none;
+      border-radius: 10px;
+      font-size: 16px;
+      font-weight: 600;
+      cursor: pointer;
+    }
+    #result { text-align: center; margin-top: 20px; color: #333; }
+    .back-link { display: block; text-align: center; margin-top: 20px; color: #667eea; text-decoration: none; }
+  </style>
+</head>
+<body>
+  <div class="container">
+    <h1>🧩 Mise à jour firmware</h1>
+    <p class="subtitle">Image complète (.bin) ou patch delta (.wdlt), brut ou compressé (.gz, .hs)</p>
+    <input type="file" id="file">
+    <progress id="progress" value="0" max="100"></progress>
+    <button onclick="upload()">⬆️ Envoyer</button>
+    <p id="result"></p>
+    <a href="/" class="back-link">← Retour</a>
+  </div>
+  <script>
+    function upload() {
+      var file = document.getElementById('file').files[0];
+      if (!file) return;
+      var data = new FormData();
+      data.append('firmware', file, file.name);
+      var xhr = new XMLHttpRequest();
+      xhr.upload.onprogress = function (e) {
+        if (e.lengthComputable) document.getElementById('progress').value = e.loaded * 100 / e.total;
+      };
+      xhr.onload = function () { document.getElementById('result').innerText = xhr.responseText; };
+      xhr.open('POST', '/ota/upload');
+      xhr.send(data);
+    }
+  </script>
+</body>
 </html>
   )rawliteral";
 }
@@ -5,6 +5,9 @@
 #include "WiFiManagerOTA.h"
 #include "WebPages.h"
 #include "utilities.h"
+#include "TimeSeriesStore.h"
+#include "CommandEngine.h"
+#include <memory>
 Logger logs;
 
 /**
@@ -24,7 +27,7 @@ Logger logs;
  */
 
 WiFiManagerOTA::WiFiManagerOTA(uint16_t port, const char *user, const char *pass)
-    : server(port), otaUser(user), otaPass(pass), lastReconnectAttempt(0)
+    : server(port), otaUser(user), otaPass(pass), lastReconnectAttempt(0), otaOwner(nullptr), rebootAt(0), lastOtaMetrics(nullptr), logHistory(nullptr), timeSeries(nullptr), scheduler(nullptr), commands(nullptr)
 {
     mqtt_config = {.hostname = "", .port = 8883, .user = "", .password = "", .client = ""};
 }
@@ -33,9 +36,9 @@ WiFiManagerOTA::WiFiManagerOTA(uint16_t port, const char *user, const char *pass
 
 void WiFiManagerOTA::begin(String hostname, String apName, String apPassword)
 {
-    logs.info("╔═══════════════════════════════════╗");
-    logs.info("║   WiFiManagerOTA Initialisation   ║");
-    logs.info("╚═══════════════════════════════════╝");
+    WLOG_INFO(logs, "╔═══════════════════════════════════╗");
+    WLOG_INFO(logs, "║   WiFiManagerOTA Initialisation   ║");
+    WLOG_INFO(logs, "╚═══════════════════════════════════╝");
 
     if (!connectToWiFi())
     {
@@ -44,20 +47,21 @@ void WiFiManagerOTA::begin(String hostname, String apName, String apPassword)
 
     setupRoutes();
     ElegantOTA.begin(&server, otaUser.c_str(), otaPass.c_str());
+    setupOtaMetrics();
     server.begin();
 
-    logs.info("Serveur web démarré");
+    WLOG_INFO(logs, "Serveur web démarré");
 
     if (MDNS.begin(hostname.c_str()))
     {
-        logs.info("mDNS actif: http://" + hostname + ".local");
+        WLOG_INFOF(logs, "mDNS actif: http://%s.local", hostname.c_str());
         MDNS.addService("http", "tcp", 80);
     }
 
-    logs.info("Accès:");
-    logs.info("\t\tUser: " + otaUser);
-    logs.info("\t\tPass: " + otaPass);
-    logs.info("═══════════════════════════════════");
+    WLOG_INFO(logs, "Accès:");
+    WLOG_INFOF(logs, "\t\tUser: %s", otaUser.c_str());
+    WLOG_INFOF(logs, "\t\tPass: %s", otaPass.c_str());
+    WLOG_INFO(logs, "═══════════════════════════════════");
 }
 
 /**
@@ -69,6 +73,14 @@ void WiFiManagerOTA::begin(String hostname, String apName, String apPassword)
 void WiFiManagerOTA::loop()
 {
     ElegantOTA.loop();
+
+    // Redémarrage différé après une mise à jour via /ota/upload
+    if (rebootAt != 0 && (long)(millis() - rebootAt) >= 0)
+    {
+        WLOG_INFO(logs, "Redémarrage après mise à jour");
+        LogDispatcher::instance().flush();
+        ESP.restart();
+    }
 }
 
 /**
@@ -83,7 +95,7 @@ void WiFiManagerOTA::handleWiFiReconnect()
         unsigned long now = millis();
         if (now - lastReconnectAttempt > 30000)
         {
-            logs.info("Tentative de reconnexion WiFi...");
+            WLOG_INFO(logs, "Tentative de reconnexion WiFi...");
             lastReconnectAttempt = now;
             connectToWiFi(10, 500);
         }
@@ -113,18 +125,18 @@ void WiFiManagerOTA::loadConfig()
     config.dns2 = prefs.getString("dns2", "8.8.4.4");           // Nouveau (Google DNS secondaire)
     prefs.end();
 
-    logs.info("Configuration WiFi chargée:");
-    logs.info("  SSID: " + config.ssid);
-    logs.info("  Topic: " + config.topic);
-    logs.info("  User ID: " + config.user_id);
-    logs.info(String("  IP Statique: ") + (config.useStaticIP ? "Activé" : "Désactivé"));
+    WLOG_INFO(logs, "Configuration WiFi chargée:");
+    WLOG_INFOF(logs, "  SSID: %s", config.ssid.c_str());
+    WLOG_INFOF(logs, "  Topic: %s", config.topic.c_str());
+    WLOG_INFOF(logs, "  User ID: %s", config.user_id.c_str());
+    WLOG_INFOF(logs, "  IP Statique: %s", config.useStaticIP ? "Activé" : "Désactivé");
     if (config.useStaticIP)
     {
-        logs.info("  IP: " + config.staticIP);
-        logs.info("  Subnet: " + config.subnet);
-        logs.info("  Gateway: " + config.gateway);
-        logs.info("  DNS1: " + config.dns1);
-        logs.info("  DNS2: " + config.dns2);
+        WLOG_INFOF(logs, "  IP: %s", config.staticIP.c_str());
+        WLOG_INFOF(logs, "  Subnet: %s", config.subnet.c_str());
+        WLOG_INFOF(logs, "  Gateway: %s", config.gateway.c_str());
+        WLOG_INFOF(logs, "  DNS1: %s", config.dns1.c_str());
+        WLOG_INFOF(logs, "  DNS2: %s", config.dns2.c_str());
     }
 }
 
@@ -151,10 +163,10 @@ void WiFiManagerOTA::loadMqttConfig()
         mqtt_config.port = 8883;
     }
 
-    logs.info("Configuration MQTT chargée:");
-    logs.info("  Hostname: " + mqtt_config.hostname);
-    logs.info("  Port: " + String(mqtt_config.port));
-    logs.info("  Client: " + mqtt_config.client);
+    WLOG_INFO(logs, "Configuration MQTT chargée:");
+    WLOG_INFOF(logs, "  Hostname: %s", mqtt_config.hostname.c_str());
+    WLOG_INFOF(logs, "  Port: %d", mqtt_config.port);
+    WLOG_INFOF(logs, "  Client: %s", mqtt_config.client.c_str());
 }
 
 /**
@@ -177,7 +189,7 @@ void WiFiManagerOTA::saveConfig()
     prefs.putString("dns1", config.dns1);             // Nouveau
     prefs.putString("dns2", config.dns2);             // Nouveau
     prefs.end();
-    logs.info("Configuration WiFi sauvegardée");
+    WLOG_INFO(logs, "Configuration WiFi sauvegardée");
 }
 /**
  * Sauvegarde la configuration MQTT actuelle dans les préférences.
@@ -194,7 +206,7 @@ void WiFiManagerOTA::saveMqttConfig()
     prefs.putString("password", mqtt_config.password);
     prefs.putString("client", mqtt_config.client);
     prefs.end();
-    logs.info("Configuration MQTT sauvegardée");
+    WLOG_INFO(logs, "Configuration MQTT sauvegardée");
 }
 
 /**
@@ -213,7 +225,7 @@ void WiFiManagerOTA::resetConfig()
     prefs.clear();
     prefs.end();
 
-    logs.info("Configuration effacée");
+    WLOG_INFO(logs, "Configuration effacée");
 }
 
 /**
@@ -231,7 +243,7 @@ bool WiFiManagerOTA::connectToWiFi(int maxAttempts, int delayMs)
     loadConfig();
     if (config.ssid == "" || config.password == "")
     {
-        logs.error("Pas de configuration WiFi");
+        WLOG_ERROR(logs, "Pas de configuration WiFi");
         return false;
     }
 
@@ -243,33 +255,33 @@ bool WiFiManagerOTA::connectToWiFi(int maxAttempts, int delayMs)
             gateway.fromString(config.gateway) && dns1.fromString(config.dns1) && dns2.fromString(config.dns2))
         {
             WiFi.config(ip, gateway, subnet, dns1, dns2);
-            logs.info("Configuration IP statique appliquée");
+            WLOG_INFO(logs, "Configuration IP statique appliquée");
         }
         else
         {
-            logs.error("Adresses IP statiques invalides, utilisation DHCP");
+            WLOG_ERROR(logs, "Adresses IP statiques invalides, utilisation DHCP");
         }
     }
     WiFi.begin(config.ssid.c_str(), config.password.c_str());
-    logs.info("Connexion à " + config.ssid);
+    WLOG_INFOF(logs, "Connexion à %s", config.ssid.c_str());
 
     unsigned long startAttempt = millis();
     while (WiFi.status() != WL_CONNECTED && millis() - startAttempt < (maxAttempts * delayMs))
     {
-        logs.info(".");
+        WLOG_INFO(logs, ".");
         delay(delayMs);
     }
 
     if (WiFi.status() == WL_CONNECTED)
     {
-        logs.info("Connecté !");
-        logs.info("  IP: " + WiFi.localIP().toString());
-        logs.info("  Signal: " + String(WiFi.RSSI()) + " dBm");
+        WLOG_INFO(logs, "Connecté !");
+        WLOG_INFOF(logs, "  IP: %s", WiFi.localIP().toString().c_str());
+        WLOG_INFOF(logs, "  Signal: %d dBm", (int)WiFi.RSSI());
         wifi_connected = true;
         return true;
     }
 
-    logs.critical("Connexion échouée");
+    WLOG_CRITICAL(logs, "Connexion échouée");
     wifi_connected = false;
     return false;
 }
@@ -285,10 +297,10 @@ void WiFiManagerOTA::startAccessPoint(String apName, String password)
 {
     WiFi.mode(WIFI_AP);
     WiFi.softAP(apName.c_str(), password.c_str());
-    logs.info("Point d'accès démarré");
-    logs.info("  SSID: " + apName);
-    logs.info("  IP: " + WiFi.softAPIP().toString());
-    logs.info("  Mot de passe: " + password);
+    WLOG_INFO(logs, "Point d'accès démarré");
+    WLOG_INFOF(logs, "  SSID: %s", apName.c_str());
+    WLOG_INFOF(logs, "  IP: %s", WiFi.softAPIP().toString().c_str());
+    WLOG_INFOF(logs, "  Mot de passe: %s", password.c_str());
 }
 
 /**
@@ -323,7 +335,7 @@ String WiFiManagerOTA::formatUptime()
 String WiFiManagerOTA::pubTopic(String version)
 {
     String full = config.topic + version + config.user_id;
-    logs.info("Topic publication: " + full);
+    WLOG_INFOF(logs, "Topic publication: %s", full.c_str());
     return full;
 }
 
@@ -337,7 +349,7 @@ String WiFiManagerOTA::pubTopic(String version)
 String WiFiManagerOTA::cmdTopic(String version, String cmd)
 {
     String full = config.topic + version + config.user_id + cmd;
-    logs.info("Topic commande: " + full);
+    WLOG_INFOF(logs, "Topic commande: %s", full.c_str());
     return full;
 }
 
@@ -447,6 +459,305 @@ void WiFiManagerOTA::handleConfigPage(AsyncWebServerRequest *request)
     WiFi.scanDelete();
 }
 
+/**
+ * Reçoit un firmware envoyé sur /ota/upload (image complète ou patch delta).
+ *
+ * Les blocs sont transmis à OTAUpdater au fil de l'eau : le fichier n'est
+ * jamais stocké en RAM. La mise à jour appartient à la requête qui l'a
+ * commencée : les blocs des autres requêtes sont ignorés, et un second
+ * envoi est refusé (409) tant que la première n'est pas terminée.
+ *
+ * @param request La requête HTTP reçue.
+ * @param filename Nom du fichier envoyé.
+ * @param index Position du bloc dans le fichier.
+ * @param data Données du bloc.
+ * @param len Taille du bloc.
+ * @param final true pour le dernier bloc.
+ */
+void WiFiManagerOTA::handleOtaUpload(AsyncWebServerRequest *request, const String &filename,
+                                     size_t index, uint8_t *data, size_t len, bool final)
+{
+    if (index == 0)
+    {
+        if (!request->authenticate(otaUser.c_str(), otaPass.c_str()))
+            return;
+        if (otaOwner != nullptr)
+        {
+            WLOG_WARNINGF(logs, "OTA déjà en cours, envoi de %s ignoré", filename.c_str());
+            return;
+        }
+        WLOG_INFOF(logs, "Mise à jour OTA: %s", filename.c_str());
+        otaOwner = request;
+        // connexion coupée en cours d'envoi : la mise à jour est abandonnée
+        request->onDisconnect([this, request]()
+                              {
+            if (otaOwner != request)
+                return;
+            otaOwner = nullptr;
+            if (otaUpdater.isRunning())
+            {
+                otaUpdater.abort();
+                reportOtaMetrics(otaUpdater.getMetrics());
+            } });
+        // échec (autre mise à jour en cours) : signalé par la réponse finale
+        if (!otaUpdater.begin())
+            WLOG_ERRORF(logs, "OTA: %s", otaUpdater.getError().c_str());
+    }
+
+    if (request != otaOwner || !otaUpdater.isRunning())
+        return;
+
+    if (len > 0 && !otaUpdater.write(data, len))
+    {
+        WLOG_ERRORF(logs, "OTA: %s", otaUpdater.getError().c_str());
+        reportOtaMetrics(otaUpdater.getMetrics());
+        return;
+    }
+
+    if (final)
+    {
+        if (otaUpdater.end())
+            WLOG_INFOF(logs, "OTA terminée: %u octets écrits", (unsigned)otaUpdater.getWritten());
+        else
+            WLOG_ERRORF(logs, "OTA: %s", otaUpdater.getError().c_str());
+        reportOtaMetrics(otaUpdater.getMetrics());
+    }
+}
+
+/**
+ * Instrumente les mises à jour de la page ElegantOTA (/update).
+ *
+ * ElegantOTA écrit lui-même dans la flash : seuls le débit de réception et
+ * la durée totale sont mesurés. Un callback onStart/onProgress/onEnd
+ * installé ensuite par le sketch remplace celui-ci.
+ */
+void WiFiManagerOTA::setupOtaMetrics()
+{
+    ElegantOTA.onStart([this]()
+                       { elegantMetrics.begin("elegantota"); });
+    ElegantOTA.onProgress([this](size_t current, size_t)
+                          { elegantMetrics.recordProgress(current); });
+    ElegantOTA.onEnd([this](bool success)
+                     {
+        elegantMetrics.end(success);
+        reportOtaMetrics(elegantMetrics); });
+}
+
+/**
+ * Journalise les mesures d'une mise à jour terminée et les transmet au
+ * callback onOtaEnd() (publication MQTT par le sketch, par exemple).
+ *
+ * @param metrics Mesures de la mise à jour.
+ */
+void WiFiManagerOTA::reportOtaMetrics(const OTAMetrics &metrics)
+{
+    lastOtaMetrics = &metrics;
+    WLOG_INFO(logs, "OTA " + metrics.toString());
+    if (otaEndCallback)
+        otaEndCallback(metrics);
+}
+
+/**
+ * Définit le callback appelé à la fin de chaque mise à jour web, réussie ou
+ * non, avant le redémarrage.
+ *
+ * @param callback Fonction recevant les mesures de la mise à jour.
+ */
+void WiFiManagerOTA::onOtaEnd(OtaMetricsCallback callback)
+{
+    otaEndCallback = callback;
+}
+
+/**
+ * Retourne les mesures de la dernière mise à jour web.
+ *
+ * @return nullptr si aucune mise à jour n'a eu lieu depuis le démarrage.
+ */
+const OTAMetrics *WiFiManagerOTA::getLastOtaMetrics()
+{
+    return lastOtaMetrics;
+}
+
+/**
+ * Définit l'historique de logs servi sur /logs (par exemple un
+ * MemoryLogSink ajouté à LogDispatcher).
+ *
+ * @param history Historique, nullptr pour désactiver la page.
+ */
+void WiFiManagerOTA::setLogHistory(LogHistory *history)
+{
+    logHistory = history;
+}
+
+/**
+ * Sert l'historique des logs en texte brut, une ligne par entrée.
+ *
+ * La réponse est envoyée par blocs, ligne par ligne : la mémoire utilisée
+ * ne dépend pas de la taille de l'historique. Les lignes sont lues par
+ * numéro, jusqu'à la dernière écrite à l'arrivée de la requête : celles
+ * écrasées pendant l'envoi sont sautées, aucune n'est répétée. Le
+ * paramètre optionnel "since" (millis) ne renvoie que les lignes plus
+ * récentes.
+ *
+ * @param request Requête HTTP.
+ */
+void WiFiManagerOTA::handleLogs(AsyncWebServerRequest *request)
+{
+    if (logHistory == nullptr)
+    {
+        request->send(404, "text/plain", "Historique des logs désactivé (setLogHistory)");
+        return;
+    }
+
+    struct Cursor
+    {
+        uint32_t next; // numéro de ligne (LogHistory::get())
+        uint32_t end;
+        uint32_t since;
+        char line[2 * WIFIOTA_LOG_BUFFER_SIZE + 32]; // trames binaires en hexadécimal
+        size_t len;
+        size_t pos;
+    };
+    std::shared_ptr<Cursor> cursor = std::make_shared<Cursor>();
+    cursor->len = cursor->pos = 0;
+    cursor->end = logHistory->written();
+    cursor->next = cursor->end - logHistory->count();
+    cursor->since = request->hasParam("since") ? request->getParam("since")->value().toInt() : 0;
+
+    LogHistory *history = logHistory;
+    request->send(request->beginChunkedResponse("text/plain; charset=utf-8", [history, cursor](uint8_t *buffer, size_t maxLen, size_t) -> size_t
+                                                {
+        size_t written = 0;
+        while (written < maxLen)
+        {
+            if (cursor->pos == cursor->len)
+            {
+                if (cursor->next == cursor->end)
+                    break;
+                LogRecord record;
+                if (!history->get(cursor->next++, record))
+                    continue; // écrasée depuis le début de la réponse
+                if (cursor->since > 0 && record.timestamp <= cursor->since)
+                    continue;
+                int n;
+                if (record.format == LogRecord::BINARY)
+                {
+                    // Trame en hexadécimal après '#', lisible par tools/wlog_decode.py
+                    n = snprintf(cursor->line, sizeof(cursor->line), "%lu.%03lu #",
+                                 (unsigned long)(record.timestamp / 1000), (unsigned long)(record.timestamp % 1000));
+                    for (size_t i = 0; i < record.length && n + 3 < (int)sizeof(cursor->line); i++)
+                        n += snprintf(cursor->line + n, sizeof(cursor->line) - n, "%02x", (uint8_t)record.text[i]);
+                    cursor->line[n++] = '\n';
+                }
+                else
+                    n = snprintf(cursor->line, sizeof(cursor->line), "%lu.%03lu %s%.*s\n",
+                                 (unsigned long)(record.timestamp / 1000), (unsigned long)(record.timestamp % 1000),
+                                 logLevelPrefix(record.level), (int)record.length, record.text);
+                cursor->len = n > 0 ? min((size_t)n, sizeof(cursor->line) - 1) : 0;
+                cursor->pos = 0;
+            }
+            size_t n = min(maxLen - written, cursor->len - cursor->pos);
+            memcpy(buffer + written, cursor->line + cursor->pos, n);
+            cursor->pos += n;
+            written += n;
+        }
+        return written; }));
+}
+
+/**
+ * Définit l'historique de mesures servi sur /api/history.
+ *
+ * @param store Historique (TimeSeriesStore::begin() déjà appelé), nullptr pour désactiver.
+ */
+void WiFiManagerOTA::setTimeSeries(TimeSeriesStore *store)
+{
+    timeSeries = store;
+}
+
+/**
+ * Ajoute le profil des tâches périodiques ("tasks") au JSON de /status.
+ *
+ * @param taskScheduler Ordonnanceur de l'application, nullptr pour retirer la section.
+ */
+void WiFiManagerOTA::setScheduler(const TaskScheduler *taskScheduler)
+{
+    scheduler = taskScheduler;
+}
+
+/**
+ * Sert l'historique d'une métrique en JSON :
+ * /api/history?metric=temp&from=<unix>&to=<unix>&step=<secondes>.
+ *
+ * Sans paramètre "metric", renvoie la liste des métriques. Les points sont
+ * lus sur la flash et envoyés par blocs au fil de la réponse.
+ *
+ * @param request Requête HTTP.
+ */
+void WiFiManagerOTA::handleHistory(AsyncWebServerRequest *request)
+{
+    if (timeSeries == nullptr)
+    {
+        request->send(404, "text/plain", "Historique désactivé (setTimeSeries)");
+        return;
+    }
+    if (!request->hasParam("metric"))
+    {
+        request->send(200, "application/json", timeSeries->metricsJson());
+        return;
+    }
+
+    auto param = [request](const char *name) -> uint32_t
+    { return request->hasParam(name) ? strtoul(request->getParam(name)->value().c_str(), nullptr, 10) : 0; };
+    std::shared_ptr<TimeSeriesStore::Query> query =
+        timeSeries->query(request->getParam("metric")->value().c_str(), param("from"), param("to"), param("step"));
+    if (!query)
+    {
+        request->send(404, "text/plain", "Métrique inconnue");
+        return;
+    }
+
+    request->send(request->beginChunkedResponse("application/json", [query](uint8_t *buffer, size_t maxLen, size_t) -> size_t
+                                                { return query->read(buffer, maxLen); }));
+}
+
+/**
+ * Définit le moteur de commandes servi sur /cmd.
+ *
+ * @param engine Moteur de commandes, nullptr pour désactiver la page.
+ */
+void WiFiManagerOTA::setCommandEngine(CommandEngine *engine)
+{
+    commands = engine;
+}
+
+/**
+ * Exécute une commande texte : /cmd?line=led%20128 (GET, ou POST en
+ * formulaire). La réponse de la commande est renvoyée en texte brut, avec
+ * 404 pour une commande inconnue et 400 pour des arguments invalides.
+ *
+ * @param request Requête HTTP.
+ */
+void WiFiManagerOTA::handleCommand(AsyncWebServerRequest *request)
+{
+    if (commands == nullptr)
+    {
+        request->send(404, "text/plain", "Commandes désactivées (setCommandEngine)");
+        return;
+    }
+    const AsyncWebParameter *line = request->hasParam("line", true) ? request->getParam("line", true) : request->getParam("line");
+    if (line == nullptr)
+    {
+        request->send(400, "text/plain", "Paramètre line manquant");
+        return;
+    }
+
+    CommandReply reply;
+    const String &text = line->value();
+    CommandEngine::Result result = commands->execute(text.c_str(), text.length(), reply);
+    int code = result == CommandEngine::OK ? 200 : result == CommandEngine::UNKNOWN ? 404 : 400;
+    request->send(code, "text/plain; charset=utf-8", reply.c_str());
+}
+
 /**
  * Configure les routes de l'API OTA.
  *
@@ -562,10 +873,81 @@ void WiFiManagerOTA::setupRoutes()
     json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + ",";
     json += "\"chipModel\":\"" + String(ESP.getChipModel()) + "\",";
     json += "\"cpuFreq\":" + String(ESP.getCpuFreqMHz());
+    if (lastOtaMetrics)
+      json += ",\"ota\":" + lastOtaMetrics->toJson();
+    if (scheduler)
+      json += ",\"tasks\":" + scheduler->statsJSON();
     json += "}";
     
     request->send(200, "application/json", json); });
 
+    // Log history
+    server.on("/logs", HTTP_GET, [this](AsyncWebServerRequest *request)
+              {
+    if (!request->authenticate(otaUser.c_str(), otaPass.c_str())) {
+      return request->requestAuthentication();
+    }
+    handleLogs(request); });
+
+    // Measurement history
+    server.on("/api/history", HTTP_GET, [this](AsyncWebServerRequest *request)
+              {
+    if (!request->authenticate(otaUser.c_str(), otaPass.c_str())) {
+      return request->requestAuthentication();
+    }
+    handleHistory(request); });
+
+    // Text commands
+    server.on("/cmd", HTTP_GET | HTTP_POST, [this](AsyncWebServerRequest *request)
+              {
+    if (!request->authenticate(otaUser.c_str(), otaPass.c_str())) {
+      return request->requestAuthentication();
+    }
+    handleCommand(request); });
+
+    // Firmware upload (full image or delta patch)
+    server.on("/ota", HTTP_GET, [this](AsyncWebServerRequest *request)
+              {
+    if (!request->authenticate(otaUser.c_str(), otaPass.c_str())) {
+      return request->requestAuthentication();
+    }
+    request->send(200, "text/html", WebPages::OTA_UPLOAD_HTML); });
+
+    server.on("/ota/upload", HTTP_POST, [this](AsyncWebServerRequest *request)
+              {
+    if (!request->authenticate(otaUser.c_str(), otaPass.c_str())) {
+      return request->requestAuthentication();
+    }
+
+    // Requête qui n'a pas commencé la mise à jour en cours (ou aucune)
+    if (request != otaOwner) {
+      if (otaOwner != nullptr) request->send(409, "text/plain", "⚠️ Mise à jour déjà en cours");
+      else request->send(400, "text/plain", "⚠️ Aucun firmware reçu");
+      return;
+    }
+    otaOwner = nullptr;
+
+    if (otaUpdater.hasFailed() || otaUpdater.isRunning()) {
+      String error = otaUpdater.hasFailed() ? otaUpdater.getError() : String("Upload incomplet");
+      bool incomplete = otaUpdater.isRunning();
+      otaUpdater.abort();
+      if (incomplete) reportOtaMetrics(otaUpdater.getMetrics());
+      request->send(500, "text/plain", "⚠️ " + error);
+      return;
+    }
+
+    // Pas de partie fichier, ou fichier vide : rien n'a été écrit
+    if (!otaUpdater.isCompleted()) {
+      request->send(400, "text/plain", "⚠️ Aucun firmware reçu");
+      return;
+    }
+
+    request->send(200, "text/plain", "✅ Mise à jour réussie, redémarrage...");
+    rebootAt = millis() + 1000; },
+              [this](AsyncWebServerRequest *request, const String &filename, size_t index,
+                     uint8_t *data, size_t len, bool final)
+              { handleOtaUpload(request, filename, index, data, len, final); });
+
     // Reset config
     server.on("/reset", HTTP_GET, [this](AsyncWebServerRequest *request)
               {
@@ -10,10 +10,17 @@
 #include <ESPAsyncWebServer.h>
 #include <ElegantOTA.h>
 #include <Preferences.h>
+#include <functional>
 #include "utilities.h"
+#include "OTAUpdater.h"
 
 extern bool wifi_connected;
 
+class LogHistory;
+class TimeSeriesStore;
+class TaskScheduler;
+class CommandEngine;
+
 
 
 class WiFiManagerOTA
@@ -40,6 +47,8 @@ public:
         String dns2;    
     };
 
+    typedef std::function<void(const OTAMetrics &)> OtaMetricsCallback;
+
     void setLogger(bool active =true);
 
     WiFiManagerOTA(uint16_t port = 80, const char *user = "admin", const char *pass = "admin123");
@@ -69,6 +78,22 @@ public:
     WiFiConfigStruct getWiFiConfig();
     bool hasValidConfig();
 
+    // OTA metrics (/ota/upload and ElegantOTA /update)
+    void onOtaEnd(OtaMetricsCallback callback);
+    const OTAMetrics *getLastOtaMetrics();
+
+    // Log history served on /logs
+    void setLogHistory(LogHistory *history);
+
+    // Measurement history served on /api/history
+    void setTimeSeries(TimeSeriesStore *store);
+
+    // Task profiles added to /status
+    void setScheduler(const TaskScheduler *scheduler);
+
+    // Text commands served on /cmd
+    void setCommandEngine(CommandEngine *engine);
+
 private:
     struct WiFiConfig
     {
@@ -91,10 +116,27 @@ private:
     String otaUser;
     String otaPass;
     unsigned long lastReconnectAttempt;
+    OTAUpdater otaUpdater;
+    AsyncWebServerRequest *otaOwner; // requête dont les blocs sont écrits
+    unsigned long rebootAt;
+    OTAMetrics elegantMetrics;
+    const OTAMetrics *lastOtaMetrics;
+    OtaMetricsCallback otaEndCallback;
+    LogHistory *logHistory;
+    TimeSeriesStore *timeSeries;
+    const TaskScheduler *scheduler;
+    CommandEngine *commands;
 
     // Web pages HTML
     void setupRoutes();
     void handleConfigPage(AsyncWebServerRequest *request);
+    void handleOtaUpload(AsyncWebServerRequest *request, const String &filename,
+                         size_t index, uint8_t *data, size_t len, bool final);
+    void setupOtaMetrics();
+    void reportOtaMetrics(const OTAMetrics &metrics);
+    void handleLogs(AsyncWebServerRequest *request);
+    void handleHistory(AsyncWebServerRequest *request);
+    void handleCommand(AsyncWebServerRequest *request);
     String formatUptime();
 
     // HTML templates
@@ -0,0 +1,197 @@
+// ============================================
+// WindowedStatistics.h - Statistiques sur fenêtre glissante (sans dépendance Arduino)
+// ============================================
+#ifndef WINDOWED_STATISTICS_H
+#define WINDOWED_STATISTICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <type_traits>
+
+// Min, max, moyenne et variance des N dernières valeurs, et/ou des valeurs
+// des maxAge dernières millisecondes, en O(1) amorti par valeur.
+//
+// Les valeurs sont conservées dans un anneau fixe de N éléments. Le minimum
+// et le maximum viennent de deux files monotones de positions dans l'anneau :
+// une valeur qui ne pourra plus jamais être le minimum (une plus petite est
+// arrivée après elle) est retirée de la file des minimums, si bien que la
+// tête de file est toujours le minimum de la fenêtre. Chaque position entre
+// et sort au plus une fois de chaque file.
+//
+// Moyenne et variance sont tenues à jour par Welford (ajout et retrait) en
+// double, puis recalculées exactement depuis l'anneau toutes les N sorties
+// pour effacer l'erreur d'arrondi accumulée : toujours O(1) amorti.
+//
+// Aucune allocation : N * (sizeof(T) + 4 + 2 * sizeof(Index)) octets environ.
+// Pas de section critique : à protéger si addValue() et les lectures sont
+// appelées depuis deux tâches.
+
+template <typename T, size_t N>
+class WindowedStatistics
+{
+    static_assert(N >= 1, "WindowedStatistics: N doit être au moins 1");
+
+    typedef typename std::conditional<(N <= 0xFFFF), uint16_t, uint32_t>::type Index;
+
+    // File monotone de positions dans l'anneau (au plus N éléments)
+    struct Deque
+    {
+        Index items[N];
+        size_t head = 0; // position de la tête dans items
+        size_t count = 0;
+
+        Index front() const { return items[head]; }
+        Index back() const { return items[(head + count - 1) % N]; }
+        void popFront()
+        {
+            head = (head + 1) % N;
+            count--;
+        }
+        void popBack() { count--; }
+        void pushBack(Index i) { items[(head + count++) % N] = i; }
+    };
+
+    T values[N];
+    uint32_t stamps[N];
+    size_t oldest = 0; // position de la plus ancienne valeur
+    size_t count = 0;
+
+    Deque minQ; // valeurs croissantes
+    Deque maxQ; // valeurs décroissantes
+
+    double mean = 0;
+    double m2 = 0;
+    size_t removals = 0;
+
+    uint32_t maxAge;
+
+    void evictOldest()
+    {
+        Index pos = (Index)oldest;
+        if (minQ.count > 0 && minQ.front() == pos)
+            minQ.popFront();
+        if (maxQ.count > 0 && maxQ.front() == pos)
+            maxQ.popFront();
+
+        double x = (double)values[pos];
+        oldest = (oldest + 1) % N;
+        count--;
+        if (count == 0)
+        {
+            mean = m2 = 0;
+        }
+        else if (++removals >= N)
+        {
+            recompute();
+        }
+        else
+        {
+            double delta = x - mean;
+            mean -= delta / count;
+            m2 -= delta * (x - mean);
+            if (m2 < 0)
+                m2 = 0;
+        }
+    }
+
+    void recompute()
+    {
+        removals = 0;
+        double sum = 0;
+        for (size_t i = 0; i < count; i++)
+            sum += (double)values[(oldest + i) % N];
+        mean = sum / count;
+        m2 = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            double d = (double)values[(oldest + i) % N] - mean;
+            m2 += d * d;
+        }
+    }
+
+public:
+    /**
+     * @param maxAgeMs Durée de la fenêtre en ms ; 0 pour une fenêtre des
+     *                 N dernières valeurs uniquement. Avec une durée, N borne
+     *                 le nombre de valeurs retenues (dimensionner N pour la
+     *                 cadence d'échantillonnage).
+     */
+    explicit WindowedStatistics(uint32_t maxAgeMs = 0) : maxAge(maxAgeMs) {}
+
+    /**
+     * Ajoute une valeur ; la plus ancienne sort si la fenêtre est pleine.
+     *
+     * @param now Horodatage en ms (millis()), utilisé par les fenêtres en durée.
+     */
+    void addValue(T value, uint32_t now = 0)
+    {
+        expire(now);
+        if (count == N)
+            evictOldest();
+
+        Index pos = (Index)((oldest + count) % N);
+        values[pos] = value;
+        stamps[pos] = now;
+        count++;
+
+        while (minQ.count > 0 && values[minQ.back()] > value)
+            minQ.popBack();
+        minQ.pushBack(pos);
+        while (maxQ.count > 0 && values[maxQ.back()] < value)
+            maxQ.popBack();
+        maxQ.pushBack(pos);
+
+        double delta = (double)value - mean;
+        mean += delta / count;
+        m2 += delta * ((double)value - mean);
+    }
+
+    /**
+     * Retire les valeurs plus anciennes que maxAge (sans effet en fenêtre
+     * par nombre). À appeler avant de lire si aucune valeur n'arrive.
+     *
+     * @return Nombre de valeurs retirées.
+     */
+    size_t expire(uint32_t now)
+    {
+        if (maxAge == 0)
+            return 0;
+        size_t removed = 0;
+        while (count > 0 && now - stamps[oldest] > maxAge)
+        {
+            evictOldest();
+            removed++;
+        }
+        return removed;
+    }
+
+    T getMin() const { return count > 0 ? values[minQ.front()] : T(); }
+    T getMax() const { return count > 0 ? values[maxQ.front()] : T(); }
+    float getAverage() const { return count > 0 ? (float)mean : 0; }
+
+    // Variance de la population, comme Statistics
+    float getVariance() const { return count > 1 ? (float)(m2 / count) : 0; }
+    float getStdDev() const { return sqrtf(getVariance()); }
+
+    // Valeur la plus récente
+    T getLast() const { return count > 0 ? values[(oldest + count - 1) % N] : T(); }
+
+    size_t getCount() const { return count; }
+    bool isFull() const { return count == N; }
+    static constexpr size_t capacity() { return N; }
+
+    uint32_t getMaxAge() const { return maxAge; }
+    void setMaxAge(uint32_t maxAgeMs) { maxAge = maxAgeMs; }
+
+    void reset()
+    {
+        oldest = count = 0;
+        minQ.head = minQ.count = 0;
+        maxQ.head = maxQ.count = 0;
+        mean = m2 = 0;
+        removals = 0;
+    }
+};
+
+#endif
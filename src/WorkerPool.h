@@ -0,0 +1,261 @@
+// ============================================
+// WorkerPool.h - Exécution de travaux sur des tâches FreeRTOS réparties sur les cœurs
+// ============================================
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "InplaceFunction.h"
+#include "SpscRing.h"
+#include "TaskScheduler.h"
+
+// loop() tourne sur un seul cœur (le 1) pendant que l'autre attend le
+// réseau. Le pool démarre quelques tâches FreeRTOS (workers), épinglées
+// sur un cœur avec leur priorité, et leur confie des travaux : encodage de
+// charges utiles, filtrage, calculs... en parallèle de loop().
+//
+// Chaque worker a sa propre file SpscRing, sans verrou : le seul
+// producteur est la tâche qui appelle submit() (loop() en général, la même
+// que celle du TaskScheduler), le seul consommateur est le worker. submit()
+// ne doit donc être appelé que depuis une tâche à la fois ; depuis une ISR
+// ou plusieurs tâches, utiliser un pool par producteur.
+//
+// Le cœur et la priorité passés à submit() sont des préférences : le
+// travail va au worker compatible dont la file est la plus courte, ou à
+// défaut à n'importe quel worker qui a de la place. Si toutes les files
+// sont pleines, submit() renvoie false et l'appelant décide (exécuter sur
+// place, réessayer, abandonner).
+//
+// Tant que begin() ou addWorker() n'ont pas été appelés, submit() exécute
+// le travail immédiatement dans l'appelant, comme LogDispatcher avant son
+// begin().
+
+#ifndef WIFIOTA_WORKER_POOL_MAX_WORKERS
+#define WIFIOTA_WORKER_POOL_MAX_WORKERS 4
+#endif
+
+#ifndef WIFIOTA_WORKER_QUEUE_SIZE
+#define WIFIOTA_WORKER_QUEUE_SIZE 16 // puissance de 2
+#endif
+
+#ifndef WIFIOTA_WORKER_JOB_SIZE
+#define WIFIOTA_WORKER_JOB_SIZE (4 * sizeof(void *))
+#endif
+
+class WorkerPool
+{
+public:
+    static const size_t MAX_WORKERS = WIFIOTA_WORKER_POOL_MAX_WORKERS;
+    static const BaseType_t ANY_CORE = tskNO_AFFINITY;
+
+    typedef InplaceFunction<void(), WIFIOTA_WORKER_JOB_SIZE> Job;
+
+private:
+    struct Worker
+    {
+        SpscRing<Job, WIFIOTA_WORKER_QUEUE_SIZE> queue;
+        TaskHandle_t task = nullptr;
+        BaseType_t core = ANY_CORE;
+        UBaseType_t priority = 1;
+
+        // écrits par le producteur
+        uint32_t submitted = 0;
+        uint32_t maxDepth = 0;
+
+        // écrits par le worker
+        std::atomic<uint32_t> executed{0};
+        uint64_t busyUs = 0;
+        uint32_t maxJobUs = 0;
+    };
+
+    Worker workers[MAX_WORKERS];
+    size_t count = 0;
+    uint32_t rejected = 0;
+    uint32_t inlined = 0;
+
+    static void workerTask(void *arg)
+    {
+        Worker *w = (Worker *)arg;
+        Job job;
+        for (;;)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            while (w->queue.pop(job))
+            {
+                uint32_t start = micros();
+                job();
+                job = nullptr; // libère la capture avant d'attendre
+                uint32_t duration = micros() - start;
+                w->busyUs += duration;
+                if (duration > w->maxJobUs)
+                    w->maxJobUs = duration;
+                w->executed.fetch_add(1, std::memory_order_release);
+            }
+        }
+    }
+
+    bool accepts(const Worker &w, BaseType_t core, UBaseType_t minPriority) const
+    {
+        return (core == ANY_CORE || w.core == ANY_CORE || w.core == core) && w.priority >= minPriority;
+    }
+
+    // Worker compatible le moins chargé, sinon le moins chargé de tous ; -1 si tout est plein
+    int pick(BaseType_t core, UBaseType_t minPriority) const
+    {
+        int best = -1;
+        int fallback = -1;
+        for (size_t i = 0; i < count; i++)
+        {
+            const Worker &w = workers[i];
+            if (w.queue.isFull())
+                continue;
+            if (fallback < 0 || w.queue.size() < workers[fallback].queue.size())
+                fallback = i;
+            if (accepts(w, core, minPriority) && (best < 0 || w.queue.size() < workers[best].queue.size()))
+                best = i;
+        }
+        return best >= 0 ? best : fallback;
+    }
+
+public:
+    WorkerPool() {}
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * Démarre un worker.
+     *
+     * @param core Cœur de la tâche (ANY_CORE : au choix de FreeRTOS).
+     * @param priority Priorité FreeRTOS (1 = celle de loop()).
+     * @param stackSize Pile de la tâche, à augmenter pour du JSON ou du réseau.
+     */
+    bool addWorker(BaseType_t core = ANY_CORE, UBaseType_t priority = 1, uint32_t stackSize = 4096)
+    {
+        if (count >= MAX_WORKERS)
+            return false;
+        Worker &w = workers[count];
+        w.core = core;
+        w.priority = priority;
+        char name[12];
+        snprintf(name, sizeof(name), "worker%u", (unsigned)count); // copié par FreeRTOS
+        if (xTaskCreatePinnedToCore(workerTask, name, stackSize, &w, priority, &w.task, core) != pdPASS)
+        {
+            w.task = nullptr;
+            return false;
+        }
+        count++;
+        return true;
+    }
+
+    /**
+     * Démarre workerCount workers répartis alternativement sur les cœurs
+     * (tous sur le cœur 0 d'une puce monocœur).
+     */
+    bool begin(size_t workerCount = 2, UBaseType_t priority = 1, uint32_t stackSize = 4096)
+    {
+        for (size_t i = 0; i < workerCount; i++)
+            if (!addWorker((BaseType_t)(i % portNUM_PROCESSORS), priority, stackSize))
+                return false;
+        return true;
+    }
+
+    /**
+     * Confie un travail au pool.
+     *
+     * @param core Cœur souhaité (ANY_CORE par défaut).
+     * @param minPriority Priorité minimale souhaitée du worker.
+     * @return false si toutes les files sont pleines (travail non exécuté).
+     */
+    bool submit(Job job, BaseType_t core = ANY_CORE, UBaseType_t minPriority = 0)
+    {
+        if (!job)
+            return false;
+        if (count == 0)
+        {
+            inlined++;
+            job();
+            return true;
+        }
+        int i = pick(core, minPriority);
+        if (i < 0)
+        {
+            rejected++;
+            return false;
+        }
+        Worker &w = workers[i];
+        w.queue.push(std::move(job));
+        w.submitted++;
+        size_t depth = w.queue.size();
+        if (depth > w.maxDepth)
+            w.maxDepth = depth;
+        xTaskNotifyGive(w.task);
+        return true;
+    }
+
+    /**
+     * Fonction de TaskScheduler qui confie fn au pool à chaque échéance :
+     *     scheduler.every(100, pool.offload(encodePayload), "encode");
+     * Si fn dure plus que l'intervalle, les exécutions s'empilent dans la
+     * file jusqu'à ce qu'elle soit pleine (compté dans getRejected()).
+     */
+    TaskScheduler::Callback offload(void (*fn)(), BaseType_t core = ANY_CORE)
+    {
+        return [this, fn, core]() { submit(fn, core); };
+    }
+
+    // Travaux confiés et pas encore terminés
+    size_t pending() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++)
+            n += workers[i].submitted - workers[i].executed.load(std::memory_order_acquire);
+        return n;
+    }
+
+    /**
+     * Attend la fin de tous les travaux confiés ; leurs résultats sont
+     * ensuite visibles par l'appelant.
+     *
+     * @return false si timeoutMs s'est écoulé avant.
+     */
+    bool waitIdle(uint32_t timeoutMs)
+    {
+        unsigned long start = millis();
+        while (pending() > 0)
+        {
+            if (millis() - start >= timeoutMs)
+                return false;
+            vTaskDelay(1);
+        }
+        return true;
+    }
+
+    size_t workerCount() const { return count; }
+    uint32_t getRejected() const { return rejected; }
+    uint32_t getExecuted(size_t worker) const
+    {
+        return worker < count ? workers[worker].executed.load(std::memory_order_relaxed) : 0;
+    }
+
+    // {"rejected":0,"inline":0,"workers":[{"core":0,"priority":1,"executed":42,"pending":0,"maxDepth":3,"busyMs":12,"maxJobUs":950},...]}
+    String statsJSON() const
+    {
+        String json = "{\"rejected\":" + String(rejected) + ",\"inline\":" + String(inlined) + ",\"workers\":[";
+        for (size_t i = 0; i < count; i++)
+        {
+            const Worker &w = workers[i];
+            uint32_t executed = w.executed.load(std::memory_order_acquire);
+            if (i > 0)
+                json += ",";
+            json += "{\"core\":" + (w.core == ANY_CORE ? String("null") : String((int)w.core)) +
+                    ",\"priority\":" + String((unsigned)w.priority) + ",\"executed\":" + String(executed) +
+                    ",\"pending\":" + String(w.submitted - executed) + ",\"maxDepth\":" + String(w.maxDepth) +
+                    ",\"busyMs\":" + String((uint32_t)(w.busyUs / 1000)) + ",\"maxJobUs\":" + String(w.maxJobUs) + "}";
+        }
+        json += "]}";
+        return json;
+    }
+};
+
+#endif
@@ -4,7 +4,10 @@
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <PubSubClient.h>
+#include <ArduinoJson.h>
 #include "utilities.h"
+#include "PullOTA.h"
+#include "CommandEngine.h"
 
 
 
@@ -12,6 +15,142 @@ extern bool wifi_connected;
 extern Logger logger;
 extern void mqttCallback(char* topic, byte* payload, unsigned int length);
 
+// taille d'un lot de logs envoyé au broker
+#ifndef WIFIOTA_MQTT_LOG_BATCH_SIZE
+#define WIFIOTA_MQTT_LOG_BATCH_SIZE 1024
+#endif
+
+// Sortie de logs vers MQTT : write() est appelé par LogDispatcher (parfois
+// depuis sa tâche) et ne fait que copier la ligne dans le lot courant. Le lot
+// est publié depuis MQTTController::loop(), seul contexte qui utilise le
+// client MQTT, au plus une fois par minGapMs.
+class MQTTLogSink : public LogSink {
+  public:
+    static const size_t BATCH_SIZE = WIFIOTA_MQTT_LOG_BATCH_SIZE;
+
+  private:
+    char* batch = nullptr;      // rempli par write()
+    char* outgoing = nullptr;   // lot en cours de publication
+    size_t pending = 0;         // taille du lot sorti et pas encore publié
+    std::atomic<bool> enabled{false};
+    size_t batchLen = 0;
+    unsigned long batchStart = 0;
+    bool urgent = false;
+    uint32_t dropped = 0;
+    uint32_t droppedReported = 0;
+    uint32_t batches = 0;
+    uint32_t failures = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    uint8_t minLevel = Logger::WARNING;
+    unsigned long maxDelayMs = 10000;  // âge max d'un lot avant publication
+    unsigned long minGapMs = 2000;     // écart min entre deux publications
+    unsigned long lastPublish = 0;
+
+  public:
+    ~MQTTLogSink() {
+      free(batch);
+      free(outgoing);
+    }
+
+    // alloue les tampons (appelé par MQTTController::enableRemoteLogs)
+    bool begin() {
+      if (batch == nullptr) batch = (char*)malloc(BATCH_SIZE);
+      if (outgoing == nullptr) outgoing = (char*)malloc(BATCH_SIZE + 1);
+      return batch != nullptr && outgoing != nullptr;
+    }
+
+    // niveau minimum envoyé au broker
+    void setLevel(Logger::Level level) { minLevel = level; }
+
+    // la sortie reste enregistrée auprès de LogDispatcher ; désactivée, elle ignore les lignes
+    void setEnabled(bool active) { enabled.store(active); }
+    bool isEnabled() const { return enabled.load(); }
+
+    // un lot part quand il a maxDelay ms, est aux 3/4 plein ou contient une erreur,
+    // mais jamais moins de minGap ms après le précédent
+    void setInterval(unsigned long maxDelay, unsigned long minGap) {
+      maxDelayMs = maxDelay;
+      minGapMs = minGap;
+    }
+
+    void write(const LogRecord& record) override {
+      if (!enabled.load() || record.level < minLevel || batch == nullptr) return;
+
+      char line[WIFIOTA_LOG_BUFFER_SIZE + 24];
+      size_t len;
+      if (record.format == LogRecord::BINARY) {
+        // trame copiée telle quelle, décodée par tools/wlog_decode.py
+        len = record.length;
+        memcpy(line, record.text, len);
+      } else {
+        int n = snprintf(line, sizeof(line), "%lu %s%.*s\n", (unsigned long)record.timestamp,
+                         logLevelPrefix(record.level), (int)record.length, record.text);
+        if (n <= 0) return;
+        len = min((size_t)n, sizeof(line) - 1);
+      }
+
+      portENTER_CRITICAL(&lock);
+      if (batchLen + len <= BATCH_SIZE) {
+        if (batchLen == 0) batchStart = record.timestamp;
+        memcpy(batch + batchLen, line, len);
+        batchLen += len;
+        if (record.level >= Logger::ERROR) urgent = true;
+      } else {
+        dropped++;
+      }
+      portEXIT_CRITICAL(&lock);
+    }
+
+    // retire le lot s'il doit être publié maintenant, retourne sa taille (0 sinon) ;
+    // un lot dont la publication a échoué est repris tel quel
+    size_t take(unsigned long now) {
+      if (batch == nullptr || now - lastPublish < minGapMs) return 0;
+      if (pending > 0) return pending;
+
+      size_t n = 0;
+      uint32_t lost = 0;
+      portENTER_CRITICAL(&lock);
+      if (batchLen > 0 && (urgent || batchLen * 4 >= BATCH_SIZE * 3 || now - batchStart >= maxDelayMs)) {
+        memcpy(outgoing, batch, batchLen);
+        n = batchLen;
+        batchLen = 0;
+        urgent = false;
+        lost = dropped - droppedReported;
+        droppedReported = dropped;
+      }
+      portEXIT_CRITICAL(&lock);
+
+      // les lignes perdues sont signalées en fin de lot quand la place le permet
+      if (lost > 0 && n < BATCH_SIZE) {
+        int extra = snprintf(outgoing + n, BATCH_SIZE + 1 - n, "%lu %s%u lignes de log non envoyées\n",
+                             now, logLevelPrefix(Logger::WARNING), (unsigned)lost);
+        if (extra > 0) n = min(n + (size_t)extra, (size_t)BATCH_SIZE);
+      }
+      if (n > 0) outgoing[n] = '\0';
+      pending = n;
+      return n;
+    }
+
+    const uint8_t* payload() const { return (const uint8_t*)outgoing; }
+
+    void markPublished(unsigned long now) {
+      lastPublish = now;
+      pending = 0;
+      batches++;
+    }
+
+    // lot gardé pour la tentative suivante, au plus tôt dans minGap ms
+    void markFailed(unsigned long now) {
+      lastPublish = now;
+      failures++;
+    }
+
+    uint32_t getDropped() const { return dropped; }
+    uint32_t getBatches() const { return batches; }
+    uint32_t getFailures() const { return failures; }
+};
+
 class MQTTController {
   private:
     const char* mqtt_server;
@@ -32,29 +171,75 @@ class MQTTController {
 
     String clientId = "ESPClient";
 
+    // mise à jour firmware déclenchée par le broker
+    PullOTA ota;
+    unsigned long lastOtaReport = 0;
+    size_t lastOtaReportBytes = 0;
+    unsigned long rebootAt = 0;
+
+    // commandes texte du topic de commande, réponses sur <publishTopic>/cmd/reply
+    CommandEngine* commands = nullptr;
+    String replyTopic = "";
+
+    // logs envoyés au broker
+    MQTTLogSink logSink;
+    String logTopic = "";
+    bool remoteLogs = false;
+    bool logSinkRegistered = false;
+
   public:
     bool isSecure = false;
     MQTTController(const char* mqtt_server, int mqtt_port, const char* mqtt_user, const char* mqtt_password)
       : mqtt_server(mqtt_server), mqtt_port(mqtt_port), mqtt_user(mqtt_user), mqtt_password(mqtt_password), client(secureClient) {}
 
+    // la sortie de logs appartient au contrôleur : LogDispatcher ne doit pas la garder
+    ~MQTTController() {
+      if (logSinkRegistered) LogDispatcher::instance().removeSink(&logSink);
+    }
+
     // begin: prépare le client, n'oublie pas d'appeler setPublishTopic/setSubscribeTopic avant si tu veux
     void begin() {
       client.setServer(mqtt_server, mqtt_port);
-      client.setCallback(mqttCallback);
+      // une commande OTA (URL + sha256) ou le résumé OTAMetrics (~470 octets plus
+      // le topic) ne tiennent pas dans les 256 octets par défaut
+      if (client.getBufferSize() < 1024) client.setBufferSize(1024);
+      client.setCallback([this](char* topic, byte* payload, unsigned int length) {
+        handleMessage(topic, payload, length);
+      });
+      ota.onProgress([this](size_t done, size_t total) { reportOtaProgress(done, total); });
+      ota.onEnd([this](bool success, const String& error) {
+        // résumé publié avant le statut final, la carte redémarre peu après ;
+        // aucun si la connexion a échoué (rien n'a été mesuré)
+        if (ota.getDone() > 0) {
+          WLOG_INFO(logger, "OTA " + ota.getMetrics().toString());
+          publishOtaMetrics(ota.getMetrics());
+        }
+        reportOtaEnd(success, error);
+      });
       // si le Wi-Fi est déjà connecté, tenter une première connexion
       if (wifi_connected) {
         connectMQTT();
       } else {
-        logger.error("MQTT not started (Wi-Fi non connecté). Appelle begin() après connexion ou laissez la loop gérer la reconnexion.");
+        WLOG_ERROR(logger, "MQTT not started (Wi-Fi non connecté). Appelle begin() après connexion ou laissez la loop gérer la reconnexion.");
       }
     }
 
     // loop: doit être appelé dans loop()
     void loop() {
+      if (rebootAt != 0 && (long)(millis() - rebootAt) >= 0) {
+        WLOG_INFO(logger, "Redémarrage après mise à jour OTA");
+        LogDispatcher::instance().flush();
+        ESP.restart();
+      }
+
       if (!wifi_connected) return;
 
+      // le téléchargement avance d'un bloc par appel, même si le broker est injoignable
+      ota.loop();
+
       if (client.connected()) {
         client.loop();
+        if (remoteLogs) publishLogs();
       } else {
         unsigned long now = millis();
         if (now - lastReconnectAttempt > reconnectInterval) {
@@ -70,14 +255,19 @@ class MQTTController {
 
     // publish sur le topic courant
     bool publish(const char* topic, const String& message) {
+      // la télémétrie est suspendue pendant l'écriture du firmware
+      if (ota.isRunning()) {
+        WLOG_DEBUG(logger, "Mise à jour OTA en cours. Publish ignoré.");
+        return false;
+      }
       if (wifi_connected && client.connected()) {
         bool ok = client.publish(topic, message.c_str());
-        if (ok) logger.info("MQTT published [" + String(topic) + "] : " + message);
+        if (ok) WLOG_INFOF(logger, "MQTT published [%s] : %s", topic, message.c_str());
 
-        else logger.error("MQTT publish failed [" + String(topic) + "]");
+        else WLOG_ERRORF(logger, "MQTT publish failed [%s]", topic);
         return ok;
       } else {
-        logger.error("MQTT non connecté. Publish ignoré.");
+        WLOG_ERROR(logger, "MQTT non connecté. Publish ignoré.");
         return false;
       }
     }
@@ -90,7 +280,7 @@ class MQTTController {
     // setters dynamiques pour topics
     void setPublishTopic(const String& topic) {
       publishTopic = topic;
-      logger.info(" Publish topic set to: " + publishTopic);
+      WLOG_INFOF(logger, " Publish topic set to: %s", publishTopic.c_str());
     }
 
     // setSubscribeTopic : applique la subscription si déjà connecté (unsubscribe ancien si besoin)
@@ -98,48 +288,222 @@ class MQTTController {
       if (topic.length() == 0) return;
       if (subscribeTopic == topic) return; // pas de changement
 
-      logger.info(" Subscribe topic requested: " + topic);
+      WLOG_INFOF(logger, " Subscribe topic requested: %s", topic.c_str());
       subscribeTopic = topic;
 
       // Si connecté, unsubscribe ancien et subscribe nouveau
       if (client.connected()) {
         if (currentSubscribed.length() > 0 && currentSubscribed != subscribeTopic) {
           if (client.unsubscribe(currentSubscribed.c_str())) {
-            logger.info(" Unsubscribed from: " + currentSubscribed);
+            WLOG_INFOF(logger, " Unsubscribed from: %s", currentSubscribed.c_str());
           } else {
-            logger.error(" Failed to unsubscribe from: " + currentSubscribed);
+            WLOG_ERRORF(logger, " Failed to unsubscribe from: %s", currentSubscribed.c_str());
           }
         }
         if (client.subscribe(subscribeTopic.c_str())) {
           currentSubscribed = subscribeTopic;
-          logger.info("Subscribed to: " + subscribeTopic);
+          WLOG_INFOF(logger, "Subscribed to: %s", subscribeTopic.c_str());
         } else {
-          logger.error(" Failed to subscribe to: " + subscribeTopic);
+          WLOG_ERRORF(logger, " Failed to subscribe to: %s", subscribeTopic.c_str());
         }
       } else {
-        logger.warning("Will subscribe to " + subscribeTopic + " once connected.");
+        WLOG_WARNINGF(logger, "Will subscribe to %s once connected.", subscribeTopic.c_str());
       }
     }
 
     // option: changer clientId (avant connect)
     void setClientId(const String& id) {
       if (id.length() > 0) clientId = id;
-      logger.info("MQTT clientId: " + clientId);
+      WLOG_INFOF(logger, "MQTT clientId: %s", clientId.c_str());
     }
 
     // geteurs
     String getPublishTopic() const { return publishTopic; }
     String getSubscribeTopic() const { return subscribeTopic; }
+    bool isConnected() { return wifi_connected && client.connected(); }
+
+    // les messages texte (pas JSON) du topic de commande passent par ce moteur ;
+    // les commandes inconnues vont toujours à mqttCallback
+    void setCommandEngine(CommandEngine* engine) { commands = engine; }
+
+    // topic des réponses aux commandes (<publishTopic>/cmd/reply par défaut) ;
+    // distinct du topic de commande, sinon chaque réponse reviendrait comme commande
+    bool setCommandReplyTopic(const String& topic) {
+      if (topic.length() > 0 && topic == subscribeTopic) {
+        WLOG_ERRORF(logger, "Topic de réponse identique au topic de commande: %s", topic.c_str());
+        return false;
+      }
+      replyTopic = topic;
+      return true;
+    }
+
+    String getCommandReplyTopic() const {
+      return replyTopic.length() > 0 ? replyTopic : publishTopic + "/cmd/reply";
+    }
 
   
     void setSecure(const char* caCert){
       secureClient.setCACert(caCert);
-      logger.info("CA cert set");
+      WLOG_INFO(logger, "CA cert set");
+    }
+
+    // certificat racine du serveur de firmware (HTTPS)
+    void setOtaCACert(const char* caCert) {
+      ota.setCACert(caCert);
+    }
+
+    // HTTPS sans certificat : serveur non authentifié, à activer explicitement
+    void setOtaInsecure(bool allow = true) {
+      ota.setInsecure(allow);
+    }
+
+    // lance une mise à jour depuis une URL (aussi déclenchée par la commande {"cmd":"ota",...}) ;
+    // sha256 : empreinte du fichier, 64 caractères hexadécimaux, obligatoire
+    bool startOta(const String& url, const String& sha256) {
+      WLOG_INFOF(logger, "OTA demandée: %s", url.c_str());
+      lastOtaReport = 0;
+      lastOtaReportBytes = 0;
+      if (!ota.start(url, sha256)) {
+        reportOtaEnd(false, ota.getError());
+        return false;
+      }
+      // connexion au serveur au prochain loop() : le callback MQTT ne bloque pas
+      publishOtaStatus("{\"state\":\"connecting\"}");
+      return true;
+    }
+
+    bool isUpdating() const { return ota.isRunning(); }
+
+    // envoie les logs de niveau >= minLevel par lots sur topic (<publishTopic>/logs par défaut)
+    bool enableRemoteLogs(Logger::Level minLevel = Logger::WARNING, const String& topic = "") {
+      if (!logSink.begin()) return false;
+      logSink.setLevel(minLevel);
+      logTopic = topic;
+      // le lot entier doit tenir dans le tampon du client avec le topic
+      if (client.getBufferSize() < MQTTLogSink::BATCH_SIZE + 128) client.setBufferSize(MQTTLogSink::BATCH_SIZE + 128);
+      // enregistrée une seule fois : removeSink() n'est pas sûr une fois LogDispatcher démarré
+      if (!logSinkRegistered) logSinkRegistered = LogDispatcher::instance().addSink(&logSink);
+      logSink.setEnabled(logSinkRegistered);
+      remoteLogs = logSinkRegistered;
+      return remoteLogs;
+    }
+
+    void disableRemoteLogs() {
+      logSink.setEnabled(false);
+      remoteLogs = false;
+    }
+
+    MQTTLogSink& getLogSink() { return logSink; }
+
+    // mesures de la dernière mise à jour (débit, latences flash, durée des phases)
+    const OTAMetrics& getOtaMetrics() const { return ota.getMetrics(); }
+
+    // publie un résumé de mesures OTA sur <publishTopic>/ota/metrics (aussi pour les mises à jour web)
+    bool publishOtaMetrics(const OTAMetrics& metrics) {
+      if (!client.connected() || publishTopic.length() == 0) return false;
+      String topic = otaTopic() + "/metrics";
+      String json = metrics.toJson();
+      // en-tête MQTT (5 octets au plus) + longueur du topic (2) + topic + charge utile
+      size_t needed = 7 + topic.length() + json.length();
+      if (client.getBufferSize() < needed) client.setBufferSize(needed);
+      bool ok = client.publish(topic.c_str(), json.c_str());
+      if (!ok) WLOG_WARNINGF(logger, "Publication des mesures OTA échouée (%u octets)", (unsigned)needed);
+      return ok;
     }
 
 
   
   private:
+    // les messages du topic de commande sont d'abord examinés pour les commandes internes
+    void handleMessage(char* topic, byte* payload, unsigned int length) {
+      // nos propres réponses (abonnement avec joker) : ni commande ni message applicatif
+      if (commands && getCommandReplyTopic() == topic) return;
+      if (length > 0 && payload[0] == '{' && handleOtaCommand(payload, length)) return;
+      if (commands && length > 0 && payload[0] != '{' && handleTextCommand(payload, length)) return;
+      mqttCallback(topic, payload, length);
+    }
+
+    bool handleTextCommand(const byte* payload, unsigned int length) {
+      CommandReply reply;
+      CommandEngine::Result result = commands->execute((const char*)payload, length, reply);
+      // vide, trop long ou inconnu : pas une commande, laissé à mqttCallback
+      if (result != CommandEngine::OK && result != CommandEngine::BAD_ARGS) return false;
+      if (reply.length() > 0 && (replyTopic.length() > 0 || publishTopic.length() > 0)) {
+        client.publish(getCommandReplyTopic().c_str(), reply.c_str());
+      }
+      return true;
+    }
+
+    bool handleOtaCommand(const byte* payload, unsigned int length) {
+      JsonDocument doc;
+      if (deserializeJson(doc, payload, length)) return false;
+      const char* cmd = doc["cmd"] | "";
+      if (strcmp(cmd, "ota") != 0) return false;
+
+      const char* url = doc["url"] | "";
+      const char* sha256 = doc["sha256"] | "";
+      if (strlen(url) == 0) {
+        reportOtaEnd(false, "URL manquante");
+        return true;
+      }
+      startOta(url, sha256);
+      return true;
+    }
+
+    String otaTopic() const { return publishTopic + "/ota"; }
+
+    // publication directe : un log émis ici reviendrait dans le lot suivant
+    void publishLogs() {
+      if (ota.isRunning()) return;  // l'écriture du firmware passe avant
+      if (logTopic.length() == 0 && publishTopic.length() == 0) return;
+      unsigned long now = millis();
+      size_t n = logSink.take(now);
+      if (n == 0) return;
+      String topic = logTopic.length() > 0 ? logTopic : publishTopic + "/logs";
+      if (client.publish(topic.c_str(), logSink.payload(), n)) {
+        logSink.markPublished(now);
+      } else {
+        logSink.markFailed(now);
+      }
+    }
+
+    // publication directe : contourne la suspension de la télémétrie
+    void publishOtaStatus(const String& json) {
+      if (client.connected() && publishTopic.length() > 0) {
+        client.publish(otaTopic().c_str(), json.c_str());
+      }
+    }
+
+    // au plus une publication toutes les 2 s ou tous les 5 %
+    void reportOtaProgress(size_t done, size_t total) {
+      unsigned long now = millis();
+      bool step = total > 0 && (done - lastOtaReportBytes) * 20 >= total;
+      if (!step && now - lastOtaReport < 2000) return;
+      lastOtaReport = now;
+      lastOtaReportBytes = done;
+      String json = "{\"state\":\"downloading\",\"bytes\":" + String(done);
+      if (total > 0) json += ",\"total\":" + String(total) + ",\"progress\":" + String(done * 100 / total);
+      json += "}";
+      publishOtaStatus(json);
+    }
+
+    void reportOtaEnd(bool success, const String& error) {
+      if (success) {
+        WLOG_INFOF(logger, "OTA réussie (%u octets), redémarrage", (unsigned)ota.getDone());
+        publishOtaStatus("{\"state\":\"success\",\"bytes\":" + String(ota.getDone()) + "}");
+        rebootAt = millis() + 1000;
+      } else {
+        WLOG_ERRORF(logger, "OTA échouée: %s", error.c_str());
+        // le message peut contenir des guillemets (URL, réponse du serveur)
+        JsonDocument doc;
+        doc["state"] = "failed";
+        doc["error"] = error;
+        String json;
+        serializeJson(doc, json);
+        publishOtaStatus(json);
+      }
+    }
+
     bool connectMQTT() {
       if (!wifi_connected) return false;
       
@@ -147,14 +511,14 @@ class MQTTController {
       
       ///logger.info("Connexion au broker MQTT... ");
       if (client.connect(clientId.c_str(), mqtt_user, mqtt_password)) {
-        logger.info("Connecté !");
+        WLOG_INFO(logger, "Connecté !");
         // subscribe au topic configuré
         if (subscribeTopic.length() > 0) {
           if (client.subscribe(subscribeTopic.c_str())) {
             currentSubscribed = subscribeTopic;
-            logger.info("Abonné au topic : " + subscribeTopic);
+            WLOG_INFOF(logger, "Abonné au topic : %s", subscribeTopic.c_str());
           } else {
-            logger.error(" Échec abonnement au topic : " + subscribeTopic);
+            WLOG_ERRORF(logger, " Échec abonnement au topic : %s", subscribeTopic.c_str());
           }
         }
 
@@ -164,7 +528,7 @@ class MQTTController {
         }
         return true;
       } else {
-        logger.critical("Échec connexion MQTT, code="+client.state());
+        WLOG_CRITICALF(logger, "Échec connexion MQTT, code=%d", client.state());
         return false;
       }
     }
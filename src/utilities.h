@@ -4,57 +4,17 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "WiFiManagerOTA.h"
+#include "BinaryLog.h"
+#include "CircularBuffer.h"
+#include "SpscRing.h"
+#include "WindowedStatistics.h"
+#include "DspKernels.h"
+#include "FilterPipeline.h"
+#include "TaskScheduler.h"
+#include "PatternPlayer.h"
+#include <atomic>
 #include <cfloat>
-// ═══════════════════════════════════════════════════════════
-// GESTIONNAIRE DE BUFFER CIRCULAIRE pour logs
-// ═══════════════════════════════════════════════════════════
-
-template <typename T, size_t SIZE>
-class CircularBuffer
-{
-private:
-    T buffer[SIZE];
-    size_t head = 0;
-    size_t tail = 0;
-    size_t count = 0;
-
-public:
-    bool push(const T &item)
-    {
-        if (count >= SIZE)
-        {
-            tail = (tail + 1) % SIZE;
-        }
-        else
-        {
-            count++;
-        }
-        buffer[head] = item;
-        head = (head + 1) % SIZE;
-        return true;
-    }
-
-    bool pop(T &item)
-    {
-        if (count == 0)
-            return false;
-        item = buffer[tail];
-        tail = (tail + 1) % SIZE;
-        count--;
-        return true;
-    }
-
-    size_t size() const { return count; }
-    bool isEmpty() const { return count == 0; }
-    bool isFull() const { return count >= SIZE; }
-    void clear() { head = tail = count = 0; }
-
-    T &operator[](size_t index)
-    {
-        return buffer[(tail + index) % SIZE];
-    }
-};
-
+#include <new>
 // ═══════════════════════════════════════════════════════════
 // GESTIONNAIRE DE STATISTIQUES
 // ═══════════════════════════════════════════════════════════
@@ -62,12 +22,31 @@ public:
 class Statistics
 {
 private:
+    // Moyenne et somme des carrés des écarts mises à jour à chaque valeur
+    // (Welford) : pas de soustraction de deux grandes sommes, l'écart-type
+    // reste exact sur des millions de valeurs.
     float min_val = FLT_MAX;
     float max_val = -FLT_MAX;
-    float sum = 0;
-    float sumSquared = 0;
+    double mean = 0;
+    double m2 = 0;
     uint32_t count = 0;
 
+    // Combine un résumé partiel (méthode de Chan)
+    void mergeMoments(uint32_t n, double otherMean, double otherM2, float otherMin, float otherMax)
+    {
+        if (n == 0)
+            return;
+        double total = (double)count + n;
+        double delta = otherMean - mean;
+        mean += delta * n / total;
+        m2 += otherM2 + delta * delta * ((double)count * n / total);
+        count += n;
+        if (otherMin < min_val)
+            min_val = otherMin;
+        if (otherMax > max_val)
+            max_val = otherMax;
+    }
+
 public:
     void addValue(float value)
     {
@@ -75,31 +54,55 @@ public:
             min_val = value;
         if (value > max_val)
             max_val = value;
-        sum += value;
-        sumSquared += value * value;
         count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
     }
 
-    float getMin() const { return count > 0 ? min_val : 0; }
-    float getMax() const { return count > 0 ? max_val : 0; }
-    float getAverage() const { return count > 0 ? sum / count : 0; }
+    /**
+     * Ajoute n valeurs d'un coup (tampon DMA de l'ADC par exemple). Chaque
+     * bloc est résumé en flottant simple par Dsp::moments(), puis combiné :
+     * quelques opérations en double par bloc au lieu d'une par valeur.
+     */
+    void addValues(const float *values, size_t n)
+    {
+        while (n > 0)
+        {
+            size_t block = n < Dsp::MOMENTS_BLOCK ? n : Dsp::MOMENTS_BLOCK;
+            Dsp::Moments m;
+            Dsp::moments(values, block, m);
+            mergeMoments(m.count, m.mean, m.m2, m.min, m.max);
+            values += block;
+            n -= block;
+        }
+    }
 
-    float getStdDev() const
+    /**
+     * Ajoute les valeurs résumées par other, comme si elles avaient été
+     * passées à addValue() (statistiques par tâche ou par cœur par exemple).
+     */
+    void merge(const Statistics &other)
     {
-        if (count < 2)
-            return 0;
-        float avg = getAverage();
-        return sqrt((sumSquared / count) - (avg * avg));
+        mergeMoments(other.count, other.mean, other.m2, other.min_val, other.max_val);
     }
 
+    float getMin() const { return count > 0 ? min_val : 0; }
+    float getMax() const { return count > 0 ? max_val : 0; }
+    float getAverage() const { return count > 0 ? (float)mean : 0; }
+
+    // Variance de la population
+    float getVariance() const { return count > 1 ? (float)(m2 / count) : 0; }
+    float getStdDev() const { return sqrt(getVariance()); }
+
     uint32_t getCount() const { return count; }
 
     void reset()
     {
         min_val = FLT_MAX;
         max_val = -FLT_MAX;
-        sum = 0;
-        sumSquared = 0;
+        mean = 0;
+        m2 = 0;
         count = 0;
     }
 
@@ -116,6 +119,145 @@ public:
     }
 };
 
+// ═══════════════════════════════════════════════════════════
+// PERCENTILES EN FLUX (algorithme P²)
+// ═══════════════════════════════════════════════════════════
+//
+// Estime un quantile sans conserver les valeurs : cinq marqueurs (minimum,
+// p/2, p, (1+p)/2, maximum) sont déplacés à chaque valeur et leur hauteur
+// corrigée par interpolation parabolique (Jain & Chlamtac, 1985). Mémoire
+// constante, précision de l'ordre du pour cent sur des distributions
+// régulières ; les estimations ne peuvent pas être fusionnées.
+
+class P2Quantile
+{
+private:
+    float p;
+    float q[5];    // hauteurs des marqueurs
+    int32_t n[5];  // positions (1..count)
+    uint32_t count = 0;
+
+    // Position idéale du marqueur i (1..3) après count valeurs
+    double desired(uint8_t i) const
+    {
+        double fraction = i == 1 ? p / 2 : (i == 2 ? p : (1 + p) / 2);
+        return 1 + (count - 1) * fraction;
+    }
+
+    float parabolic(uint8_t i, int d) const
+    {
+        return q[i] + (float)d / (n[i + 1] - n[i - 1]) *
+                          ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                           (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    }
+
+public:
+    explicit P2Quantile(float quantile = 0.5f) : p(quantile) {}
+
+    void addValue(float x)
+    {
+        if (count < 5)
+        {
+            // les 5 premières valeurs initialisent les marqueurs, triées
+            uint8_t i = count++;
+            while (i > 0 && q[i - 1] > x)
+            {
+                q[i] = q[i - 1];
+                i--;
+            }
+            q[i] = x;
+            if (count == 5)
+                for (uint8_t k = 0; k < 5; k++)
+                    n[k] = k + 1;
+            return;
+        }
+
+        uint8_t k;
+        if (x < q[0])
+        {
+            q[0] = x;
+            k = 0;
+        }
+        else if (x >= q[4])
+        {
+            q[4] = x;
+            k = 3;
+        }
+        else
+        {
+            k = 0;
+            while (x >= q[k + 1])
+                k++;
+        }
+        for (uint8_t i = k + 1; i < 5; i++)
+            n[i]++;
+        count++;
+
+        for (uint8_t i = 1; i < 4; i++)
+        {
+            double d = desired(i) - n[i];
+            if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1))
+            {
+                int s = d > 0 ? 1 : -1;
+                float h = parabolic(i, s);
+                if (q[i - 1] < h && h < q[i + 1])
+                    q[i] = h;
+                else
+                    q[i] += s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+                n[i] += s;
+            }
+        }
+    }
+
+    float getValue() const
+    {
+        if (count == 0)
+            return 0;
+        if (count < 5)
+            return q[(uint8_t)min((uint32_t)(p * count), count - 1)]; // rang exact
+        return q[2];
+    }
+
+    float getQuantile() const { return p; }
+    uint32_t getCount() const { return count; }
+    void reset() { count = 0; }
+};
+
+// p50, p95 et p99 d'une latence ou d'une mesure (~100 octets)
+class Percentiles
+{
+private:
+    P2Quantile p50{0.50f};
+    P2Quantile p95{0.95f};
+    P2Quantile p99{0.99f};
+
+public:
+    void addValue(float value)
+    {
+        p50.addValue(value);
+        p95.addValue(value);
+        p99.addValue(value);
+    }
+
+    float getP50() const { return p50.getValue(); }
+    float getP95() const { return p95.getValue(); }
+    float getP99() const { return p99.getValue(); }
+    uint32_t getCount() const { return p50.getCount(); }
+
+    void reset()
+    {
+        p50.reset();
+        p95.reset();
+        p99.reset();
+    }
+
+    String toJSON() const
+    {
+        return "{\"p50\":" + String(getP50(), 2) + ",\"p95\":" + String(getP95(), 2) + ",\"p99\":" +
+               String(getP99(), 2) + ",\"count\":" + String(getCount()) + "}";
+    }
+};
+
 // ═══════════════════════════════════════════════════════════
 // WATCHDOG LOGICIEL
 // ═══════════════════════════════════════════════════════════
@@ -173,70 +315,13 @@ public:
     {
         return millis() - lastFeed;
     }
-};
-
-// ═══════════════════════════════════════════════════════════
-// GESTIONNAIRE DE TÂCHES PÉRIODIQUES
-// ═══════════════════════════════════════════════════════════
-
-class TaskScheduler
-{
-private:
-    struct Task
-    {
-        String name;
-        unsigned long interval;
-        unsigned long lastRun;
-        void (*callback)();
-        bool enabled;
-    };
-
-    static const int MAX_TASKS = 10;
-    Task tasks[MAX_TASKS];
-    int taskCount = 0;
 
-public:
-    bool addTask(const String &name, unsigned long intervalMs, void (*callback)())
-    {
-        if (taskCount >= MAX_TASKS)
-        {
-            Serial.println("Trop de tâches");
-            return false;
-        }
-        tasks[taskCount] = {name, intervalMs, millis(), callback, true};
-        taskCount++;
-        Serial.println("Tâche ajoutée: " + name + " (" + String(intervalMs) + "ms)");
-        return true;
-    }
-
-    void run()
-    {
-        unsigned long now = millis();
-        for (int i = 0; i < taskCount; i++)
-        {
-            if (!tasks[i].enabled)
-                continue;
-            if (now - tasks[i].lastRun >= tasks[i].interval)
-            {
-                tasks[i].lastRun = now;
-                tasks[i].callback();
-            }
-        }
-    }
-
-    void setInterval(const String &name, unsigned long newInterval)
-    {
-        for (int i = 0; i < taskCount; i++)
-        {
-            if (tasks[i].name == name)
-            {
-                tasks[i].interval = newInterval;
-                Serial.println("Intervalle modifié: " + name + " -> " + String(newInterval) + "ms");
-                return;
-            }
-        }
-    }
+    const String &getName() const { return name; }
+    unsigned long getTimeout() const { return timeout; }
+    unsigned long getLastFeed() const { return lastFeed; }
+    bool isEnabled() const { return enabled; }
 };
+
 // ═══════════════════════════════════════════════════════════
 // GESTIONNAIRE DE CONFIGURATION JSON
 // ═══════════════════════════════════════════════════════════
@@ -335,7 +420,7 @@ private:
     bool initialized = false;
 
 public:
-    LowPassFilter(float smoothingFactor = 0.1) : alpha(smoothingFactor) {}
+    LowPassFilter(float smoothingFactor = 0.1f) : alpha(smoothingFactor) {}
 
     float filter(float newValue)
     {
@@ -346,13 +431,32 @@ public:
             return filteredValue;
         }
 
-        filteredValue = alpha * newValue + (1.0 - alpha) * filteredValue;
+        // tout en float : 1.0 - alpha passerait chaque valeur en double,
+        // émulé par logiciel sur ESP32
+        filteredValue += alpha * (newValue - filteredValue);
         return filteredValue;
     }
 
+    /**
+     * Filtre n valeurs (in et out peuvent être le même tableau) ; même
+     * résultat que filter() appelé sur chacune, bit pour bit (à l'arrondi
+     * près avec le biquad esp-dsp).
+     */
+    void filterBlock(const float *in, float *out, size_t n)
+    {
+        if (n == 0)
+            return;
+        if (!initialized)
+        {
+            filteredValue = in[0];
+            initialized = true;
+        }
+        filteredValue = Dsp::ema(in, out, n, alpha, filteredValue);
+    }
+
     float getValue() const { return filteredValue; }
     void reset() { initialized = false; }
-    void setSmoothingFactor(float factor) { alpha = constrain(factor, 0.0, 1.0); }
+    void setSmoothingFactor(float factor) { alpha = constrain(factor, 0.0f, 1.0f); }
 };
 
 // ═══════════════════════════════════════════════════════════
@@ -399,22 +503,10 @@ public:
 class LEDManager
 {
 private:
+    // Les patterns sont joués par PatternPlayer (esp_timer + LEDC) :
+    // update() n'a plus rien à faire et le rythme ne dépend plus de loop()
     int pin;
-    unsigned long lastToggle = 0;
-    bool state = false;
-
-    enum Pattern
-    {
-        OFF,
-        ON,
-        BLINK_SLOW,
-        BLINK_FAST,
-        PULSE,
-        HEARTBEAT
-    };
-
-    Pattern currentPattern = OFF;
-    unsigned long patternStartTime = 0;
+    PatternPlayer player;
 
 public:
     LEDManager(int ledPin) : pin(ledPin)
@@ -426,75 +518,33 @@ public:
     void setPattern(const String &pattern)
     {
         if (pattern == "off")
-            currentPattern = OFF;
+            player.stop();
         else if (pattern == "on")
-            currentPattern = ON;
+            player.play(Patterns::ON, false);
         else if (pattern == "blink_slow")
-            currentPattern = BLINK_SLOW;
+            player.play(Patterns::BLINK_SLOW);
         else if (pattern == "blink_fast")
-            currentPattern = BLINK_FAST;
+            player.play(Patterns::BLINK_FAST);
         else if (pattern == "pulse")
-            currentPattern = PULSE;
+            player.play(Patterns::PULSE);
         else if (pattern == "heartbeat")
-            currentPattern = HEARTBEAT;
-
-        patternStartTime = millis();
+            player.play(Patterns::HEARTBEAT);
+        else
+            return;
+        player.begin(pin); // LEDC attaché au premier pattern, pas dans le constructeur global
     }
 
-    void update()
+    // Pattern personnalisé (table en flash, valide tant qu'elle est jouée)
+    void setPattern(const PatternStep *steps, size_t count, bool repeat = true)
     {
-        unsigned long now = millis();
-
-        switch (currentPattern)
-        {
-        case OFF:
-            digitalWrite(pin, LOW);
-            break;
-
-        case ON:
-            digitalWrite(pin, HIGH);
-            break;
-
-        case BLINK_SLOW:
-            if (now - lastToggle > 1000)
-            {
-                state = !state;
-                digitalWrite(pin, state);
-                lastToggle = now;
-            }
-            break;
-
-        case BLINK_FAST:
-            if (now - lastToggle > 200)
-            {
-                state = !state;
-                digitalWrite(pin, state);
-                lastToggle = now;
-            }
-            break;
+        player.play(steps, count, repeat);
+        player.begin(pin);
+    }
 
-        case PULSE:
-        {
-            int brightness = (sin((now - patternStartTime) / 1000.0 * PI) + 1) * 127;
-            analogWrite(pin, brightness);
-            break;
-        }
+    // Conservé pour compatibilité
+    void update() {}
 
-        case HEARTBEAT:
-        {
-            unsigned long phase = (now - patternStartTime) % 2000;
-            if (phase < 100 || (phase > 200 && phase < 300))
-            {
-                digitalWrite(pin, HIGH);
-            }
-            else
-            {
-                digitalWrite(pin, LOW);
-            }
-            break;
-        }
-        }
-    }
+    PatternPlayer &getPlayer() { return player; }
 };
 
 // ═══════════════════════════════════════════════════════════
@@ -619,6 +669,383 @@ private:
 // ═══════════════════════════════════════════════════════════
 // SYSTÈME DE LOGS avec niveaux
 // ═══════════════════════════════════════════════════════════
+//
+// Le niveau est vérifié avant toute mise en forme : un message filtré ne
+// coûte qu'une comparaison. Les variantes printf (infof, ...) formatent
+// dans un tampon sur la pile, sans allocation. Les macros WLOG_* retirent
+// en plus les appels sous WIFIOTA_LOG_LEVEL à la compilation, arguments
+// compris (par exemple -DWIFIOTA_LOG_LEVEL=WIFIOTA_LOG_LEVEL_WARNING en
+// production). Les lignes sont ensuite confiées à LogDispatcher, qui les
+// transmet aux sorties (Serial par défaut).
+
+#define WIFIOTA_LOG_LEVEL_DEBUG 0
+#define WIFIOTA_LOG_LEVEL_INFO 1
+#define WIFIOTA_LOG_LEVEL_WARNING 2
+#define WIFIOTA_LOG_LEVEL_ERROR 3
+#define WIFIOTA_LOG_LEVEL_CRITICAL 4
+#define WIFIOTA_LOG_LEVEL_NONE 5
+
+#ifndef WIFIOTA_LOG_LEVEL
+#define WIFIOTA_LOG_LEVEL WIFIOTA_LOG_LEVEL_DEBUG
+#endif
+
+// Taille maximale d'une ligne formatée (tronquée au-delà)
+#ifndef WIFIOTA_LOG_BUFFER_SIZE
+#define WIFIOTA_LOG_BUFFER_SIZE 192
+#endif
+
+// Nombre de lignes en attente dans la file asynchrone
+#ifndef WIFIOTA_LOG_QUEUE_SIZE
+#define WIFIOTA_LOG_QUEUE_SIZE 32
+#endif
+
+inline const char *logLevelPrefix(uint8_t level)
+{
+    static const char *const prefixes[] = {"[DEBUG] ", "[INFO] ", "[WARN] ", "[ERROR] ", "[CRIT] "};
+    return level < sizeof(prefixes) / sizeof(prefixes[0]) ? prefixes[level] : "";
+}
+
+struct LogRecord
+{
+    enum Format : uint8_t
+    {
+        TEXT,
+        BINARY // text contient une trame BinaryLogWriter
+    };
+
+    uint32_t timestamp; // millis()
+    uint8_t level;      // Logger::Level
+    uint8_t format = TEXT;
+    uint16_t length;
+    char text[WIFIOTA_LOG_BUFFER_SIZE];
+};
+
+// Destination des lignes de log. Appelée depuis la tâche de vidage en mode
+// asynchrone : une sortie ne doit pas journaliser elle-même.
+class LogSink
+{
+public:
+    virtual ~LogSink() {}
+    virtual void write(const LogRecord &record) = 0;
+    virtual void flush() {}
+};
+
+class SerialLogSink : public LogSink
+{
+public:
+    void write(const LogRecord &record) override
+    {
+        // Trame brute : tools/wlog_decode.py la repère au milieu du texte
+        if (record.format == LogRecord::BINARY)
+        {
+            Serial.write((const uint8_t *)record.text, record.length);
+            return;
+        }
+        Serial.print(logLevelPrefix(record.level));
+        Serial.write((const uint8_t *)record.text, record.length);
+        Serial.println();
+    }
+
+    void flush() override { Serial.flush(); }
+};
+
+// Historique consultable (page web, commande...)
+class LogHistory : public LogSink
+{
+public:
+    virtual size_t count() = 0;
+    // index 0 = ligne la plus ancienne
+    virtual bool at(size_t index, LogRecord &record) = 0;
+    // Nombre de lignes écrites depuis le démarrage (modulo 2^32) : numéro de la prochaine ligne
+    virtual uint32_t written() = 0;
+    // Lecture par numéro de ligne, stable pendant que l'historique avance ;
+    // false si la ligne a déjà été écrasée ou n'est pas encore écrite
+    virtual bool get(uint32_t seq, LogRecord &record) = 0;
+};
+
+// Conserve les SIZE dernières lignes en mémoire
+template <size_t SIZE>
+class MemoryLogSink : public LogHistory
+{
+private:
+    CircularBuffer<LogRecord, SIZE> lines;
+    uint32_t total = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+public:
+    void write(const LogRecord &record) override
+    {
+        portENTER_CRITICAL(&lock);
+        lines.push(record);
+        total++;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    size_t count() override
+    {
+        portENTER_CRITICAL(&lock);
+        size_t n = lines.size();
+        portEXIT_CRITICAL(&lock);
+        return n;
+    }
+
+    bool at(size_t index, LogRecord &record) override
+    {
+        portENTER_CRITICAL(&lock);
+        bool found = index < lines.size();
+        if (found)
+            record = lines[index];
+        portEXIT_CRITICAL(&lock);
+        return found;
+    }
+
+    uint32_t written() override
+    {
+        portENTER_CRITICAL(&lock);
+        uint32_t n = total;
+        portEXIT_CRITICAL(&lock);
+        return n;
+    }
+
+    bool get(uint32_t seq, LogRecord &record) override
+    {
+        portENTER_CRITICAL(&lock);
+        uint32_t age = total - seq; // 1 = ligne la plus récente
+        bool found = age >= 1 && age <= lines.size();
+        if (found)
+            record = lines[lines.size() - age];
+        portEXIT_CRITICAL(&lock);
+        return found;
+    }
+
+    void clear()
+    {
+        portENTER_CRITICAL(&lock);
+        lines.clear();
+        portEXIT_CRITICAL(&lock);
+    }
+};
+
+// ═══════════════════════════════════════════════════════════
+// DISTRIBUTION DES LOGS vers les sorties
+// ═══════════════════════════════════════════════════════════
+//
+// Partagé par tous les Logger. Par défaut les lignes sont écrites
+// immédiatement sur Serial (sortie enregistrée d'office, retirable). Après begin(), elles sont copiées dans une file
+// préallouée et une tâche de faible priorité les transmet aux sorties :
+// l'appelant n'attend plus l'UART. Si la file est pleine la ligne est
+// perdue et comptée (getDropped()), l'appelant n'est jamais bloqué.
+
+class LogDispatcher
+{
+public:
+    static const uint8_t MAX_SINKS = 4;
+
+private:
+    LogSink *sinks[MAX_SINKS];
+    std::atomic<uint8_t> sinkCount{0}; // publié après l'écriture de sinks[] (addSink() après begin())
+    SerialLogSink serialSink;
+
+    CircularBuffer<LogRecord, WIFIOTA_LOG_QUEUE_SIZE> *queue = nullptr;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t task = nullptr;
+    uint32_t dropped = 0;
+    uint32_t droppedReported = 0;
+    std::atomic<bool> flushRequested{false}; // flush() en attente de la tâche de vidage
+
+    LogDispatcher() { addSink(&serialSink); }
+
+    void deliver(const LogRecord &record)
+    {
+        for (uint8_t i = 0; i < sinkCount; i++)
+            sinks[i]->write(record);
+    }
+
+    static void drainTask(void *arg)
+    {
+        LogDispatcher *self = (LogDispatcher *)arg;
+        for (;;)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            self->drain();
+            if (self->flushRequested.load())
+            {
+                // lignes mises en file juste avant la demande
+                self->drain();
+                self->flushSinks();
+                self->flushRequested.store(false);
+            }
+        }
+    }
+
+    void flushSinks()
+    {
+        for (uint8_t i = 0; i < sinkCount; i++)
+            sinks[i]->flush();
+    }
+
+public:
+    static LogDispatcher &instance()
+    {
+        static LogDispatcher dispatcher;
+        return dispatcher;
+    }
+
+    /**
+     * Ajoute une sortie, en plus de Serial. Possible après begin(), depuis
+     * une seule tâche : la tâche de vidage ne voit la sortie qu'une fois
+     * enregistrée. Pour couper une sortie en cours de route, la laisser
+     * enregistrée et ignorer les lignes (voir MQTTLogSink::setEnabled()).
+     */
+    bool addSink(LogSink *sink)
+    {
+        uint8_t n = sinkCount.load();
+        if (sink == nullptr || n >= MAX_SINKS)
+            return false;
+        for (uint8_t i = 0; i < n; i++)
+            if (sinks[i] == sink)
+                return true;
+        sinks[n] = sink;
+        sinkCount.store(n + 1);
+        return true;
+    }
+
+    /**
+     * Retire une sortie, par exemple removeSink(&dispatcher.serial()) pour
+     * ne plus écrire sur Serial. À appeler avant begin() : la tâche de
+     * vidage parcourt sinks[] sans verrou.
+     */
+    bool removeSink(LogSink *sink)
+    {
+        for (uint8_t i = 0; i < sinkCount; i++)
+        {
+            if (sinks[i] != sink)
+                continue;
+            for (uint8_t j = i + 1; j < sinkCount; j++)
+                sinks[j - 1] = sinks[j];
+            sinkCount--;
+            return true;
+        }
+        return false;
+    }
+
+    SerialLogSink &serial() { return serialSink; }
+
+    /**
+     * Passe en mode asynchrone : alloue la file et démarre la tâche de vidage.
+     *
+     * @param priority Priorité FreeRTOS de la tâche (1 = celle de loop()).
+     * @param core Cœur de la tâche (tskNO_AFFINITY par défaut).
+     * @param stackSize Pile de la tâche, à augmenter pour des sorties réseau.
+     */
+    bool begin(UBaseType_t priority = 1, BaseType_t core = tskNO_AFFINITY, uint32_t stackSize = 4096)
+    {
+        if (task != nullptr)
+            return true;
+        queue = new (std::nothrow) CircularBuffer<LogRecord, WIFIOTA_LOG_QUEUE_SIZE>();
+        if (queue == nullptr)
+            return false;
+        if (xTaskCreatePinnedToCore(drainTask, "logDrain", stackSize, this, priority, &task, core) != pdPASS)
+        {
+            delete queue;
+            queue = nullptr;
+            task = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void dispatch(const LogRecord &record)
+    {
+        if (queue == nullptr)
+        {
+            deliver(record);
+            return;
+        }
+
+        portENTER_CRITICAL(&lock);
+        bool queued = !queue->isFull();
+        if (queued)
+            queue->push(record);
+        else
+            dropped++;
+        portEXIT_CRITICAL(&lock);
+
+        if (queued)
+            xTaskNotifyGive(task);
+    }
+
+    /**
+     * Transmet les lignes en attente aux sorties. Appelé par la tâche de
+     * vidage ; depuis une autre tâche, utiliser flush().
+     *
+     * @return Nombre de lignes transmises.
+     */
+    size_t drain()
+    {
+        if (queue == nullptr)
+            return 0;
+
+        size_t n = 0;
+        LogRecord record;
+        for (;;)
+        {
+            // Les pertes sont signalées une fois la file vidée, à leur place
+            uint32_t lost = 0;
+            portENTER_CRITICAL(&lock);
+            bool available = queue->pop(record);
+            if (!available)
+            {
+                lost = dropped - droppedReported;
+                droppedReported = dropped;
+            }
+            portEXIT_CRITICAL(&lock);
+
+            if (available)
+            {
+                deliver(record);
+                n++;
+                continue;
+            }
+            if (lost > 0)
+            {
+                record.timestamp = millis();
+                record.level = 2; // WARNING
+                record.format = LogRecord::TEXT;
+                int len = snprintf(record.text, sizeof(record.text), "%u lignes de log perdues (file pleine)",
+                                   (unsigned)lost);
+                record.length = (uint16_t)min(len, (int)sizeof(record.text) - 1);
+                deliver(record);
+            }
+            return n;
+        }
+    }
+
+    /**
+     * Vide la file et les sorties, par exemple avant ESP.restart(). En mode
+     * asynchrone, la tâche de vidage s'en charge et l'appelant attend : une
+     * sortie n'est jamais appelée depuis deux tâches à la fois.
+     *
+     * @param timeoutMs Attente maximale de la tâche de vidage.
+     */
+    void flush(uint32_t timeoutMs = 1000)
+    {
+        if (task == nullptr || xTaskGetCurrentTaskHandle() == task)
+        {
+            drain();
+            flushSinks();
+            return;
+        }
+        flushRequested.store(true);
+        xTaskNotifyGive(task);
+        unsigned long start = millis();
+        while (flushRequested.load() && millis() - start < timeoutMs)
+            vTaskDelay(1);
+    }
+
+    bool isAsync() const { return queue != nullptr; }
+    uint32_t getDropped() const { return dropped; }
+};
 
 class Logger
 {
@@ -643,33 +1070,43 @@ public:
     {
         isEnabled_logger = active;
     }
+
+    bool isLevelEnabled(Level level) const { return isEnabled_logger && level >= currentLevel; }
+
+    void log(Level level, const char *message)
+    {
+        if (!isLevelEnabled(level))
+            return;
+        emit(level, message, strlen(message));
+    }
+
     void log(Level level, const String &message)
     {
-        if (level < currentLevel)
+        if (!isLevelEnabled(level))
             return;
+        emit(level, message.c_str(), message.length());
+    }
 
-        String prefix;
-        switch (level)
-        {
-        case DEBUG:
-            prefix = "[DEBUG] ";
-            break;
-        case INFO:
-            prefix = "[INFO] ";
-            break;
-        case WARNING:
-            prefix = "[WARN] ";
-            break;
-        case ERROR:
-            prefix = "[ERROR] ";
-            break;
-        case CRITICAL:
-            prefix = "[CRIT] ";
-            break;
-        }
-        String fullMessage = prefix + message;
-        if (isEnabled_logger)
-            Serial.println(fullMessage);
+    void logf(Level level, const char *format, ...) __attribute__((format(printf, 3, 4)))
+    {
+        va_list args;
+        va_start(args, format);
+        vlogf(level, format, args);
+        va_end(args);
+    }
+
+    void vlogf(Level level, const char *format, va_list args)
+    {
+        if (!isLevelEnabled(level))
+            return;
+        LogRecord record;
+        int len = vsnprintf(record.text, sizeof(record.text), format, args);
+        if (len < 0)
+            return;
+        record.length = (uint16_t)min(len, (int)sizeof(record.text) - 1);
+        record.level = level;
+        record.timestamp = millis();
+        LogDispatcher::instance().dispatch(record);
     }
 
     void debug(const String &msg) { log(DEBUG, msg); }
@@ -678,7 +1115,90 @@ public:
     void error(const String &msg) { log(ERROR, msg); }
     void critical(const String &msg) { log(CRITICAL, msg); }
 
+    // Littéraux : pas de String temporaire
+    void debug(const char *msg) { log(DEBUG, msg); }
+    void info(const char *msg) { log(INFO, msg); }
+    void warning(const char *msg) { log(WARNING, msg); }
+    void error(const char *msg) { log(ERROR, msg); }
+    void critical(const char *msg) { log(CRITICAL, msg); }
+
+    // Variantes printf : mise en forme uniquement si le niveau est actif
+    void debugf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        vlogf(DEBUG, format, args);
+        va_end(args);
+    }
+
+    void infof(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        vlogf(INFO, format, args);
+        va_end(args);
+    }
+
+    void warningf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        vlogf(WARNING, format, args);
+        va_end(args);
+    }
+
+    void errorf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        vlogf(ERROR, format, args);
+        va_end(args);
+    }
+
+    void criticalf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        vlogf(CRITICAL, format, args);
+        va_end(args);
+    }
+
+    /**
+     * Enregistrement binaire : identifiant du format et arguments bruts, sans
+     * mise en forme sur l'appareil. Utiliser WLOG_BIN plutôt qu'un appel direct.
+     *
+     * @param id Hash::fnv1a() du format printf (voir tools/wlog_catalog.py).
+     */
+    template <typename... Args>
+    void logBinary(Level level, uint32_t id, const Args &...args)
+    {
+        if (!isLevelEnabled(level))
+            return;
+        LogRecord record;
+        record.timestamp = millis();
+        record.level = level;
+        record.format = LogRecord::BINARY;
+        BinaryLogWriter writer((uint8_t *)record.text, sizeof(record.text));
+        writer.begin(id, record.timestamp, level);
+        BinaryLogArgs::encodeAll(writer, args...);
+        record.length = (uint16_t)writer.finish();
+        LogDispatcher::instance().dispatch(record);
+    }
+
+    static const char *getLevelPrefix(Level level) { return logLevelPrefix(level); }
+
 private:
+    void emit(Level level, const char *text, size_t len)
+    {
+        LogRecord record;
+        record.length = (uint16_t)min(len, sizeof(record.text) - 1);
+        memcpy(record.text, text, record.length);
+        record.text[record.length] = '\0';
+        record.level = level;
+        record.timestamp = millis();
+        LogDispatcher::instance().dispatch(record);
+    }
+
     String getLevelString(Level level)
     {
         switch (level)
@@ -699,6 +1219,50 @@ private:
     }
 };
 
+// Niveau retiré à la compilation : la condition est constante, l'appel et
+// ses arguments disparaissent. Sinon les arguments ne sont évalués que si le
+// niveau est actif à l'exécution.
+#define WIFIOTA_LOG_AT(logger, level, method, ...)                                        \
+    do                                                                                   \
+    {                                                                                    \
+        if (WIFIOTA_LOG_LEVEL <= WIFIOTA_LOG_LEVEL_##level && (logger).isLevelEnabled(Logger::level)) \
+            (logger).method(__VA_ARGS__);                                                \
+    } while (0)
+
+// Message String ou littéral : WLOG_INFO(logs, "SSID: " + ssid)
+#define WLOG_DEBUG(logger, msg) WIFIOTA_LOG_AT(logger, DEBUG, debug, msg)
+#define WLOG_INFO(logger, msg) WIFIOTA_LOG_AT(logger, INFO, info, msg)
+#define WLOG_WARNING(logger, msg) WIFIOTA_LOG_AT(logger, WARNING, warning, msg)
+#define WLOG_ERROR(logger, msg) WIFIOTA_LOG_AT(logger, ERROR, error, msg)
+#define WLOG_CRITICAL(logger, msg) WIFIOTA_LOG_AT(logger, CRITICAL, critical, msg)
+
+// Trace binaire : WLOG_BIN(logs, INFO, "Signal: %d dBm", rssi). Le format
+// (littéral obligatoire) est vérifié comme un printf mais seule son
+// empreinte est compilée ; le texte est reconstruit sur l'hôte par
+// tools/wlog_decode.py à partir du catalogue de tools/wlog_catalog.py.
+#define WLOG_BIN(logger, level, format, ...)                                                          \
+    do                                                                                               \
+    {                                                                                                \
+        (void)sizeof(binaryLogFormatCheck(format, ##__VA_ARGS__));                                   \
+        WIFIOTA_LOG_AT(logger, level, logBinary, Logger::level, WIFIOTA_HASH(format), ##__VA_ARGS__); \
+    } while (0)
+
+// Format printf : WLOG_INFOF(logs, "SSID: %s", ssid.c_str())
+// Avec -DWIFIOTA_LOG_BINARY=1 ces appels deviennent des traces binaires.
+#if defined(WIFIOTA_LOG_BINARY) && WIFIOTA_LOG_BINARY
+#define WLOG_DEBUGF(logger, ...) WLOG_BIN(logger, DEBUG, __VA_ARGS__)
+#define WLOG_INFOF(logger, ...) WLOG_BIN(logger, INFO, __VA_ARGS__)
+#define WLOG_WARNINGF(logger, ...) WLOG_BIN(logger, WARNING, __VA_ARGS__)
+#define WLOG_ERRORF(logger, ...) WLOG_BIN(logger, ERROR, __VA_ARGS__)
+#define WLOG_CRITICALF(logger, ...) WLOG_BIN(logger, CRITICAL, __VA_ARGS__)
+#else
+#define WLOG_DEBUGF(logger, ...) WIFIOTA_LOG_AT(logger, DEBUG, debugf, __VA_ARGS__)
+#define WLOG_INFOF(logger, ...) WIFIOTA_LOG_AT(logger, INFO, infof, __VA_ARGS__)
+#define WLOG_WARNINGF(logger, ...) WIFIOTA_LOG_AT(logger, WARNING, warningf, __VA_ARGS__)
+#define WLOG_ERRORF(logger, ...) WIFIOTA_LOG_AT(logger, ERROR, errorf, __VA_ARGS__)
+#define WLOG_CRITICALF(logger, ...) WIFIOTA_LOG_AT(logger, CRITICAL, criticalf, __VA_ARGS__)
+#endif
+
 // ═══════════════════════════════════════════════════════════
 // SYSTÈME DE GESTION DU BUZZER
 // ═══════════════════════════════════════════════════════════
@@ -707,49 +1271,39 @@ class Buzzer
 {
 private:
     int pin;
-    bool state = false;
-    unsigned long lastToggle = 0;
-    unsigned int interval = 0;
+    PatternPlayer player;
 
 public:
     Buzzer(int p) : pin(p) {}
 
-    void begin()
+    /**
+     * @param toneFrequency Fréquence d'un buzzer passif ; 0 pour un buzzer
+     *                      actif (tout ou rien).
+     */
+    void begin(uint16_t toneFrequency = 0)
     {
-        pinMode(pin, OUTPUT);
-        digitalWrite(pin, LOW);
+        player.begin(pin, toneFrequency);
     }
 
     void setPattern(const String &mode)
     {
         if (mode == "off")
-        {
-            state = false;
-            digitalWrite(pin, LOW);
-            interval = 0;
-        }
+            player.stop();
         else if (mode == "alert")
-        {
-            interval = 100; // bip rapide
-        }
+            player.play(Patterns::ALERT); // bip rapide
         else if (mode == "warning")
-        {
-            interval = 500; // bip lent
-        }
+            player.play(Patterns::WARNING); // bip lent
     }
 
-    void update()
+    void setPattern(const PatternStep *steps, size_t count, bool repeat = true)
     {
-        if (interval == 0)
-            return;
-        unsigned long now = millis();
-        if (now - lastToggle >= interval)
-        {
-            state = !state;
-            digitalWrite(pin, state ? HIGH : LOW);
-            lastToggle = now;
-        }
+        player.play(steps, count, repeat);
     }
+
+    // Conservé pour compatibilité : les bips sont joués par esp_timer
+    void update() {}
+
+    PatternPlayer &getPlayer() { return player; }
 };
 
 #endif // UTILITIES_H
\ No newline at end of file
@@ -0,0 +1,161 @@
+// Cœur Arduino simulé pour la compilation sur la machine hôte
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <deque>
+#include <map>
+#include <algorithm>
+#include <functional>
+
+#include "FakeClock.h"
+#include "WString.h"
+#include "Print.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define PROGMEM
+#define PI 3.1415926535897932384626433832795
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define HEX 16
+#define DEC 10
+#define LED_BUILTIN 2
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline unsigned long millis() { return (unsigned long)(fake::clock().micros.load() / 1000); }
+inline unsigned long micros() { return (unsigned long)fake::clock().micros.load(); }
+inline void delay(unsigned long ms) { fake::advanceTimersTo(fake::clock().micros.load() + ms * 1000ULL); }
+inline void delayMicroseconds(unsigned int us) { fake::advanceMicros(us); }
+inline void yield() {}
+
+namespace fake
+{
+    inline std::map<uint8_t, int> pinLevels;
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t val) { fake::pinLevels[pin] = val; }
+inline int digitalRead(uint8_t pin) { return fake::pinLevels[pin]; }
+inline void analogWrite(uint8_t pin, int val) { fake::pinLevels[pin] = val; }
+inline int analogRead(uint8_t pin) { return fake::pinLevels[pin]; }
+
+// Fuseau POSIX équivalent à celui du core (SNTP non simulé, voir esp_sntp.h)
+inline void configTime(long gmtOffset_sec, int, const char *, const char * = nullptr, const char * = nullptr)
+{
+    char tz[32];
+    snprintf(tz, sizeof(tz), "UTC%+ld:%02ld", -gmtOffset_sec / 3600, labs(gmtOffset_sec % 3600) / 60);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// LEDC, API du core 2.x (par canal)
+namespace fake
+{
+    struct Ledc
+    {
+        int pin = -1;
+        uint32_t freq = 0;
+        uint32_t duty = 0;
+        uint32_t tone = 0;
+    };
+
+    inline Ledc &ledc(uint8_t channel)
+    {
+        static Ledc channels[16];
+        return channels[channel & 15];
+    }
+}
+
+inline uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t)
+{
+    fake::ledc(channel).freq = freq;
+    return freq;
+}
+inline void ledcAttachPin(uint8_t pin, uint8_t channel) { fake::ledc(channel).pin = pin; }
+inline void ledcWrite(uint8_t channel, uint32_t duty) { fake::ledc(channel).duty = duty; }
+inline uint32_t ledcWriteTone(uint8_t channel, uint32_t freq)
+{
+    fake::ledc(channel).tone = freq;
+    fake::ledc(channel).duty = freq ? 128 : 0;
+    return freq;
+}
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long) {}
+    int available();
+    int read();
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    void flush() {}
+    operator bool() const { return true; }
+};
+inline HardwareSerial Serial;
+
+namespace fake
+{
+    inline std::string serialOutput;    // tout ce qui est écrit sur Serial
+    inline std::deque<uint8_t> serialInput; // à lire par Serial.read()
+    inline int restartCount = 0;        // appels à ESP.restart()
+}
+
+inline int HardwareSerial::available() { return (int)fake::serialInput.size(); }
+inline int HardwareSerial::read()
+{
+    if (fake::serialInput.empty())
+        return -1;
+    uint8_t c = fake::serialInput.front();
+    fake::serialInput.pop_front();
+    return c;
+}
+inline size_t HardwareSerial::write(uint8_t c)
+{
+    fake::serialOutput += (char)c;
+    return 1;
+}
+inline size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    fake::serialOutput.append((const char *)buffer, size);
+    return size;
+}
+
+class EspClass
+{
+public:
+    void restart() { fake::restartCount++; }
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMinFreeHeap() { return 150000; }
+    uint32_t getMaxAllocHeap() { return 100000; }
+    const char *getChipModel() { return "ESP32-HOST"; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint64_t getEfuseMac() { return 0x123456789ABCULL; }
+    uint32_t getCycleCount() { return (uint32_t)(fake::clock().micros.load() * 240); }
+    uint32_t getSketchSize() { return 1024 * 1024; }
+    uint32_t getFreeSketchSpace() { return 1536 * 1024; }
+};
+inline EspClass ESP;
+
+#endif
@@ -0,0 +1,4 @@
+// AsyncTCP simulé (rien à faire sur l'hôte)
+#ifndef FAKE_ASYNCTCP_H
+#define FAKE_ASYNCTCP_H
+#endif
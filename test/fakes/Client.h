@@ -0,0 +1,17 @@
+// Client réseau simulé
+#ifndef FAKE_CLIENT_H
+#define FAKE_CLIENT_H
+
+#include "Stream.h"
+
+class Client : public Stream
+{
+public:
+    virtual int connect(const char *host, uint16_t port) = 0;
+    virtual int read(uint8_t *buf, size_t size) = 0;
+    using Stream::read;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+};
+
+#endif
@@ -0,0 +1,195 @@
+// ESPAsyncWebServer simulé : les routes enregistrées peuvent être
+// invoquées directement par les tests via AsyncWebServer::fakeRequest().
+#ifndef FAKE_ESPASYNCWEBSERVER_H
+#define FAKE_ESPASYNCWEBSERVER_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+typedef enum
+{
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_ANY = 0b01111111
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebParameter
+{
+private:
+    String _name;
+    String _value;
+    bool _isPost;
+
+public:
+    AsyncWebParameter(const String &name, const String &value, bool post) : _name(name), _value(value), _isPost(post) {}
+    const String &name() const { return _name; }
+    const String &value() const { return _value; }
+    bool isPost() const { return _isPost; }
+};
+
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
+
+class AsyncWebServerResponse
+{
+public:
+    int code = 200;
+    String contentType;
+    String content;
+    std::map<std::string, std::string> headers;
+    AwsResponseFiller filler;
+
+    void addHeader(const String &name, const String &value) { headers[name.c_str()] = value.c_str(); }
+
+    // Déroule un filler chunked comme le ferait le serveur
+    void drain()
+    {
+        if (!filler)
+            return;
+        uint8_t buf[512];
+        size_t index = 0;
+        for (;;)
+        {
+            size_t n = filler(buf, sizeof(buf), index);
+            if (n == 0)
+                break;
+            content.concat((const char *)buf, (unsigned int)n);
+            index += n;
+        }
+        filler = nullptr;
+    }
+};
+
+class AsyncWebServerRequest
+{
+public:
+    // Contrôle par les tests
+    bool fakeAuthenticated = true;
+    std::vector<AsyncWebParameter> params;
+    WebRequestMethodComposite fakeMethod = HTTP_GET;
+    String fakeUrl;
+    std::unique_ptr<AsyncWebServerResponse> response;
+
+    std::function<void()> disconnectHandler;
+
+    bool authenticate(const char *, const char *) { return fakeAuthenticated; }
+    void onDisconnect(std::function<void()> fn) { disconnectHandler = fn; }
+    void requestAuthentication() { send(401, "text/plain", "Unauthorized"); }
+
+    WebRequestMethodComposite method() const { return fakeMethod; }
+    const String &url() const { return fakeUrl; }
+    size_t contentLength() const { return 0; }
+
+    bool hasParam(const String &name, bool post = false) const { return getParam(name, post) != nullptr; }
+    const AsyncWebParameter *getParam(const String &name, bool post = false) const
+    {
+        for (const auto &p : params)
+            if (p.name() == name && p.isPost() == post)
+                return &p;
+        return nullptr;
+    }
+    bool hasArg(const char *name) const { return hasParam(name) || hasParam(name, true); }
+    String arg(const char *name) const
+    {
+        const AsyncWebParameter *p = getParam(name);
+        if (!p)
+            p = getParam(name, true);
+        return p ? p->value() : String();
+    }
+
+    AsyncWebServerResponse *beginResponse(int code, const String &contentType, const String &content = String())
+    {
+        AsyncWebServerResponse *r = new AsyncWebServerResponse();
+        r->code = code;
+        r->contentType = contentType;
+        r->content = content;
+        return r;
+    }
+    AsyncWebServerResponse *beginChunkedResponse(const String &contentType, AwsResponseFiller filler)
+    {
+        AsyncWebServerResponse *r = new AsyncWebServerResponse();
+        r->contentType = contentType;
+        r->filler = filler;
+        return r;
+    }
+    void send(AsyncWebServerResponse *r)
+    {
+        response.reset(r);
+        response->drain();
+    }
+    void send(int code, const String &contentType = String(), const String &content = String())
+    {
+        send(beginResponse(code, contentType, content));
+    }
+};
+
+typedef std::function<void(AsyncWebServerRequest *)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *, const String &, size_t, uint8_t *, size_t, bool)> ArUploadHandlerFunction;
+
+class AsyncWebServer
+{
+public:
+    struct Route
+    {
+        String uri;
+        WebRequestMethodComposite method;
+        ArRequestHandlerFunction onRequest;
+        ArUploadHandlerFunction onUpload;
+    };
+    std::vector<Route> routes;
+    bool started = false;
+
+    AsyncWebServer(uint16_t) {}
+    void begin() { started = true; }
+    void end() { started = false; }
+
+    void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest)
+    {
+        routes.push_back({uri, method, onRequest, nullptr});
+    }
+    void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+            ArUploadHandlerFunction onUpload)
+    {
+        routes.push_back({uri, method, onRequest, onUpload});
+    }
+
+    const Route *findRoute(const String &uri, WebRequestMethodComposite method) const
+    {
+        for (const auto &r : routes)
+            if (r.uri == uri && (r.method & method))
+                return &r;
+        return nullptr;
+    }
+
+    // Exécute une route comme si une requête HTTP était reçue
+    bool fakeRequest(AsyncWebServerRequest &request, const String &uri, WebRequestMethodComposite method = HTTP_GET,
+                     const std::vector<uint8_t> *upload = nullptr, size_t uploadChunk = 1024)
+    {
+        const Route *r = findRoute(uri, method);
+        if (!r)
+            return false;
+        request.fakeMethod = method;
+        request.fakeUrl = uri;
+        if (upload && r->onUpload)
+        {
+            size_t index = 0;
+            std::vector<uint8_t> copy(*upload);
+            do
+            {
+                size_t n = std::min(uploadChunk, copy.size() - index);
+                r->onUpload(&request, "firmware.bin", index, copy.data() + index, n, index + n >= copy.size());
+                index += n;
+            } while (index < copy.size());
+        }
+        r->onRequest(&request);
+        return true;
+    }
+};
+
+#endif
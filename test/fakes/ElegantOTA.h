@@ -0,0 +1,23 @@
+// ElegantOTA simulé
+#ifndef FAKE_ELEGANTOTA_H
+#define FAKE_ELEGANTOTA_H
+
+#include <functional>
+#include "ESPAsyncWebServer.h"
+
+class ElegantOTAClass
+{
+public:
+    std::function<void()> startCb;
+    std::function<void(size_t, size_t)> progressCb;
+    std::function<void(bool)> endCb;
+
+    void begin(AsyncWebServer *, const char * = "", const char * = "") {}
+    void loop() {}
+    void onStart(std::function<void()> cb) { startCb = cb; }
+    void onProgress(std::function<void(size_t, size_t)> cb) { progressCb = cb; }
+    void onEnd(std::function<void(bool)> cb) { endCb = cb; }
+};
+inline ElegantOTAClass ElegantOTA;
+
+#endif
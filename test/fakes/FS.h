@@ -0,0 +1,117 @@
+// Système de fichiers simulé : les chemins sont relatifs à fake::fsRoot
+#ifndef FAKE_FS_H
+#define FAKE_FS_H
+
+#include <Arduino.h>
+#include <dirent.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fake
+{
+    inline std::string &fsRoot()
+    {
+        static std::string root = "/tmp/fake_fs";
+        return root;
+    }
+}
+
+namespace fs
+{
+    class File
+    {
+    private:
+        struct Impl
+        {
+            FILE *fp = nullptr;
+            std::string path;
+            std::string name;
+            bool dir = false;
+            std::vector<std::string> entries;
+            size_t next = 0;
+            ~Impl()
+            {
+                if (fp)
+                    fclose(fp);
+            }
+        };
+        std::shared_ptr<Impl> impl;
+
+    public:
+        File() {}
+        static File open(const std::string &virt, const char *mode)
+        {
+            File f;
+            std::string real = fake::fsRoot() + virt;
+            struct stat st;
+            auto impl = std::make_shared<Impl>();
+            impl->path = virt;
+            impl->name = virt.substr(virt.rfind('/') + 1);
+            if (stat(real.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+            {
+                impl->dir = true;
+                DIR *d = opendir(real.c_str());
+                for (dirent *e = readdir(d); e; e = readdir(d))
+                    if (e->d_name[0] != '.')
+                        impl->entries.push_back(e->d_name);
+                closedir(d);
+            }
+            else
+            {
+                std::string m = std::string(mode) + "b";
+                impl->fp = fopen(real.c_str(), m.c_str());
+                if (!impl->fp)
+                    return f;
+            }
+            f.impl = impl;
+            return f;
+        }
+        operator bool() const { return impl != nullptr; }
+        bool isDirectory() const { return impl && impl->dir; }
+        const char *name() const { return impl->name.c_str(); }
+        const char *path() const { return impl->path.c_str(); }
+        size_t write(const uint8_t *data, size_t len) { return fwrite(data, 1, len, impl->fp); }
+        size_t read(uint8_t *data, size_t len) { return fread(data, 1, len, impl->fp); }
+        size_t size() const
+        {
+            long pos = ftell(impl->fp);
+            fseek(impl->fp, 0, SEEK_END);
+            long end = ftell(impl->fp);
+            fseek(impl->fp, pos, SEEK_SET);
+            return (size_t)end;
+        }
+        void close() { impl.reset(); }
+        File openNextFile()
+        {
+            if (!impl || !impl->dir || impl->next >= impl->entries.size())
+                return File();
+            return open(impl->path + "/" + impl->entries[impl->next++], FILE_READ);
+        }
+    };
+
+    class FS
+    {
+    public:
+        File open(const String &path, const char *mode = FILE_READ) { return File::open(path.c_str(), mode); }
+        File open(const char *path, const char *mode = FILE_READ) { return File::open(path, mode); }
+        bool exists(const String &path)
+        {
+            struct stat st;
+            return stat((fake::fsRoot() + path.c_str()).c_str(), &st) == 0;
+        }
+        bool mkdir(const String &path) { return ::mkdir((fake::fsRoot() + path.c_str()).c_str(), 0755) == 0; }
+        bool remove(const String &path) { return ::unlink((fake::fsRoot() + path.c_str()).c_str()) == 0; }
+        bool rmdir(const String &path) { return ::rmdir((fake::fsRoot() + path.c_str()).c_str()) == 0; }
+    };
+}
+
+using fs::File;
+
+#endif
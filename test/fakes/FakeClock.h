@@ -0,0 +1,27 @@
+// Horloge contrôlable pour les tests hôte
+#ifndef FAKE_CLOCK_H
+#define FAKE_CLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace fake
+{
+    struct Clock
+    {
+        std::atomic<uint64_t> micros{0}; // lue par les threads des tâches simulées
+    };
+
+    inline Clock &clock()
+    {
+        static Clock c;
+        return c;
+    }
+
+    inline void setMillis(uint64_t ms) { clock().micros = ms * 1000; }
+    inline void setMicros(uint64_t us) { clock().micros = us; }
+    inline void advanceMillis(uint64_t ms) { clock().micros += ms * 1000; }
+    inline void advanceMicros(uint64_t us) { clock().micros += us; }
+}
+
+#endif
@@ -0,0 +1,78 @@
+// HTTPClient simulé : les URL sont servies depuis fake::httpFiles()
+#ifndef FAKE_HTTPCLIENT_H
+#define FAKE_HTTPCLIENT_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "WiFiClient.h"
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_FOUND 404
+
+namespace fake
+{
+    inline std::map<std::string, std::vector<uint8_t>> &httpFiles()
+    {
+        static std::map<std::string, std::vector<uint8_t>> files;
+        return files;
+    }
+
+    // Flux servant un fichier par paquets de taille limitée
+    class BufferClient : public WiFiClient
+    {
+    public:
+        const std::vector<uint8_t> *data = nullptr;
+        size_t pos = 0;
+        size_t packet = 700;
+
+        int available() override
+        {
+            if (!data)
+                return 0;
+            size_t left = data->size() - pos;
+            return (int)(left < packet ? left : packet);
+        }
+        int read() override { return data && pos < data->size() ? (*data)[pos++] : -1; }
+        int read(uint8_t *buf, size_t size) override { return (int)readBytes(buf, size); }
+        size_t readBytes(uint8_t *buf, size_t size) override
+        {
+            size_t n = 0;
+            while (n < size && data && pos < data->size())
+                buf[n++] = (*data)[pos++];
+            return n;
+        }
+        uint8_t connected() override { return data && pos < data->size(); }
+    };
+}
+
+class HTTPClient
+{
+private:
+    String url;
+    fake::BufferClient stream;
+
+public:
+    bool begin(WiFiClient &, const String &u)
+    {
+        url = u;
+        return u.startsWith("http://") || u.startsWith("https://");
+    }
+    void useHTTP10(bool) {}
+    void setTimeout(uint16_t) {}
+    void setConnectTimeout(int32_t) {}
+    int GET()
+    {
+        auto it = fake::httpFiles().find(url.c_str());
+        if (it == fake::httpFiles().end())
+            return HTTP_CODE_NOT_FOUND;
+        stream.data = &it->second;
+        stream.pos = 0;
+        return HTTP_CODE_OK;
+    }
+    int getSize() { return stream.data ? (int)stream.data->size() : -1; }
+    WiFiClient *getStreamPtr() { return &stream; }
+    void end() { stream.data = nullptr; }
+};
+
+#endif
@@ -0,0 +1,40 @@
+// IPAddress simulée
+#ifndef FAKE_IPADDRESS_H
+#define FAKE_IPADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress
+{
+private:
+    uint8_t bytes[4] = {0, 0, 0, 0};
+
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+
+    bool fromString(const String &str)
+    {
+        unsigned int a, b, c, d;
+        char tail;
+        if (sscanf(str.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+            return false;
+        bytes[0] = a;
+        bytes[1] = b;
+        bytes[2] = c;
+        bytes[3] = d;
+        return true;
+    }
+
+    String toString() const
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        return String(buf);
+    }
+
+    uint8_t operator[](int i) const { return bytes[i]; }
+    bool operator==(const IPAddress &o) const { return memcmp(bytes, o.bytes, 4) == 0; }
+};
+
+#endif
@@ -0,0 +1,22 @@
+// LittleFS simulé au-dessus de FS.h
+#ifndef FAKE_LITTLEFS_H
+#define FAKE_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS
+{
+public:
+    bool begin(bool = false)
+    {
+        ::mkdir(fake::fsRoot().c_str(), 0755);
+        return true;
+    }
+    void end() {}
+    size_t totalBytes() { return 1536 * 1024; }
+    size_t usedBytes() { return 0; }
+};
+
+inline LittleFSFS LittleFS;
+
+#endif
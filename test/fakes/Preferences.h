@@ -0,0 +1,119 @@
+// Preferences (NVS) simulées en mémoire
+#ifndef FAKE_PREFERENCES_H
+#define FAKE_PREFERENCES_H
+
+#include <map>
+#include <string>
+#include "Arduino.h"
+
+namespace fake
+{
+    // namespace -> clé -> valeur sérialisée
+    inline std::map<std::string, std::map<std::string, std::string>> &nvs()
+    {
+        static std::map<std::string, std::map<std::string, std::string>> store;
+        return store;
+    }
+}
+
+class Preferences
+{
+private:
+    std::string ns;
+    bool readOnly = false;
+    bool opened = false;
+
+    std::map<std::string, std::string> &data() { return fake::nvs()[ns]; }
+
+    const std::string *find(const char *key)
+    {
+        auto &d = data();
+        auto it = d.find(key);
+        return it == d.end() ? nullptr : &it->second;
+    }
+
+    size_t put(const char *key, const std::string &value)
+    {
+        if (!opened || readOnly)
+            return 0;
+        data()[key] = value;
+        return value.size() > 0 ? value.size() : 1;
+    }
+
+public:
+    bool begin(const char *name, bool ro = false)
+    {
+        ns = name;
+        readOnly = ro;
+        opened = true;
+        return true;
+    }
+    void end() { opened = false; }
+    bool clear()
+    {
+        if (readOnly)
+            return false;
+        data().clear();
+        return true;
+    }
+    bool remove(const char *key) { return data().erase(key) > 0; }
+    bool isKey(const char *key) { return find(key) != nullptr; }
+
+    size_t putString(const char *key, const String &value) { return put(key, value.c_str()); }
+    size_t putString(const char *key, const char *value) { return put(key, value); }
+    size_t putInt(const char *key, int32_t value) { return put(key, std::to_string(value)); }
+    size_t putUInt(const char *key, uint32_t value) { return put(key, std::to_string(value)); }
+    size_t putULong64(const char *key, uint64_t value) { return put(key, std::to_string(value)); }
+    size_t putFloat(const char *key, float value) { return put(key, std::to_string(value)); }
+    size_t putBool(const char *key, bool value) { return put(key, value ? "1" : "0"); }
+    size_t putBytes(const char *key, const void *value, size_t len)
+    {
+        return put(key, std::string((const char *)value, len));
+    }
+
+    String getString(const char *key, const String &def = String())
+    {
+        const std::string *v = find(key);
+        return v ? String(*v) : def;
+    }
+    int32_t getInt(const char *key, int32_t def = 0)
+    {
+        const std::string *v = find(key);
+        return v ? (int32_t)strtol(v->c_str(), nullptr, 10) : def;
+    }
+    uint32_t getUInt(const char *key, uint32_t def = 0)
+    {
+        const std::string *v = find(key);
+        return v ? (uint32_t)strtoul(v->c_str(), nullptr, 10) : def;
+    }
+    uint64_t getULong64(const char *key, uint64_t def = 0)
+    {
+        const std::string *v = find(key);
+        return v ? (uint64_t)strtoull(v->c_str(), nullptr, 10) : def;
+    }
+    float getFloat(const char *key, float def = 0)
+    {
+        const std::string *v = find(key);
+        return v ? strtof(v->c_str(), nullptr) : def;
+    }
+    bool getBool(const char *key, bool def = false)
+    {
+        const std::string *v = find(key);
+        return v ? *v == "1" : def;
+    }
+    size_t getBytesLength(const char *key)
+    {
+        const std::string *v = find(key);
+        return v ? v->size() : 0;
+    }
+    size_t getBytes(const char *key, void *buf, size_t maxLen)
+    {
+        const std::string *v = find(key);
+        if (!v || v->size() > maxLen)
+            return 0;
+        memcpy(buf, v->data(), v->size());
+        return v->size();
+    }
+};
+
+#endif
@@ -0,0 +1,119 @@
+// PubSubClient simulé : enregistre les publications pour les tests
+#ifndef FAKE_PUBSUBCLIENT_H
+#define FAKE_PUBSUBCLIENT_H
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "Client.h"
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char *, uint8_t *, unsigned int)> callback
+
+class PubSubClient;
+
+namespace fake
+{
+    // Clients créés, dans l'ordre : les tests retrouvent celui d'un MQTTController
+    inline std::vector<PubSubClient *> &pubSubClients()
+    {
+        static std::vector<PubSubClient *> list;
+        return list;
+    }
+}
+
+class PubSubClient
+{
+public:
+    struct Message
+    {
+        std::string topic;
+        std::string payload;
+        bool retained;
+    };
+
+    // Contrôle par les tests
+    bool fakeConnectResult = true;
+    bool fakePublishResult = true;
+    std::vector<Message> published;
+    std::vector<std::string> subscriptions;
+    int connectAttempts = 0;
+
+    PubSubClient() { fake::pubSubClients().push_back(this); }
+    PubSubClient(Client &) { fake::pubSubClients().push_back(this); }
+    ~PubSubClient()
+    {
+        std::vector<PubSubClient *> &list = fake::pubSubClients();
+        list.erase(std::remove(list.begin(), list.end(), this), list.end());
+    }
+
+    PubSubClient &setServer(const char *, uint16_t) { return *this; }
+    PubSubClient &setCallback(MQTT_CALLBACK_SIGNATURE)
+    {
+        this->callback = callback;
+        return *this;
+    }
+    bool setBufferSize(uint16_t size)
+    {
+        bufferSize = size;
+        return true;
+    }
+    uint16_t getBufferSize() { return bufferSize; }
+    PubSubClient &setKeepAlive(uint16_t) { return *this; }
+
+    bool connect(const char *, const char * = nullptr, const char * = nullptr)
+    {
+        connectAttempts++;
+        isConnected = fakeConnectResult;
+        return isConnected;
+    }
+    void disconnect() { isConnected = false; }
+    bool connected() { return isConnected; }
+    int state() { return isConnected ? 0 : -1; }
+    bool loop() { return isConnected; }
+
+    bool publish(const char *topic, const char *payload, bool retained = false)
+    {
+        return publish(topic, (const uint8_t *)payload, strlen(payload), retained);
+    }
+    bool publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained = false)
+    {
+        if (!isConnected || !fakePublishResult)
+            return false;
+        published.push_back({topic, std::string((const char *)payload, length), retained});
+        return true;
+    }
+    bool subscribe(const char *topic)
+    {
+        subscriptions.push_back(topic);
+        return isConnected;
+    }
+    bool unsubscribe(const char *topic)
+    {
+        for (auto it = subscriptions.begin(); it != subscriptions.end(); ++it)
+            if (*it == topic)
+            {
+                subscriptions.erase(it);
+                return true;
+            }
+        return false;
+    }
+
+    // Simule la réception d'un message du broker
+    void fakeReceive(const char *topic, const std::string &payload)
+    {
+        if (callback)
+        {
+            std::vector<uint8_t> copy(payload.begin(), payload.end());
+            callback(const_cast<char *>(topic), copy.data(), (unsigned int)copy.size());
+        }
+    }
+
+private:
+    MQTT_CALLBACK_SIGNATURE;
+    bool isConnected = false;
+    uint16_t bufferSize = 256;
+};
+
+#endif
@@ -0,0 +1,24 @@
+// Stream simulé (sous-ensemble de l'API Arduino)
+#ifndef FAKE_STREAM_H
+#define FAKE_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual size_t readBytes(uint8_t *buffer, size_t length)
+    {
+        size_t n = 0;
+        int c;
+        while (n < length && (c = read()) >= 0)
+            buffer[n++] = (uint8_t)c;
+        return n;
+    }
+    size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t *)buffer, length); }
+    void setTimeout(unsigned long) {}
+};
+
+#endif
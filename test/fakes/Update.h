@@ -0,0 +1,66 @@
+// Updater simulé : l'image écrite est conservée en mémoire
+#ifndef FAKE_UPDATE_H
+#define FAKE_UPDATE_H
+
+#include <vector>
+#include "Arduino.h"
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+#define U_SPIFFS 100
+
+class UpdateClass
+{
+public:
+    std::vector<uint8_t> image;
+    size_t declaredSize = 0;
+    bool running = false;
+    bool finished = false;
+    // Contrôle par les tests
+    size_t fakeFailAfter = (size_t)-1;
+    uint32_t fakeWriteDelayUs = 0;  // par appel
+    uint32_t fakeSectorDelayUs = 0; // par secteur de 4 Ko vidé (effacement + écriture)
+    static const size_t SECTOR_SIZE = 4096;
+
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int = U_FLASH)
+    {
+        if (running) // comme l'Updater réel : une seule écriture à la fois
+            return false;
+        image.clear();
+        declaredSize = size;
+        running = true;
+        finished = false;
+        return true;
+    }
+    size_t write(uint8_t *data, size_t len)
+    {
+        if (!running || image.size() + len > fakeFailAfter)
+            return 0;
+        size_t sectors = image.size() / SECTOR_SIZE;
+        image.insert(image.end(), data, data + len);
+        fake::advanceMicros(fakeWriteDelayUs + (image.size() / SECTOR_SIZE - sectors) * fakeSectorDelayUs);
+        return len;
+    }
+    bool end(bool evenIfRemaining = false)
+    {
+        if (!running)
+            return false;
+        if (!evenIfRemaining && declaredSize != UPDATE_SIZE_UNKNOWN && image.size() != declaredSize)
+            return false;
+        running = false;
+        finished = true;
+        return true;
+    }
+    void abort() { running = false; }
+    bool isRunning() { return running; }
+    bool isFinished() { return finished; }
+    // Comme l'Updater réel : progress() n'avance qu'au vidage d'un secteur
+    size_t progress() { return finished ? image.size() : image.size() - image.size() % SECTOR_SIZE; }
+    size_t size() { return declaredSize; }
+    size_t remaining() { return declaredSize - image.size(); }
+    bool hasError() { return false; }
+    const char *errorString() { return "fake error"; }
+};
+inline UpdateClass Update;
+
+#endif
@@ -0,0 +1,216 @@
+// String Arduino simulée au-dessus de std::string
+#ifndef FAKE_WSTRING_H
+#define FAKE_WSTRING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) (s)
+
+class String
+{
+private:
+    std::string s;
+
+    static std::string fromUnsigned(unsigned long long v, unsigned char base)
+    {
+        if (v == 0)
+            return "0";
+        std::string out;
+        while (v > 0)
+        {
+            int d = (int)(v % base);
+            out.insert(out.begin(), (char)(d < 10 ? '0' + d : 'a' + d - 10));
+            v /= base;
+        }
+        return out;
+    }
+
+    static std::string fromSigned(long long v, unsigned char base)
+    {
+        if (v < 0 && base == 10)
+            return "-" + fromUnsigned((unsigned long long)(-v), base);
+        return fromUnsigned((unsigned long long)v, base);
+    }
+
+    static std::string fromDouble(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return buf;
+    }
+
+public:
+    String() {}
+    String(const char *cstr) : s(cstr ? cstr : "") {}
+    String(const char *cstr, unsigned int length) : s(cstr, length) {}
+    String(const std::string &str) : s(str) {}
+    String(char c) : s(1, c) {}
+    String(unsigned char v, unsigned char base = 10) : s(fromUnsigned(v, base)) {}
+    String(int v, unsigned char base = 10) : s(fromSigned(v, base)) {}
+    String(unsigned int v, unsigned char base = 10) : s(fromUnsigned(v, base)) {}
+    String(long v, unsigned char base = 10) : s(fromSigned(v, base)) {}
+    String(unsigned long v, unsigned char base = 10) : s(fromUnsigned(v, base)) {}
+    String(long long v, unsigned char base = 10) : s(fromSigned(v, base)) {}
+    String(unsigned long long v, unsigned char base = 10) : s(fromUnsigned(v, base)) {}
+    String(float v, unsigned int decimals = 2) : s(fromDouble(v, decimals)) {}
+    String(double v, unsigned int decimals = 2) : s(fromDouble(v, decimals)) {}
+
+    unsigned int length() const { return (unsigned int)s.size(); }
+    const char *c_str() const { return s.c_str(); }
+    bool reserve(unsigned int size)
+    {
+        s.reserve(size);
+        return true;
+    }
+    bool isEmpty() const { return s.empty(); }
+
+    char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index) { return s[index]; }
+
+    bool concat(const String &str)
+    {
+        s += str.s;
+        return true;
+    }
+    bool concat(const char *cstr)
+    {
+        if (cstr)
+            s += cstr;
+        return true;
+    }
+    bool concat(const char *cstr, unsigned int length)
+    {
+        s.append(cstr, length);
+        return true;
+    }
+    bool concat(char c)
+    {
+        s += c;
+        return true;
+    }
+
+    String &operator+=(const String &rhs)
+    {
+        s += rhs.s;
+        return *this;
+    }
+    String &operator+=(const char *cstr)
+    {
+        concat(cstr);
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        s += c;
+        return *this;
+    }
+    String &operator+=(int v) { return *this += String(v); }
+    String &operator+=(unsigned int v) { return *this += String(v); }
+    String &operator+=(long v) { return *this += String(v); }
+    String &operator+=(unsigned long v) { return *this += String(v); }
+    String &operator+=(float v) { return *this += String(v); }
+    String &operator+=(double v) { return *this += String(v); }
+
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+    friend String operator+(const String &a, const char *b) { return String(a.s + (b ? b : "")); }
+    friend String operator+(const char *a, const String &b) { return String((a ? a : "") + b.s); }
+    friend String operator+(const String &a, char c) { return String(a.s + c); }
+    friend String operator+(const String &a, int v) { return a + String(v); }
+    friend String operator+(const String &a, unsigned int v) { return a + String(v); }
+    friend String operator+(const String &a, long v) { return a + String(v); }
+    friend String operator+(const String &a, unsigned long v) { return a + String(v); }
+    friend String operator+(const String &a, float v) { return a + String(v); }
+    friend String operator+(const String &a, double v) { return a + String(v); }
+
+    bool equals(const String &o) const { return s == o.s; }
+    bool equals(const char *o) const { return s == (o ? o : ""); }
+    bool equalsIgnoreCase(const String &o) const
+    {
+        if (s.size() != o.s.size())
+            return false;
+        for (size_t i = 0; i < s.size(); i++)
+            if (tolower((unsigned char)s[i]) != tolower((unsigned char)o.s[i]))
+                return false;
+        return true;
+    }
+    friend bool operator==(const String &a, const String &b) { return a.s == b.s; }
+    friend bool operator==(const String &a, const char *b) { return a.equals(b); }
+    friend bool operator==(const char *a, const String &b) { return b.equals(a); }
+    friend bool operator!=(const String &a, const String &b) { return a.s != b.s; }
+    friend bool operator!=(const String &a, const char *b) { return !a.equals(b); }
+    friend bool operator<(const String &a, const String &b) { return a.s < b.s; }
+
+    bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t p = s.find(c, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    int indexOf(const String &str, unsigned int from = 0) const
+    {
+        size_t p = s.find(str.s, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    int lastIndexOf(char c) const
+    {
+        size_t p = s.rfind(c);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+
+    String substring(unsigned int begin) const { return begin >= s.size() ? String() : String(s.substr(begin)); }
+    String substring(unsigned int begin, unsigned int end) const
+    {
+        if (begin > end)
+            std::swap(begin, end);
+        if (begin >= s.size())
+            return String();
+        return String(s.substr(begin, end - begin));
+    }
+
+    void replace(const String &find, const String &replacement)
+    {
+        if (find.s.empty())
+            return;
+        size_t pos = 0;
+        while ((pos = s.find(find.s, pos)) != std::string::npos)
+        {
+            s.replace(pos, find.s.size(), replacement.s);
+            pos += replacement.s.size();
+        }
+    }
+    void remove(unsigned int index) { s.erase(index < s.size() ? index : s.size()); }
+    void remove(unsigned int index, unsigned int count) { s.erase(index, count); }
+    void toLowerCase()
+    {
+        for (auto &c : s)
+            c = (char)tolower((unsigned char)c);
+    }
+    void toUpperCase()
+    {
+        for (auto &c : s)
+            c = (char)toupper((unsigned char)c);
+    }
+    void trim()
+    {
+        size_t b = s.find_first_not_of(" \t\r\n");
+        size_t e = s.find_last_not_of(" \t\r\n");
+        s = (b == std::string::npos) ? std::string() : s.substr(b, e - b + 1);
+    }
+
+    long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s.c_str(), nullptr); }
+    double toDouble() const { return strtod(s.c_str(), nullptr); }
+};
+
+#endif
@@ -0,0 +1,113 @@
+// WiFi simulé : l'état de connexion est piloté par les tests
+#ifndef FAKE_WIFI_H
+#define FAKE_WIFI_H
+
+#include <vector>
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "Client.h"
+#include "WiFiUdp.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum
+{
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WPA2_PSK = 3
+} wifi_auth_mode_t;
+
+class WiFiClass
+{
+public:
+    struct Network
+    {
+        String ssid;
+        int32_t rssi;
+        wifi_auth_mode_t auth;
+    };
+
+    // Contrôle par les tests
+    wl_status_t fakeStatus = WL_DISCONNECTED;
+    bool fakeConnectOnBegin = true;
+    int32_t fakeRssi = -55;
+    IPAddress fakeLocalIP = IPAddress(192, 168, 1, 50);
+    std::vector<Network> fakeNetworks;
+
+    wifi_mode_t currentMode = WIFI_OFF;
+    String currentSsid;
+
+    bool mode(wifi_mode_t m)
+    {
+        currentMode = m;
+        return true;
+    }
+    wifi_mode_t getMode() { return currentMode; }
+    bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress()) { return true; }
+    wl_status_t begin(const char *ssid, const char * = nullptr)
+    {
+        currentSsid = ssid;
+        fakeStatus = fakeConnectOnBegin ? WL_CONNECTED : WL_DISCONNECTED;
+        return fakeStatus;
+    }
+    bool disconnect(bool = false)
+    {
+        fakeStatus = WL_DISCONNECTED;
+        return true;
+    }
+    wl_status_t status() { return fakeStatus; }
+    bool isConnected() { return fakeStatus == WL_CONNECTED; }
+    String SSID() { return currentSsid; }
+    int32_t RSSI() { return fakeRssi; }
+    IPAddress localIP() { return fakeLocalIP; }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    bool softAP(const char *ssid, const char * = nullptr)
+    {
+        currentSsid = ssid;
+        return true;
+    }
+    String macAddress() { return "24:0A:C4:00:00:01"; }
+    bool hostByName(const char *, IPAddress &result)
+    {
+        result = IPAddress(10, 0, 0, 1);
+        return true;
+    }
+
+    int16_t scanNetworks() { return (int16_t)fakeNetworks.size(); }
+    String SSID(uint8_t i) { return fakeNetworks[i].ssid; }
+    int32_t RSSI(uint8_t i) { return fakeNetworks[i].rssi; }
+    wifi_auth_mode_t encryptionType(uint8_t i) { return fakeNetworks[i].auth; }
+    void scanDelete() {}
+};
+inline WiFiClass WiFi;
+
+class WiFiClient : public Client
+{
+public:
+    int connect(const char *, uint16_t) override { return 1; }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t *, size_t size) override { return size; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int read(uint8_t *, size_t) override { return 0; }
+    void stop() override {}
+    uint8_t connected() override { return 1; }
+    operator bool() { return true; }
+};
+
+#endif
@@ -0,0 +1,5 @@
+// WiFiClient : défini avec WiFi.h
+#ifndef FAKE_WIFICLIENT_H
+#define FAKE_WIFICLIENT_H
+#include "WiFi.h"
+#endif
@@ -0,0 +1,16 @@
+// Client TLS simulé
+#ifndef FAKE_WIFICLIENTSECURE_H
+#define FAKE_WIFICLIENTSECURE_H
+
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient
+{
+public:
+    bool insecure = false;
+    const char *caCert = nullptr;
+    void setInsecure() { insecure = true; }
+    void setCACert(const char *cert) { caCert = cert; }
+};
+
+#endif
@@ -0,0 +1,62 @@
+// UDP simulé : les réponses sont injectées par les tests
+#ifndef FAKE_WIFIUDP_H
+#define FAKE_WIFIUDP_H
+
+#include <deque>
+#include <vector>
+#include "Client.h"
+#include "IPAddress.h"
+
+class WiFiUDP : public Stream
+{
+public:
+    std::vector<uint8_t> sent;
+    std::deque<std::vector<uint8_t>> fakeIncoming;
+    std::vector<uint8_t> current;
+    size_t readPos = 0;
+
+    uint8_t begin(uint16_t) { return 1; }
+    void stop() {}
+    int beginPacket(const char *, uint16_t)
+    {
+        sent.clear();
+        return 1;
+    }
+    int beginPacket(IPAddress, uint16_t)
+    {
+        sent.clear();
+        return 1;
+    }
+    int endPacket() { return 1; }
+    size_t write(uint8_t c) override
+    {
+        sent.push_back(c);
+        return 1;
+    }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        sent.insert(sent.end(), buf, buf + size);
+        return size;
+    }
+    int parsePacket()
+    {
+        if (fakeIncoming.empty())
+            return 0;
+        current = fakeIncoming.front();
+        fakeIncoming.pop_front();
+        readPos = 0;
+        return (int)current.size();
+    }
+    int available() override { return (int)(current.size() - readPos); }
+    int read() override { return readPos < current.size() ? current[readPos++] : -1; }
+    int read(uint8_t *buf, size_t len)
+    {
+        size_t n = 0;
+        while (n < len && readPos < current.size())
+            buf[n++] = current[readPos++];
+        return (int)n;
+    }
+    IPAddress remoteIP() { return IPAddress(10, 0, 0, 1); }
+};
+
+#endif
@@ -0,0 +1,10 @@
+// Attributs de placement mémoire : sans effet sur l'hôte
+#ifndef FAKE_ESP_ATTR_H
+#define FAKE_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif
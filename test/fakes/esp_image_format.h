@@ -0,0 +1,5 @@
+// En-tête d'image ESP-IDF (constantes seulement)
+#ifndef FAKE_ESP_IMAGE_FORMAT_H
+#define FAKE_ESP_IMAGE_FORMAT_H
+#define ESP_IMAGE_HEADER_MAGIC 0xE9
+#endif
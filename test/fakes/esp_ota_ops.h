@@ -0,0 +1,6 @@
+// API OTA ESP-IDF : voir esp_partition.h
+#ifndef FAKE_ESP_OTA_OPS_H
+#define FAKE_ESP_OTA_OPS_H
+#include "esp_partition.h"
+inline const esp_partition_t *esp_ota_get_running_partition() { return &fake::runningPartition(); }
+#endif
@@ -0,0 +1,38 @@
+// Partitions simulées : la partition courante est un tampon en mémoire
+#ifndef FAKE_ESP_PARTITION_H
+#define FAKE_ESP_PARTITION_H
+
+#include <string.h>
+#include <vector>
+#include "esp_err.h"
+
+typedef struct
+{
+    uint32_t address;
+    uint32_t size;
+    const char *label;
+} esp_partition_t;
+
+namespace fake
+{
+    inline std::vector<uint8_t> &runningImage()
+    {
+        static std::vector<uint8_t> image;
+        return image;
+    }
+    inline esp_partition_t &runningPartition()
+    {
+        static esp_partition_t p = {0x10000, 0x180000, "app0"};
+        return p;
+    }
+}
+
+inline esp_err_t esp_partition_read(const esp_partition_t *, size_t offset, void *dst, size_t size)
+{
+    std::vector<uint8_t> &img = fake::runningImage();
+    for (size_t i = 0; i < size; i++)
+        ((uint8_t *)dst)[i] = offset + i < img.size() ? img[offset + i] : 0xFF;
+    return ESP_OK;
+}
+
+#endif
@@ -0,0 +1,19 @@
+// Compteur RTC simulé : suit l'horloge simulée, décalé par fake::rtcOffsetUs()
+#ifndef FAKE_ESP_CLK_H
+#define FAKE_ESP_CLK_H
+
+#include <stdint.h>
+#include "../FakeClock.h"
+
+namespace fake
+{
+    inline int64_t &rtcOffsetUs()
+    {
+        static int64_t offset = 0;
+        return offset;
+    }
+}
+
+inline uint64_t esp_clk_rtc_time() { return fake::clock().micros.load() + fake::rtcOffsetUs(); }
+
+#endif
@@ -0,0 +1,37 @@
+// SNTP simulé : fake::sntpSync() déclenche la notification de synchronisation
+#ifndef FAKE_ESP_SNTP_H
+#define FAKE_ESP_SNTP_H
+
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval *tv);
+
+namespace fake
+{
+    inline sntp_sync_time_cb_t &sntpCallback()
+    {
+        static sntp_sync_time_cb_t cb = nullptr;
+        return cb;
+    }
+
+    inline void sntpSync(struct timeval tv)
+    {
+        if (sntpCallback())
+            sntpCallback()(&tv);
+    }
+}
+
+namespace fake
+{
+    inline uint32_t &sntpIntervalMs()
+    {
+        static uint32_t interval = 3600000;
+        return interval;
+    }
+}
+
+inline void sntp_set_sync_interval(uint32_t ms) { fake::sntpIntervalMs() = ms; }
+
+inline void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t cb) { fake::sntpCallback() = cb; }
+
+#endif
@@ -0,0 +1,41 @@
+// Watchdog de tâches simulé : compte les abonnements et les réarmements
+#ifndef FAKE_ESP_TASK_WDT_H
+#define FAKE_ESP_TASK_WDT_H
+
+#include "esp_err.h"
+#include "freertos/task.h"
+
+namespace fake
+{
+    struct TaskWdt
+    {
+        int subscribed = 0;
+        uint32_t resets = 0;
+    };
+
+    inline TaskWdt &taskWdt()
+    {
+        static TaskWdt wdt;
+        return wdt;
+    }
+}
+
+inline esp_err_t esp_task_wdt_add(TaskHandle_t)
+{
+    fake::taskWdt().subscribed++;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_delete(TaskHandle_t)
+{
+    fake::taskWdt().subscribed--;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_reset()
+{
+    fake::taskWdt().resets++;
+    return ESP_OK;
+}
+
+#endif
@@ -0,0 +1,132 @@
+// esp_timer simulé : les timers sont déclenchés par delay() ou fake::runTimers()
+#ifndef FAKE_ESP_TIMER_H
+#define FAKE_ESP_TIMER_H
+
+#include <stdint.h>
+#include <vector>
+#include "esp_err.h"
+#include "FakeClock.h"
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum
+{
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR
+} esp_timer_dispatch_t;
+
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct FakeEspTimer
+{
+    esp_timer_create_args_t args;
+    uint64_t periodUs;
+    uint64_t nextUs;
+    bool running;
+    bool periodic;
+};
+typedef FakeEspTimer *esp_timer_handle_t;
+
+namespace fake
+{
+    inline std::vector<FakeEspTimer *> &timers()
+    {
+        static std::vector<FakeEspTimer *> list;
+        return list;
+    }
+
+    // Avance l'heure simulée jusqu'à targetUs en déclenchant chaque timer à son échéance
+    inline void advanceTimersTo(uint64_t targetUs)
+    {
+        for (;;)
+        {
+            FakeEspTimer *next = nullptr;
+            for (size_t i = 0; i < timers().size(); i++)
+            {
+                FakeEspTimer *t = timers()[i];
+                if (t->running && t->nextUs <= targetUs && (next == nullptr || t->nextUs < next->nextUs))
+                    next = t;
+            }
+            if (next == nullptr)
+                break;
+            if (next->nextUs > clock().micros.load())
+                clock().micros.store(next->nextUs);
+            next->running = next->periodic;
+            next->nextUs += next->periodUs;
+            next->args.callback(next->args.arg);
+        }
+        if (targetUs > clock().micros.load())
+            clock().micros.store(targetUs);
+    }
+
+    // Déclenche les timers échus à l'heure simulée courante
+    inline void runTimers()
+    {
+        uint64_t now = clock().micros.load();
+        for (size_t i = 0; i < timers().size(); i++)
+        {
+            FakeEspTimer *t = timers()[i];
+            while (t->running && t->nextUs <= now)
+            {
+                t->running = t->periodic;
+                t->nextUs += t->periodUs;
+                t->args.callback(t->args.arg);
+            }
+        }
+    }
+}
+
+inline int64_t esp_timer_get_time() { return (int64_t)fake::clock().micros.load(); }
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    FakeEspTimer *t = new FakeEspTimer{*args, 0, 0, false, false};
+    fake::timers().push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs)
+{
+    t->periodUs = periodUs;
+    t->nextUs = fake::clock().micros.load() + periodUs;
+    t->periodic = true;
+    t->running = true;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs)
+{
+    t->periodUs = timeoutUs;
+    t->nextUs = fake::clock().micros.load() + timeoutUs;
+    t->periodic = false;
+    t->running = true;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    if (!t->running)
+        return ESP_ERR_INVALID_STATE;
+    t->running = false;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_delete(esp_timer_handle_t t)
+{
+    std::vector<FakeEspTimer *> &list = fake::timers();
+    for (size_t i = 0; i < list.size(); i++)
+        if (list[i] == t)
+            list.erase(list.begin() + i);
+    delete t;
+    return ESP_OK;
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Tâches FreeRTOS simulées
+#ifndef FAKE_FREERTOS_TASK_H
+#define FAKE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct FakeTask
+{
+    TaskFunction_t function;
+    void *arg;
+    const char *name;
+    UBaseType_t priority;
+    BaseType_t core;
+    uint32_t notifications;
+    bool deleted;
+    std::mutex mutex;
+    std::condition_variable wake;
+};
+typedef FakeTask *TaskHandle_t;
+
+namespace fake
+{
+    inline bool &runTasksInThreads()
+    {
+        static bool enabled = true;
+        return enabled;
+    }
+
+    inline FakeTask *&currentTask()
+    {
+        static thread_local FakeTask *task = nullptr;
+        return task;
+    }
+
+    inline std::vector<FakeTask *> &tasks()
+    {
+        static std::vector<FakeTask *> list;
+        return list;
+    }
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t, void *arg,
+                                          UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    FakeTask *t = new FakeTask();
+    t->function = fn;
+    t->arg = arg;
+    t->name = name;
+    t->priority = priority;
+    t->core = core;
+    t->notifications = 0;
+    t->deleted = false;
+    fake::tasks().push_back(t);
+    if (handle)
+        *handle = t;
+    // les tâches qui attendent une notification tournent dans un vrai thread
+    if (fake::runTasksInThreads())
+        std::thread([t]() { fake::currentTask() = t; t->function(t->arg); }).detach();
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t priority,
+                              TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, handle, tskNO_AFFINITY);
+}
+
+inline void vTaskDelete(TaskHandle_t t)
+{
+    if (t)
+        t->deleted = true;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t t)
+{
+    if (t)
+    {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        t->notifications++;
+        t->wake.notify_one();
+    }
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    FakeTask *t = fake::currentTask();
+    if (t == nullptr)
+        return 0;
+    std::unique_lock<std::mutex> lock(t->mutex);
+    auto ready = [t]() { return t->notifications > 0; };
+    if (ticks == portMAX_DELAY)
+        t->wake.wait(lock, ready);
+    else
+        t->wake.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+    uint32_t n = t->notifications;
+    t->notifications = clear ? 0 : (n > 0 ? n - 1 : 0);
+    return n;
+}
+
+inline void vTaskDelay(TickType_t ticks)
+{
+    fake::advanceMillis(ticks);
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+inline TickType_t xTaskGetTickCount() { return (TickType_t)(fake::clock().micros.load() / 1000); }
+inline BaseType_t xPortGetCoreID() { return 1; }
+
+typedef enum
+{
+    eRunning,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+inline const char *pcTaskGetName(TaskHandle_t t) { return t ? t->name : "loopTask"; }
+inline eTaskState eTaskGetState(TaskHandle_t t) { return t == nullptr ? eRunning : t->deleted ? eDeleted : eBlocked; }
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t t) { return t ? t->priority : 1; }
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 2048; }
+
+#endif
@@ -0,0 +1,60 @@
+// tinfl (inflate de la ROM ESP32) simulé au-dessus de zlib
+#ifndef FAKE_ROM_MINIZ_H
+#define FAKE_ROM_MINIZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+#define TINFL_FLAG_PARSE_ZLIB_HEADER 1
+#define TINFL_FLAG_HAS_MORE_INPUT 2
+#define TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF 4
+
+typedef enum
+{
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+typedef struct
+{
+    z_stream zs;
+    bool started;
+} tinfl_decompressor;
+
+#define tinfl_init(r) ((r)->started = false)
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *in, size_t *inSize, uint8_t *,
+                                     uint8_t *outNext, size_t *outSize, uint32_t)
+{
+    if (!r->started)
+    {
+        memset(&r->zs, 0, sizeof(r->zs));
+        if (inflateInit2(&r->zs, -15) != Z_OK)
+            return TINFL_STATUS_FAILED;
+        r->started = true;
+    }
+    r->zs.next_in = const_cast<uint8_t *>(in);
+    r->zs.avail_in = (uInt)*inSize;
+    r->zs.next_out = outNext;
+    r->zs.avail_out = (uInt)*outSize;
+    int ret = inflate(&r->zs, Z_NO_FLUSH);
+    *inSize -= r->zs.avail_in;
+    *outSize -= r->zs.avail_out;
+    if (ret == Z_STREAM_END)
+    {
+        inflateEnd(&r->zs);
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR)
+        return TINFL_STATUS_FAILED;
+    return r->zs.avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+#endif
@@ -0,0 +1,7 @@
+// Capacités de la puce simulée (ESP32)
+#ifndef FAKE_SOC_CAPS_H
+#define FAKE_SOC_CAPS_H
+
+#define SOC_LEDC_CHANNEL_NUM 8
+
+#endif
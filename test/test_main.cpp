@@ -1,9 +1,23 @@
 #include <Arduino.h>
 #include <unity.h>
 #include "../src/utilities.h" // Include the utilities.h from the library
+#include "../src/TimeSeriesStore.h"
+#include "../src/ReportByException.h"
+#include "../src/WorkerPool.h"
+#include "../src/WatchdogRegistry.h"
+#include "../src/CommandEngine.h"
+#include "../src/TimeSync.h"
+#include "../src/mqtt.h"
 
 Logger test_logger;
 
+// Globales attendues par mqtt.h et WiFiManagerOTA.h, définies par le sketch
+// dans une application
+bool wifi_connected = false;
+Logger logger;
+uint32_t mqttCallbackCalls = 0;
+void mqttCallback(char *, byte *, unsigned int) { mqttCallbackCalls++; }
+
 void setUp(void) {
     // set stuff up here
 }
@@ -28,19 +42,860 @@ void test_logger_debug_message_disabled() {
     TEST_PASS(); // Expect it not to crash
 }
 
-void setup() {
-    // NOTE: C++ `main` is replaced by `setup` and `loop` in Arduino.
-    // However, for platformio unit tests, `UNITY_BEGIN()` is often called in `setup`.
-    delay(2000); // Wait for serial monitor to open
+void test_logger_level_filter() {
+    test_logger.setLevel(Logger::WARNING);
+    test_logger.isEnabled_logger = true;
+    TEST_ASSERT_FALSE(test_logger.isLevelEnabled(Logger::INFO));
+    TEST_ASSERT_TRUE(test_logger.isLevelEnabled(Logger::ERROR));
+    test_logger.setLogger(false);
+    TEST_ASSERT_FALSE(test_logger.isLevelEnabled(Logger::CRITICAL));
+    test_logger.setLogger(true);
+}
+
+void test_logger_printf_message() {
+    test_logger.setLevel(Logger::INFO);
+    test_logger.isEnabled_logger = true;
+    test_logger.infof("Formatted %s %d", "message", 42);
+    WLOG_INFOF(test_logger, "Macro %u", 7u);
+    TEST_PASS();
+}
+
+void test_memory_log_sink_keeps_last_lines() {
+    MemoryLogSink<2> history;
+    LogRecord record;
+    for (int i = 0; i < 3; i++) {
+        record.timestamp = i;
+        record.level = Logger::INFO;
+        record.length = snprintf(record.text, sizeof(record.text), "line %d", i);
+        history.write(record);
+    }
+    TEST_ASSERT_EQUAL(2, history.count());
+    TEST_ASSERT_TRUE(history.at(0, record));
+    TEST_ASSERT_EQUAL_STRING("line 1", record.text);
+    TEST_ASSERT_FALSE(history.at(2, record));
+
+    // lecture par numéro : stable quand de nouvelles lignes arrivent
+    TEST_ASSERT_EQUAL(3, history.written());
+    TEST_ASSERT_TRUE(history.get(2, record));
+    TEST_ASSERT_EQUAL_STRING("line 2", record.text);
+    history.write(record);
+    TEST_ASSERT_FALSE(history.get(1, record)); // écrasée
+    TEST_ASSERT_TRUE(history.get(2, record));
+    TEST_ASSERT_EQUAL_STRING("line 2", record.text);
+    TEST_ASSERT_FALSE(history.get(4, record));
+}
+
+void test_binary_log_frame() {
+    // FNV-1a 32 bits de "a" (valeur de référence)
+    TEST_ASSERT_EQUAL_HEX32(0xe40c292c, WIFIOTA_HASH("a"));
+
+    uint8_t frame[32];
+    BinaryLogWriter writer(frame, sizeof(frame));
+    writer.begin(WIFIOTA_HASH("v=%d"), 1000, Logger::INFO);
+    BinaryLogArgs::encodeAll(writer, -2);
+    TEST_ASSERT_EQUAL(18, writer.finish());
+    TEST_ASSERT_EQUAL_HEX8(0xFE, frame[0]);
+    TEST_ASSERT_EQUAL(14, frame[2]); // id, horodatage, niveau, 'i' + int32
+    TEST_ASSERT_EQUAL('i', frame[12]);
+    TEST_ASSERT_FALSE(writer.truncated());
+}
+
+void test_spsc_ring_wraps_and_spans() {
+    SpscRing<int, 4> ring;
+    int in[3] = {1, 2, 3};
+    int out[4];
+    TEST_ASSERT_EQUAL(3, ring.push_n(in, 3));
+    TEST_ASSERT_EQUAL(2, ring.pop_n(out, 2));
+    TEST_ASSERT_EQUAL(3, ring.push_n(in, 3)); // passe la fin du tampon
+    TEST_ASSERT_TRUE(ring.isFull());
+    TEST_ASSERT_FALSE(ring.push(4));
+
+    const int *span;
+    TEST_ASSERT_EQUAL(2, ring.peek(span)); // 3, 1 jusqu'à la fin du tampon
+    TEST_ASSERT_EQUAL(3, span[0]);
+    ring.consume(2);
+    TEST_ASSERT_EQUAL(2, ring.peek(span));
+    TEST_ASSERT_EQUAL(2, span[0]);
+    TEST_ASSERT_EQUAL(3, span[1]);
+}
+
+void test_time_series_downsamples_query() {
+    TimeSeriesStore store;
+    TEST_ASSERT_TRUE(store.begin("/ts_test"));
+    TEST_ASSERT_TRUE(store.addMetric("unit"));
+    TEST_ASSERT_FALSE(store.addMetric("../unit"));
+
+    store.clear();
+
+    // Heure propre au test : indépendante d'une synchronisation NTP
+    uint32_t t0 = 2000000040; // multiple de 60
+    for (uint32_t t = t0; t < t0 + 180; t++)
+        store.record("unit", (float)(t - t0), t);
+    store.flush();
+
+    std::shared_ptr<TimeSeriesStore::Query> q = store.query("unit", t0, t0 + 119, 60);
+    TEST_ASSERT_NOT_NULL(q.get());
+    char json[256] = {0};
+    q->read((uint8_t *)json, sizeof(json) - 1);
+    TEST_ASSERT_NOT_NULL(strstr(json, "[2000000040,0,59,29.5,60],[2000000100,60,119,89.5,60]"));
+
+    // rien n'est supprimé pendant une lecture
+    TEST_ASSERT_FALSE(store.clear(0));
+    q.reset();
+    TEST_ASSERT_TRUE(store.clear());
+}
+
+void test_statistics_welford_and_merge() {
+    Statistics all, first, second;
+    for (uint32_t i = 0; i < 200000; i++) {
+        float v = 10000.0f + ((i & 1) ? 0.5f : -0.5f);
+        all.addValue(v);
+        (i < 50000 ? first : second).addValue(v);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.5, all.getStdDev());
+    first.merge(second);
+    TEST_ASSERT_EQUAL(200000, first.getCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, all.getAverage(), first.getAverage());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, all.getStdDev(), first.getStdDev());
+}
+
+void test_percentiles_estimate_tail() {
+    Percentiles latency;
+    for (uint32_t i = 0; i < 10000; i++)
+        latency.addValue((float)((i * 7919) % 1000)); // 0..999 dans le désordre
+    TEST_ASSERT_FLOAT_WITHIN(10, 500, latency.getP50());
+    TEST_ASSERT_FLOAT_WITHIN(10, 950, latency.getP95());
+    TEST_ASSERT_FLOAT_WITHIN(10, 990, latency.getP99());
+}
+
+void test_windowed_statistics_slides() {
+    WindowedStatistics<int, 4> count;
+    const int values[] = {5, 1, 9, 3, 7, 2};
+    for (int v : values)
+        count.addValue(v);
+    // fenêtre : 9 3 7 2
+    TEST_ASSERT_EQUAL(4, count.getCount());
+    TEST_ASSERT_EQUAL(2, count.getMin());
+    TEST_ASSERT_EQUAL(9, count.getMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 5.25, count.getAverage());
+
+    WindowedStatistics<float, 16> timed(1000);
+    timed.addValue(10.0f, 0);
+    timed.addValue(30.0f, 600);
+    timed.addValue(20.0f, 1200); // 10 a expiré
+    TEST_ASSERT_EQUAL(2, timed.getCount());
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, timed.getMin());
+    TEST_ASSERT_EQUAL(1, timed.expire(1700)); // 30 expire à son tour
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, timed.getMax());
+}
+
+void test_block_and_fixed_point_kernels() {
+    float in[37], blockOut[37];
+    Statistics unit, block;
+    LowPassFilter unitFilter(0.2f), blockFilter(0.2f);
+    for (int i = 0; i < 37; i++) {
+        in[i] = 100.0f + (i % 5) - 0.5f * (i % 3);
+        unit.addValue(in[i]);
+    }
+    block.addValues(in, 10);
+    block.addValues(in + 10, 27);
+    TEST_ASSERT_EQUAL(37, block.getCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, unit.getAverage(), block.getAverage());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, unit.getStdDev(), block.getStdDev());
+    TEST_ASSERT_EQUAL_FLOAT(unit.getMax(), block.getMax());
+
+    blockFilter.filterBlock(in, blockOut, 37);
+    for (int i = 0; i < 37; i++) {
+        float expected = unitFilter.filter(in[i]);
+#if WIFIOTA_USE_ESP_DSP
+        TEST_ASSERT_FLOAT_WITHIN(0.001, expected, blockOut[i]);
+#else
+        TEST_ASSERT_TRUE(expected == blockOut[i]); // même récurrence, bit pour bit
+#endif
+    }
+
+    LowPassFilterQ15 q15(0.01f);
+    int16_t v = 0;
+    for (int i = 0; i < 3000; i++)
+        v = q15.filter(12345); // un état Q15 se bloquerait avant la cible
+    TEST_ASSERT_EQUAL(12345, v);
+
+    StatisticsQ15 stats;
+    const int16_t samples[] = {-32768, 32767, 100, -100, 0};
+    stats.addValues(samples, 5);
+    TEST_ASSERT_EQUAL(-32768, stats.getMin());
+    TEST_ASSERT_EQUAL(32767, stats.getMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, -0.2, stats.getAverage());
+}
+
+void test_filter_pipeline_stages() {
+    // passe-bas 10 Hz à 1 kHz : 200 Hz fortement atténué, continu conservé
+    FilterPipeline<float, Filters::Biquad<float>, Filters::Decimator<float, 4>> lp(
+        Filters::BiquadCoefficients::lowPass(1000, 10), {});
+    float peak = 0;
+    size_t outputs = 0;
+    for (int i = 0; i < 2000; i++) {
+        float v = 1.0f + sinf(2 * M_PI * 200 * i / 1000.0f);
+        if (lp.process(v)) {
+            outputs++;
+            if (i > 1000)
+                peak = fmaxf(peak, fabsf(v - 1.0f));
+        }
+    }
+    TEST_ASSERT_EQUAL(500, outputs);
+    TEST_ASSERT_TRUE(peak < 0.01f);
+    for (int i = 0; i < 4; i++)
+        lp.filter(1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 1.0, lp.getValue());
+
+    // médiane 3 points en Q15 : le pic isolé disparaît
+    FilterPipeline<int16_t, Filters::Median<int16_t, 3>, Filters::Ema<int16_t>> spikes({}, Filters::Ema<int16_t>(1.0f));
+    const int16_t in[] = {100, 100, 30000, 100, 100};
+    int16_t out[5];
+    TEST_ASSERT_EQUAL(5, spikes.processBlock(in, out, 5));
+    TEST_ASSERT_EQUAL(100, out[3]);
+    TEST_ASSERT_EQUAL(100, out[4]);
+}
+
+void test_report_by_exception_deadband() {
+    String last;
+    uint32_t messages = 0;
+    ReportByException rbe([&](const String &topic, const String &payload) {
+        last = topic + " " + payload;
+        messages++;
+        return true;
+    }, "unit");
+    int ch = rbe.addChannel("temp", 0.5f, 0, 1); // pas de battement
+    TEST_ASSERT_EQUAL(-1, rbe.addChannel("temp", 1.0f));
+
+    const float values[] = {20.0f, 20.1f, 20.4f, 20.6f, 20.7f, 19.9f};
+    for (float v : values)
+        rbe.update(ch, v);
+    TEST_ASSERT_EQUAL(3, messages); // 20.0, 20.6, 19.9
+    TEST_ASSERT_EQUAL_STRING("unit/temp {\"value\":19.9,\"reason\":\"change\",\"suppressed\":1}", last.c_str());
+    TEST_ASSERT_EQUAL(3, rbe.getStats("temp")->suppressed);
+    TEST_ASSERT_EQUAL(3, rbe.getStats(ch)->changes);
+}
+
+void test_task_scheduler_orders_deadlines() {
+    TaskScheduler scheduler;
+    String order;
+    TaskScheduler::Handle late = scheduler.after(30, [&order] { order += "c"; });
+    scheduler.after(10, [&order] { order += "a"; });
+    TaskScheduler::Handle tick = scheduler.every(20, [&order] { order += "b"; }, "tick");
+    TEST_ASSERT_EQUAL(3, scheduler.size());
+
+    delay(35);
+    scheduler.run();
+    TEST_ASSERT_EQUAL_STRING("abc", order.c_str());
+    TEST_ASSERT_FALSE(scheduler.isScheduled(late));
+    TEST_ASSERT_TRUE(scheduler.isScheduled(tick));
+    TEST_ASSERT_TRUE(scheduler.timeUntilNext() <= 20);
+
+    // intervalle nul : une exécution par run(), annulation depuis la tâche
+    int runs = 0;
+    TaskScheduler::Handle self;
+    self = scheduler.every(0, [&] { if (++runs == 2) scheduler.cancel(self); });
+    scheduler.run();
+    scheduler.run();
+    scheduler.run();
+    TEST_ASSERT_EQUAL(2, runs);
+
+    TEST_ASSERT_TRUE(scheduler.cancel(String("tick")));
+    TEST_ASSERT_EQUAL(0, scheduler.size());
+    TEST_ASSERT_EQUAL(TaskScheduler::NO_DEADLINE, scheduler.timeUntilNext());
+}
+
+void test_task_scheduler_profiles_overruns() {
+    TaskScheduler scheduler;
+    uint32_t work = 300;
+    TaskScheduler::Handle control = scheduler.every(10, [&work] { delayMicroseconds(work); }, "control");
+    scheduler.setBudget(control, 1000);
+    uint32_t overruns = 0;
+    scheduler.onOverrun([&overruns](const char *, uint32_t, uint32_t) { overruns++; });
+
+    for (int i = 0; i < 4; i++) {
+        delay(10);
+        scheduler.run();
+    }
+    work = 2000;
+    delay(10);
+    scheduler.run();
+
+    const TaskScheduler::TaskProfile *p = scheduler.getProfile("control");
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL(5, p->runs);
+    TEST_ASSERT_EQUAL(1, p->overruns);
+    TEST_ASSERT_EQUAL(1, overruns);
+    TEST_ASSERT_TRUE(p->minUs >= 300 && p->maxUs >= 2000);
+    TEST_ASSERT_EQUAL(4, p->histogram[1]); // ≤ 500 µs
+    TEST_ASSERT_TRUE(scheduler.statsJSON().startsWith("{\"control\":{\"runs\":5,"));
+
+    // Retard mesuré juste avant l'appel, après les tâches précédentes
+    TaskScheduler chained;
+    chained.every(10, [] { delayMicroseconds(4000); }, "slow");
+    chained.every(10, [] {}, "next");
+    delay(10);
+    chained.run();
+    TEST_ASSERT_EQUAL(4, chained.getProfile("next")->maxLateMs);
+}
+
+void test_worker_pool_runs_jobs_in_parallel() {
+    static WorkerPool pool; // les workers vivent jusqu'au redémarrage
+    uint32_t inlineRuns = 0;
+    pool.submit([&inlineRuns] { inlineRuns++; }); // pas encore de worker : sur place
+    TEST_ASSERT_EQUAL(1, inlineRuns);
+
+    TEST_ASSERT_TRUE(pool.begin(2));
+    static uint16_t data[256];
+    for (int i = 0; i < 256; i++)
+        data[i] = i;
+    uint32_t partial[4] = {};
+    for (int j = 0; j < 4; j++) {
+        TEST_ASSERT_TRUE(pool.submit([&partial, j] {
+            for (int k = j * 64; k < (j + 1) * 64; k++)
+                partial[j] += data[k];
+        }, j % 2));
+    }
+    TEST_ASSERT_TRUE(pool.waitIdle(1000));
+    TEST_ASSERT_EQUAL(32640, partial[0] + partial[1] + partial[2] + partial[3]);
+    TEST_ASSERT_EQUAL(4, pool.getExecuted(0) + pool.getExecuted(1));
+    TEST_ASSERT_EQUAL(0, pool.pending());
+}
+
+void test_watchdog_registry_post_mortem() {
+    SoftwareWatchdog sensor("sensor", 50);
+    SoftwareWatchdog network("network", 10000);
+    {
+        WatchdogRegistry registry;
+        registry.watch(sensor);
+        registry.watch(network);
+        registry.setRestart(false);
+        TEST_ASSERT_TRUE(registry.begin(0, 0, false)); // vérification par check() seulement
+        sensor.enable();
+        network.enable();
+        for (int i = 0; i < 3; i++) {
+            registry.loopTick();
+            delay(5);
+        }
+        TEST_ASSERT_FALSE(registry.check());
+        delay(60);
+        network.feed();
+        TEST_ASSERT_TRUE(registry.check());
+    }
+
+    // démarrage suivant : le post-mortem est relu une seule fois
+    WatchdogRegistry nextBoot;
+    nextBoot.begin(0, 0, false);
+    TEST_ASSERT_TRUE(nextBoot.hasPostMortem());
+    const WatchdogRegistry::PostMortem &pm = nextBoot.getPostMortem();
+    TEST_ASSERT_EQUAL_STRING("sensor", pm.culprit);
+    TEST_ASSERT_EQUAL(2, pm.watchdogCount);
+    TEST_ASSERT_TRUE(pm.watchdogs[0].sinceFeedMs >= 60);
+    TEST_ASSERT_TRUE(pm.watchdogs[1].sinceFeedMs < 10);
+    TEST_ASSERT_EQUAL(3, pm.loop.iterations);
+    TEST_ASSERT_TRUE(nextBoot.postMortemJSON().indexOf("\"cause\":\"watchdog\"") > 0);
+
+    WatchdogRegistry later;
+    later.begin(0, 0, false);
+    TEST_ASSERT_FALSE(later.hasPostMortem());
+}
+
+static int32_t commandLevel;
+static float commandRamp;
+
+static void cmdLed(const CommandEngine::Args &args, Print &out) {
+    commandLevel = args.getInt(0);
+    commandRamp = args.getFloat(1, -1.0f);
+    out.print(args.getBool(2, true) ? "on " : "off ");
+    out.print(commandLevel);
+}
+
+static void cmdSay(const CommandEngine::Args &args, Print &out) {
+    out.print(args.getString(0));
+    out.print("|");
+    out.print(args.getString(1));
+}
+
+void test_command_engine_typed_args() {
+    static const CommandEngine::Command COMMANDS[] = {
+        WIFIOTA_COMMAND("led", "i|fb", cmdLed, "niveau, rampe, état"),
+        WIFIOTA_COMMAND("say", "sr", cmdSay, nullptr),
+    };
+    CommandEngine engine(COMMANDS, 2);
+    CommandReply reply;
 
+    char line1[] = "  LED 0x80 ";
+    TEST_ASSERT_EQUAL(CommandEngine::OK, engine.execute(line1, reply));
+    TEST_ASSERT_EQUAL(128, commandLevel);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, commandRamp);
+    TEST_ASSERT_EQUAL_STRING("on 128", reply.c_str());
+
+    reply.clear();
+    const char payload[] = "led 12 0.5 off"; // charge utile MQTT, sans '\0'
+    TEST_ASSERT_EQUAL(CommandEngine::OK, engine.execute(payload, sizeof(payload) - 1, reply));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, commandRamp);
+    TEST_ASSERT_EQUAL_STRING("off 12", reply.c_str());
+
+    reply.clear();
+    char line2[] = "say \"hello world\" rest of  line ";
+    TEST_ASSERT_EQUAL(CommandEngine::OK, engine.execute(line2, reply));
+    TEST_ASSERT_EQUAL_STRING("hello world|rest of  line", reply.c_str());
+
+    char bad[] = "led ten";
+    TEST_ASSERT_EQUAL(CommandEngine::BAD_ARGS, engine.execute(bad, reply));
+    char unknown[] = "reboot";
+    TEST_ASSERT_EQUAL(CommandEngine::UNKNOWN, engine.execute(unknown, reply));
+    reply.clear();
+    for (const char *c = "help\n"; *c; c++)
+        engine.feed(*c, reply);
+    TEST_ASSERT_EQUAL_STRING("led <int> [float] [on|off] - niveau, rampe, état\r\nsay <word> <text...>\r\n", reply.c_str());
+}
+
+void test_pattern_player_runs_on_timer() {
+    PatternPlayer player;
+    TEST_ASSERT_TRUE(player.begin(LED_BUILTIN));
+    player.play(Patterns::HEARTBEAT);
+    delay(50);
+    TEST_ASSERT_EQUAL(255, player.getLevel());
+    delay(100); // 150 ms : pause entre les deux battements
+    TEST_ASSERT_EQUAL(0, player.getLevel());
+    delay(100); // 250 ms : second battement
+    TEST_ASSERT_EQUAL(255, player.getLevel());
+    delay(2000); // 2250 ms : second battement du cycle suivant
+    TEST_ASSERT_EQUAL(255, player.getLevel());
+
+    // rampe : PULSE au milieu de l'étape 254 -> 244
+    player.stop();
+    delay(10);
+    TEST_ASSERT_EQUAL(0, player.getLevel());
+    player.play(Patterns::PULSE);
+    delay(562);
+    TEST_ASSERT_INT_WITHIN(6, 249, player.getLevel());
+
+    // sans répétition : reste sur la dernière étape
+    player.play(Patterns::BLINK_FAST, false);
+    delay(500);
+    TEST_ASSERT_FALSE(player.isPlaying());
+    TEST_ASSERT_EQUAL(0, player.getLevel());
+}
+
+static uint32_t timeSyncCalls;
+
+void test_time_sync_cached_iso8601() {
+    char ts[TimeSync::ISO8601_SIZE];
+    struct timeval tv = {1714566896, 789000};
+    TEST_ASSERT_EQUAL(24, TimeSync::formatIso8601(tv, ts, sizeof(ts), true));
+    TEST_ASSERT_EQUAL_STRING("2024-05-01T12:34:56.789Z", ts);
+    tv.tv_sec += 3; // même minute : secondes mises à jour en place
+    tv.tv_usec = 5000;
+    TimeSync::formatIso8601(tv, ts, sizeof(ts), true);
+    TEST_ASSERT_EQUAL_STRING("2024-05-01T12:34:59.005Z", ts);
+    tv.tv_sec += 1;
+    TimeSync::formatIso8601(tv, ts, sizeof(ts), true);
+    TEST_ASSERT_EQUAL_STRING("2024-05-01T12:35:00.005Z", ts);
+    tv.tv_sec -= 3600;
+    TimeSync::formatIso8601(tv, ts, sizeof(ts), true);
+    TEST_ASSERT_EQUAL_STRING("2024-05-01T11:35:00.005Z", ts);
+    TEST_ASSERT_EQUAL(0, TimeSync::formatIso8601(tv, ts, 24, true));
+
+    // heure locale : toujours avec son décalage
+    TEST_ASSERT_EQUAL(29, TimeSync::formatIso8601(tv, ts, sizeof(ts)));
+    TEST_ASSERT_TRUE(ts[23] == '+' || ts[23] == '-');
+
+    char ms[TimeSync::EPOCH_MS_SIZE];
+    TEST_ASSERT_EQUAL(13, TimeSync::formatEpochMs(1714566896789LL, ms, sizeof(ms)));
+    TEST_ASSERT_EQUAL_STRING("1714566896789", ms);
+
+    TimeSync::onSync([](const struct timeval &) { timeSyncCalls++; });
+    uint32_t syncs = TimeSync::getSyncCount();
+    TimeSync::syncNotification(&tv); // comme le client SNTP
+    TEST_ASSERT_TRUE(TimeSync::isSynced());
+    TEST_ASSERT_EQUAL(syncs + 1, TimeSync::getSyncCount());
+    TEST_ASSERT_EQUAL(1, timeSyncCalls);
+}
+
+static void putNtpTime(uint8_t *p, int64_t epochUs) {
+    uint32_t seconds = (uint32_t)(epochUs / 1000000 + 2208988800LL);
+    uint32_t fraction = (uint32_t)(((uint64_t)(epochUs % 1000000) << 32) / 1000000);
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(seconds >> (24 - 8 * i));
+        p[4 + i] = (uint8_t)(fraction >> (24 - 8 * i));
+    }
+}
+
+void test_time_sync_drift_and_rtc_restore() {
+    // horloge locale en retard de 20 ppm : 36 ms par demi-heure
+    const int64_t base = 1714566896000000LL;
+    TimeSync::recordSync(base, 1000000);
+    TimeSync::recordSync(base + 1800036000LL, 1000000 + 1800000000LL);
+    TEST_ASSERT_EQUAL(36000, (int32_t)TimeSync::getOffsetUs());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, TimeSync::getDriftPpm());
+    TEST_ASSERT_EQUAL(12500, TimeSync::getSyncIntervalS()); // 250 ms / 20 ppm
+    // saut d'heure (réglage manuel) : pas une mesure de dérive
+    TimeSync::recordSync(base + 3600072000LL + 5000000, 1000000 + 3600000000LL);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, TimeSync::getDriftPpm());
+
+    // heure gardée en RTC, retrouvée après 90 s de deep sleep
+    struct timeval tv;
+    TimeSync::save(base, 5000000, 20.0f);
+    TEST_ASSERT_TRUE(TimeSync::restoredTime(95000000, tv));
+    TEST_ASSERT_EQUAL(1714566986, (int32_t)tv.tv_sec);
+    TEST_ASSERT_FALSE(TimeSync::restoredTime(1000, tv)); // compteur RTC remis à zéro
+    TimeSync::rtcTime.epochUs++;                         // mémoire perdue
+    TEST_ASSERT_FALSE(TimeSync::restoredTime(95000000, tv));
+
+    // réponse NTP : serveur en avance de 2 s, 40 ms d'aller-retour
+    uint8_t reply[48] = {0x24, 2};
+    putNtpTime(reply + 32, base + 2020000);
+    putNtpTime(reply + 40, base + 2021000);
+    int64_t offset, delayUs;
+    TEST_ASSERT_TRUE(TimeSync::parseNtpReply(reply, sizeof(reply), base, base + 41000, offset, delayUs));
+    TEST_ASSERT_INT_WITHIN(2, 2000000, (int32_t)offset);
+    TEST_ASSERT_INT_WITHIN(2, 40000, (int32_t)delayUs);
+    reply[1] = 0; // kiss-o'-death
+    TEST_ASSERT_FALSE(TimeSync::parseNtpReply(reply, sizeof(reply), base, base + 41000, offset, delayUs));
+}
+
+#ifndef ARDUINO
+// Machine hôte seulement : horloge, Wi-Fi et broker simulés (test/fakes)
+#include <zlib.h> // flux gzip des tests OTA
+
+// Update est global : ElegantOTA ou un autre OTAUpdater peut écrire en même temps
+void test_native_ota_updater_keeps_foreign_update() {
+    TEST_ASSERT_TRUE(Update.begin(1000));
+    OTAUpdater updater;
+    TEST_ASSERT_FALSE(updater.begin());
+    TEST_ASSERT_EQUAL_STRING("Mise à jour déjà en cours", updater.getError().c_str());
+    updater.abort();
+    TEST_ASSERT_TRUE(Update.isRunning());
+    Update.abort();
+
+    // l'autre écriture commence entre begin() et la détection du format
+    TEST_ASSERT_TRUE(updater.begin());
+    TEST_ASSERT_TRUE(Update.begin(1000));
+    uint8_t image[16] = {ESP_IMAGE_HEADER_MAGIC};
+    TEST_ASSERT_FALSE(updater.write(image, sizeof(image)));
+    TEST_ASSERT_TRUE(updater.hasFailed());
+    TEST_ASSERT_TRUE(Update.isRunning());
+    Update.abort();
+}
+
+// ─── Flux OTA : patchs delta et décompression ───
+
+typedef std::vector<uint8_t> Bytes;
+
+static void putLE32(Bytes &out, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void putSha(Bytes &out, const Bytes &data) {
+    Sha256 sha;
+    uint8_t digest[32];
+    sha.begin();
+    sha.update(data.data(), data.size());
+    sha.finish(digest);
+    out.insert(out.end(), digest, digest + 32);
+}
+
+// Image de firmware reconnaissable, motif de période 37 après l'octet magique
+static Bytes otaImage(size_t size, uint8_t seed) {
+    Bytes image(size);
+    for (size_t i = 0; i < size; i++)
+        image[i] = (uint8_t)((i % 37) * 7 + seed);
+    image[0] = ESP_IMAGE_HEADER_MAGIC;
+    return image;
+}
+
+// Patch WDLT (tools/make_delta.py) : base[0:split] modifiée, insertion, puis base[split:]
+static Bytes makeDelta(const Bytes &base, const Bytes &target, size_t split, size_t inserted) {
+    Bytes patch = {'W', 'D', 'L', 'T'};
+    putLE32(patch, base.size());
+    putSha(patch, base);
+    putLE32(patch, target.size());
+    putSha(patch, target);
+    size_t tail = base.size() - split;
+    // bloc 1 : diff sur split octets, puis les octets insérés
+    putLE32(patch, split);
+    putLE32(patch, inserted);
+    putLE32(patch, 0);
+    for (size_t i = 0; i < split; i++)
+        patch.push_back((uint8_t)(target[i] - base[i]));
+    patch.insert(patch.end(), target.begin() + split, target.begin() + split + inserted);
+    // bloc 2 : diff sur le reste de la base
+    putLE32(patch, tail);
+    putLE32(patch, 0);
+    putLE32(patch, 0);
+    for (size_t i = 0; i < tail; i++)
+        patch.push_back((uint8_t)(target[split + inserted + i] - base[split + i]));
+    return patch;
+}
+
+static Bytes gzipOf(const Bytes &data) {
+    z_stream zs = {};
+    deflateInit2(&zs, 9, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY); // 15 + 16 : enveloppe gzip
+    Bytes out(deflateBound(&zs, data.size()));
+    zs.next_in = const_cast<uint8_t *>(data.data());
+    zs.avail_in = data.size();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+// Flux heatshrink (tools/compress_fw.py), fenêtre 8 bits, lookahead 4 bits :
+// références arrière de distance period là où les octets se répètent,
+// littéraux ailleurs (period 0 : uniquement des littéraux)
+static Bytes heatshrinkOf(const Bytes &data, size_t period) {
+    Bytes out = {'H', 'S', 8, 4};
+    uint32_t acc = 0;
+    int bits = 0;
+    auto put = [&](uint32_t value, int count) {
+        acc = (acc << count) | value;
+        bits += count;
+        while (bits >= 8) {
+            bits -= 8;
+            out.push_back((uint8_t)(acc >> bits));
+        }
+        acc &= (1u << bits) - 1;
+    };
+    size_t i = 0;
+    while (i < data.size()) {
+        size_t len = 0;
+        while (period > 0 && i >= period && len < 16 && i + len < data.size() &&
+               data[i + len] == data[i + len - period])
+            len++;
+        if (len < 2) {
+            put(1, 1);
+            put(data[i++], 8);
+        } else {
+            put(0, 1);
+            put(period - 1, 8);
+            put(len - 1, 4);
+            i += len;
+        }
+    }
+    if (bits > 0)
+        out.push_back((uint8_t)(acc << (8 - bits)));
+    return out;
+}
+
+// Envoi en blocs de tailles irrégulières, comme un upload HTTP ou un téléchargement
+static bool otaFeed(OTAUpdater &updater, const Bytes &stream, size_t truncate = 0) {
+    static const size_t SIZES[] = {1, 3, 7, 250, 13, 1024, 2, 511};
+    size_t end = stream.size() - truncate;
+    updater.begin(stream.size(), "test");
+    for (size_t pos = 0, k = 0; pos < end; k++) {
+        size_t n = std::min(SIZES[k % 8], end - pos);
+        if (!updater.write(stream.data() + pos, n))
+            return false;
+        pos += n;
+    }
+    return updater.end();
+}
+
+void test_native_ota_delta_and_compressed_streams() {
+    Bytes base = otaImage(3000, 1);
+    Bytes target = base;
+    for (size_t i = 100; i < 1000; i += 97)
+        target[i] ^= 0x5A;
+    Bytes inserted = {'v', '1', '.', '0', '.', '1'};
+    target.insert(target.begin() + 1000, inserted.begin(), inserted.end());
+    target[2500] = 0;
+    fake::runningImage() = base;
+    Bytes patch = makeDelta(base, target, 1000, inserted.size());
+
+    OTAUpdater updater;
+    TEST_ASSERT_TRUE(otaFeed(updater, patch));
+    TEST_ASSERT_EQUAL(OTAUpdater::DELTA, updater.getMode());
+    TEST_ASSERT_TRUE(Update.image == target);
+
+    // même patch, compressé
+    TEST_ASSERT_TRUE(otaFeed(updater, gzipOf(patch)));
+    TEST_ASSERT_TRUE(Update.image == target);
+    TEST_ASSERT_TRUE(otaFeed(updater, heatshrinkOf(patch, 0)));
+    TEST_ASSERT_TRUE(Update.image == target);
+
+    // image complète compressée ; les références arrière traversent les blocs de sortie
+    Bytes image = otaImage(5000, 3);
+    TEST_ASSERT_TRUE(otaFeed(updater, gzipOf(image)));
+    TEST_ASSERT_EQUAL(OTAUpdater::RAW, updater.getMode());
+    TEST_ASSERT_TRUE(Update.image == image);
+    TEST_ASSERT_TRUE(otaFeed(updater, heatshrinkOf(image, 37)));
+    TEST_ASSERT_TRUE(Update.image == image);
+
+    // le firmware en cours n'est pas la base du patch : rien n'est écrit
+    fake::runningImage()[10] ^= 1;
+    TEST_ASSERT_FALSE(otaFeed(updater, patch));
+    TEST_ASSERT_NOT_NULL(strstr(updater.getError().c_str(), "base du patch"));
+    TEST_ASSERT_FALSE(Update.isRunning());
+    fake::runningImage() = base;
+
+    // flux tronqués
+    TEST_ASSERT_FALSE(otaFeed(updater, patch, 5));
+    TEST_ASSERT_EQUAL_STRING("Patch delta incomplet", updater.getError().c_str());
+    TEST_ASSERT_FALSE(Update.isRunning());
+    // gzip : coupé dans les données deflate (le CRC final n'est pas lu, Update.end() vérifie l'image)
+    TEST_ASSERT_FALSE(otaFeed(updater, gzipOf(image), 20));
+    TEST_ASSERT_EQUAL_STRING("Flux compressé tronqué", updater.getError().c_str());
+    TEST_ASSERT_FALSE(otaFeed(updater, heatshrinkOf(patch, 0), 40));
+    TEST_ASSERT_EQUAL_STRING("Flux compressé tronqué", updater.getError().c_str());
+
+    // patch altéré : l'image reconstruite ne correspond pas à l'empreinte annoncée
+    Bytes corrupted = patch;
+    corrupted[200] ^= 1;
+    TEST_ASSERT_FALSE(otaFeed(updater, corrupted));
+    TEST_ASSERT_NOT_NULL(strstr(updater.getError().c_str(), "empreinte"));
+
+    // écriture flash refusée
+    Update.fakeFailAfter = 2048;
+    TEST_ASSERT_FALSE(otaFeed(updater, image));
+    TEST_ASSERT_TRUE(updater.hasFailed());
+    TEST_ASSERT_FALSE(Update.isRunning());
+    Update.fakeFailAfter = (size_t)-1;
+}
+
+static void cmdEcho(const CommandEngine::Args &args, Print &out) {
+    out.print(args.getString(0));
+}
+
+void test_native_mqtt_backoff_and_commands() {
+    wifi_connected = true;
+    MQTTController mqtt("broker.local", 1883, "", "");
+    PubSubClient &broker = *fake::pubSubClients().back();
+    broker.fakeConnectResult = false;
+    mqtt.setPublishTopic("home/dev1");
+    mqtt.setSubscribeTopic("home/dev1/cmd");
+    fake::setMillis(100000);
+    mqtt.begin(); // première tentative immédiate
+    mqtt.loop();  // la boucle réessaie, puis double l'attente : 4 s, 8 s...
+    TEST_ASSERT_EQUAL(2, broker.connectAttempts);
+    fake::advanceMillis(3000);
+    mqtt.loop();
+    TEST_ASSERT_EQUAL(2, broker.connectAttempts);
+    fake::advanceMillis(1001);
+    mqtt.loop();
+    TEST_ASSERT_EQUAL(3, broker.connectAttempts);
+    broker.fakeConnectResult = true;
+    fake::advanceMillis(7000);
+    mqtt.loop();
+    TEST_ASSERT_FALSE(mqtt.isConnected());
+    fake::advanceMillis(1001);
+    mqtt.loop();
+    TEST_ASSERT_EQUAL(4, broker.connectAttempts);
+    TEST_ASSERT_TRUE(mqtt.isConnected());
+
+    static const CommandEngine::Command COMMANDS[] = {
+        WIFIOTA_COMMAND("echo", "r", cmdEcho, "répète le texte"),
+    };
+    CommandEngine engine(COMMANDS, 1);
+    mqtt.setCommandEngine(&engine);
+    broker.fakeReceive("home/dev1/cmd", "echo echo bonjour");
+    TEST_ASSERT_EQUAL_STRING("home/dev1/cmd/reply", broker.published.back().topic.c_str());
+    TEST_ASSERT_FALSE(mqtt.getSubscribeTopic() == broker.published.back().topic.c_str());
+    TEST_ASSERT_EQUAL_STRING("echo bonjour", broker.published.back().payload.c_str());
+    TEST_ASSERT_FALSE(mqtt.setCommandReplyTopic("home/dev1/cmd"));
+
+    // réponse renvoyée par le broker (abonnement avec joker) : ignorée
+    size_t replies = broker.published.size();
+    broker.fakeReceive("home/dev1/cmd/reply", "echo bonjour");
+    TEST_ASSERT_EQUAL(replies, broker.published.size());
+    TEST_ASSERT_EQUAL(0, mqttCallbackCalls);
+
+    // ni commande ni JSON : remis à mqttCallback
+    size_t published = broker.published.size();
+    broker.fakeReceive("home/dev1/cmd", "inconnue 1");
+    broker.fakeReceive("home/dev1/cmd", "   ");
+    char tooLong[WIFIOTA_COMMAND_LINE_SIZE + 1];
+    memset(tooLong, 'x', WIFIOTA_COMMAND_LINE_SIZE);
+    tooLong[WIFIOTA_COMMAND_LINE_SIZE] = '\0';
+    broker.fakeReceive("home/dev1/cmd", tooLong);
+    TEST_ASSERT_EQUAL(3, mqttCallbackCalls);
+    TEST_ASSERT_EQUAL(published, broker.published.size());
+
+    // OTA sans empreinte : refusée, erreur publiée en JSON
+    broker.fakeReceive("home/dev1/cmd", "{\"cmd\":\"ota\",\"url\":\"http://fw.local/v2.bin\"}");
+    TEST_ASSERT_EQUAL_STRING("home/dev1/ota", broker.published.back().topic.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"state\":\"failed\",\"error\":\"SHA-256 manquant\"}",
+                             broker.published.back().payload.c_str());
+    TEST_ASSERT_FALSE(mqtt.isUpdating());
+
+    // la commande ne fait que programmer le téléchargement : connexion au loop() suivant
+    broker.fakeReceive("home/dev1/cmd", "{\"cmd\":\"ota\",\"url\":\"http://fw.local/absent.bin\",\"sha256\":\""
+                                        "0000000000000000000000000000000000000000000000000000000000000000\"}");
+    TEST_ASSERT_EQUAL_STRING("{\"state\":\"connecting\"}", broker.published.back().payload.c_str());
+    TEST_ASSERT_TRUE(mqtt.isUpdating());
+    mqtt.loop();
+    TEST_ASSERT_EQUAL_STRING("{\"state\":\"failed\",\"error\":\"HTTP 404\"}", broker.published.back().payload.c_str());
+    TEST_ASSERT_FALSE(mqtt.isUpdating());
+
+    // lot de logs gardé tant que la publication échoue
+    TEST_ASSERT_TRUE(mqtt.enableRemoteLogs(Logger::WARNING));
+    test_logger.error("capteur absent");
+    broker.fakePublishResult = false;
+    fake::advanceMillis(2001);
+    mqtt.loop();
+    TEST_ASSERT_EQUAL(1, mqtt.getLogSink().getFailures());
+    broker.fakePublishResult = true;
+    fake::advanceMillis(2001);
+    mqtt.loop();
+    TEST_ASSERT_EQUAL(1, mqtt.getLogSink().getBatches());
+    TEST_ASSERT_EQUAL_STRING("home/dev1/logs", broker.published.back().topic.c_str());
+    TEST_ASSERT_NOT_NULL(strstr(broker.published.back().payload.c_str(), "capteur absent"));
+    mqtt.disableRemoteLogs();
+    wifi_connected = false;
+}
+#endif
+
+int runUnityTests() {
     UNITY_BEGIN();
 
     RUN_TEST(test_logger_info_message);
     RUN_TEST(test_logger_debug_message_disabled);
+    RUN_TEST(test_logger_level_filter);
+    RUN_TEST(test_logger_printf_message);
+    RUN_TEST(test_memory_log_sink_keeps_last_lines);
+    RUN_TEST(test_binary_log_frame);
+    RUN_TEST(test_spsc_ring_wraps_and_spans);
+    RUN_TEST(test_time_series_downsamples_query);
+    RUN_TEST(test_statistics_welford_and_merge);
+    RUN_TEST(test_percentiles_estimate_tail);
+    RUN_TEST(test_windowed_statistics_slides);
+    RUN_TEST(test_block_and_fixed_point_kernels);
+    RUN_TEST(test_filter_pipeline_stages);
+    RUN_TEST(test_report_by_exception_deadband);
+    RUN_TEST(test_task_scheduler_orders_deadlines);
+    RUN_TEST(test_task_scheduler_profiles_overruns);
+    RUN_TEST(test_worker_pool_runs_jobs_in_parallel);
+    RUN_TEST(test_watchdog_registry_post_mortem);
+    RUN_TEST(test_command_engine_typed_args);
+    RUN_TEST(test_pattern_player_runs_on_timer);
+    RUN_TEST(test_time_sync_cached_iso8601);
+    RUN_TEST(test_time_sync_drift_and_rtc_restore);
+#ifndef ARDUINO
+    RUN_TEST(test_native_ota_updater_keeps_foreign_update);
+    RUN_TEST(test_native_ota_delta_and_compressed_streams);
+    RUN_TEST(test_native_mqtt_backoff_and_commands);
+#endif
+
+    return UNITY_END();
+}
 
-    UNITY_END(); // stop unit testing
+#ifdef ARDUINO
+void setup() {
+    delay(2000); // Wait for serial monitor to open
+    runUnityTests();
 }
 
 void loop() {
     // Nothing to do here.
 }
+#else
+// pio test -e native
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Compare deux résultats de bench/core et signale les régressions.
+
+Usage:
+    python3 tools/bench_compare.py v1.2.json v1.3.json
+    python3 tools/bench_compare.py --threshold 5 avant.json apres.json
+    pio device monitor | python3 tools/bench_compare.py v1.2.json -
+
+Les fichiers sont le JSON écrit par bench/core/host_bench.cpp, ou la sortie
+série de bench/core/target_bench.cpp (le bloc entre ---BEGIN--- et ---END---
+est extrait ; la lecture s'arrête à ---END---, sans attendre la fin du
+flux). Les deux résultats doivent venir de la même cible : des ns de
+l'hôte ne se comparent pas à des cycles de l'ESP32. Chaque per_op est déjà
+le meilleur de plusieurs répétitions (REPEATS dans bench/core/BenchCases.h).
+
+Une régression est un per_op plus lent de plus de --threshold %, ou une
+allocation de plus par opération. Code de sortie 1 s'il y en a une.
+"""
+
+import argparse
+import json
+import sys
+
+
+def read_block(stream):
+    """Lit ligne par ligne jusqu'à ---END--- : le moniteur série ne ferme jamais l'entrée."""
+    lines = []
+    for line in iter(stream.readline, ""):
+        marker = line.strip()
+        if marker == "---BEGIN---":
+            lines = []  # ce qui précède est le journal de démarrage
+        elif marker == "---END---":
+            break
+        else:
+            lines.append(line)
+    return "".join(lines)
+
+
+def load(path):
+    if path == "-":
+        text = read_block(sys.stdin)
+    else:
+        with open(path, encoding="utf-8") as f:
+            text = read_block(f)
+    return json.loads(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=10.0, help="écart toléré sur per_op, en %% (10)")
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+    if before.get("unit") != after.get("unit") or before.get("target") != after.get("target"):
+        sys.exit("Cibles différentes : %s (%s) / %s (%s)" % (
+            before.get("target"), before.get("unit"), after.get("target"), after.get("unit")))
+
+    old = {r["name"]: r for r in before["results"]}
+    regressions = 0
+    print("%-28s %12s %12s %8s %14s" % ("cas", "avant", "après", "écart", "allocs/op"))
+    for r in after["results"]:
+        name = r["name"]
+        if name not in old:
+            print("%-28s %12s %12.2f %8s %14.3f" % (name, "-", r["per_op"], "nouveau", r["allocs_per_op"]))
+            continue
+        o = old[name]
+        change = (r["per_op"] - o["per_op"]) * 100.0 / o["per_op"] if o["per_op"] else 0.0
+        slower = change > args.threshold
+        allocs = r["allocs_per_op"] - o["allocs_per_op"] >= 1.0
+        flag = "  <-- régression" if slower or allocs else ""
+        regressions += bool(flag)
+        print("%-28s %12.2f %12.2f %+7.1f%% %6.3f->%-6.3f%s" % (
+            name, o["per_op"], r["per_op"], change, o["allocs_per_op"], r["allocs_per_op"], flag))
+
+    print("%d régression(s), unité : %s par opération" % (regressions, after.get("unit")))
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Compresse un firmware (ou un patch delta) pour l'envoi OTA.
+
+Usage:
+    python3 tools/compress_fw.py firmware.bin firmware.bin.gz
+    python3 tools/compress_fw.py --heatshrink firmware.bin firmware.bin.hs
+
+gzip utilise la fenêtre deflate de 32 Ko (inflate de la ROM ESP32).
+heatshrink n'utilise que 2**window octets de RAM sur l'appareil
+(2 Ko par défaut) pour un taux de compression un peu moins bon.
+Le flux heatshrink est précédé de l'en-tête "HS" + window + lookahead
+attendu par HeatshrinkDecoder (src/OTADecompress.h).
+"""
+
+import argparse
+import gzip
+import sys
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.bits = 0
+
+    def write(self, value, count):
+        self.acc = (self.acc << count) | value
+        self.bits += count
+        while self.bits >= 8:
+            self.bits -= 8
+            self.out.append((self.acc >> self.bits) & 0xFF)
+        self.acc &= (1 << self.bits) - 1
+
+    def flush(self):
+        if self.bits:
+            self.out.append((self.acc << (8 - self.bits)) & 0xFF)
+            self.acc = self.bits = 0
+        return bytes(self.out)
+
+
+def heatshrink_encode(data, window, lookahead, chain=32):
+    """Encodeur LZSS glouton compatible heatshrink."""
+    max_dist = 1 << window
+    max_len = 1 << lookahead
+    # une référence arrière coûte 1 + window + lookahead bits, un littéral 9
+    min_len = (1 + window + lookahead) // 9 + 1
+    writer = BitWriter()
+    heads = {}
+    i = 0
+    n = len(data)
+
+    def insert(pos):
+        if pos + 2 <= n:
+            heads.setdefault(data[pos:pos + 2], []).append(pos)
+
+    while i < n:
+        best_len, best_dist = 0, 0
+        for cand in reversed(heads.get(data[i:i + 2], [])[-chain:]):
+            dist = i - cand
+            if dist > max_dist:
+                break
+            length = 0
+            limit = min(max_len, n - i)
+            while length < limit and data[cand + length] == data[i + length]:
+                length += 1
+            if length > best_len:
+                best_len, best_dist = length, dist
+                if length == limit:
+                    break
+        if best_len >= min_len:
+            writer.write(0, 1)
+            writer.write(best_dist - 1, window)
+            writer.write(best_len - 1, lookahead)
+            for k in range(best_len):
+                insert(i + k)
+            i += best_len
+        else:
+            writer.write(1, 1)
+            writer.write(data[i], 8)
+            insert(i)
+            i += 1
+    return writer.flush()
+
+
+def heatshrink_decode(stream, window, lookahead, size):
+    """Décodeur de référence, identique à HeatshrinkDecoder (vérification)."""
+    out = bytearray()
+    buf = bytearray(1 << window)
+    mask = (1 << window) - 1
+    pos, acc, bits = 0, 0, 0
+
+    def get(count):
+        nonlocal pos, acc, bits
+        while bits < count:
+            acc = (acc << 8) | stream[pos]
+            pos += 1
+            bits += 8
+        bits -= count
+        value = (acc >> bits) & ((1 << count) - 1)
+        acc &= (1 << bits) - 1
+        return value
+
+    head = 0
+    while len(out) < size:
+        if get(1):
+            c = get(8)
+            buf[head & mask] = c
+            head += 1
+            out.append(c)
+        else:
+            index = get(window) + 1
+            count = get(lookahead) + 1
+            for _ in range(count):
+                c = buf[(head - index) & mask]
+                buf[head & mask] = c
+                head += 1
+                out.append(c)
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--heatshrink", action="store_true", help="compression heatshrink au lieu de gzip")
+    parser.add_argument("-w", "--window", type=int, default=11, help="bits de fenêtre heatshrink (4..12)")
+    parser.add_argument("-l", "--lookahead", type=int, default=4, help="bits de lookahead heatshrink")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    if args.heatshrink:
+        if not 4 <= args.window <= 12 or not 3 <= args.lookahead < args.window:
+            sys.exit("Paramètres heatshrink invalides")
+        body = heatshrink_encode(data, args.window, args.lookahead)
+        if heatshrink_decode(body, args.window, args.lookahead, len(data)) != data:
+            sys.exit("Erreur: le flux heatshrink ne se décompresse pas à l'identique")
+        packed = b"HS" + bytes([args.window, args.lookahead]) + body
+    else:
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+
+    with open(args.output, "wb") as f:
+        f.write(packed)
+    print("%s: %d -> %d octets (%.1f %%)"
+          % (args.output, len(data), len(packed), 100.0 * len(packed) / max(len(data), 1)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Génère un patch delta WifiotaMq (format "WDLT") entre deux firmwares.
+
+Usage:
+    python3 tools/make_delta.py ancien.bin nouveau.bin patch.wdlt.gz
+    python3 tools/make_delta.py --raw ancien.bin nouveau.bin patch.wdlt
+
+Le patch est écrit compressé en gzip par défaut : non compressé, il est à
+peine plus petit que le firmware complet. L'appareil le décompresse à la
+réception (src/OTADecompress.h). --raw écrit le patch brut, à compresser
+par exemple avec tools/compress_fw.py --heatshrink.
+
+Le patch est appliqué sur l'appareil par OTAUpdater (src/OTAUpdater.h) contre
+la partition en cours d'exécution, qui doit contenir exactement ancien.bin.
+L'algorithme suit le principe de bsdiff : des blocs approximativement
+alignés sur l'ancienne image sont codés comme différences octet par octet
+(majoritairement des zéros, donc très compressibles), le reste comme
+données littérales.
+"""
+
+import argparse
+import gzip
+import hashlib
+import io
+import struct
+import sys
+
+MAGIC = b"WDLT"
+BLOCK = 16        # taille de la graine de correspondance exacte
+STRIDE = 4        # pas d'indexation de l'ancienne image
+MAX_CANDIDATES = 8
+LOOKAHEAD = 64    # arrêt de l'extension approximative après ce nombre d'octets sans gain
+
+
+def build_index(old):
+    index = {}
+    for pos in range(0, len(old) - BLOCK + 1, STRIDE):
+        bucket = index.setdefault(old[pos:pos + BLOCK], [])
+        if len(bucket) < MAX_CANDIDATES:
+            bucket.append(pos)
+    return index
+
+
+def extend_forward(old, new, ns, os_):
+    """Longueur maximisant 2 * correspondances - longueur (score bsdiff)."""
+    best_len, best_score, score, k = 0, 0, 0, 0
+    limit = min(len(new) - ns, len(old) - os_)
+    while k < limit:
+        score += 1 if new[ns + k] == old[os_ + k] else -1
+        k += 1
+        if score > best_score:
+            best_score, best_len = score, k
+        elif k - best_len > LOOKAHEAD:
+            break
+    return best_len
+
+
+def find_match(old, new, index, i, hint):
+    key = new[i:i + BLOCK]
+    if len(key) < BLOCK:
+        return None
+    # On privilégie la poursuite de l'alignement courant (code décalé)
+    if 0 <= hint <= len(old) - BLOCK and old[hint:hint + BLOCK] == key:
+        return hint
+    candidates = index.get(key)
+    return candidates[0] if candidates else None
+
+
+def diff(old, new):
+    index = build_index(old)
+    entries = []
+    # bloc diff en attente : (début nouveau, début ancien, longueur)
+    pend_new, pend_old, pend_len = 0, 0, 0
+    extra_start = 0
+    i = 0
+    while i < len(new):
+        hint = pend_old + pend_len + (i - extra_start)
+        match = find_match(old, new, index, i, hint)
+        if match is None:
+            i += 1
+            continue
+
+        # Extension arrière dans la zone littérale en attente
+        back = 0
+        while (i - back - 1 >= extra_start and match - back - 1 >= 0
+               and new[i - back - 1] == old[match - back - 1]):
+            back += 1
+        ns, os_ = i - back, match - back
+        length = extend_forward(old, new, ns, os_)
+
+        seek = os_ - (pend_old + pend_len)
+        entries.append((pend_new, pend_old, pend_len, extra_start, ns, seek))
+        pend_new, pend_old, pend_len = ns, os_, length
+        extra_start = i = ns + length
+
+    entries.append((pend_new, pend_old, pend_len, extra_start, len(new), 0))
+    return entries
+
+
+def write_patch(old, new, entries, out):
+    out.write(MAGIC)
+    out.write(struct.pack("<I", len(old)))
+    out.write(hashlib.sha256(old).digest())
+    out.write(struct.pack("<I", len(new)))
+    out.write(hashlib.sha256(new).digest())
+    for pend_new, pend_old, pend_len, extra_start, extra_end, seek in entries:
+        out.write(struct.pack("<IIi", pend_len, extra_end - extra_start, seek))
+        out.write(bytes((new[pend_new + k] - old[pend_old + k]) & 0xFF for k in range(pend_len)))
+        out.write(new[extra_start:extra_end])
+
+
+def apply_patch(old, patch):
+    """Application de référence, identique à OTAUpdater (vérification)."""
+    if patch[:4] != MAGIC:
+        raise ValueError("magic invalide")
+    base_size, = struct.unpack_from("<I", patch, 4)
+    target_size, = struct.unpack_from("<I", patch, 40)
+    if hashlib.sha256(old[:base_size]).digest() != patch[8:40]:
+        raise ValueError("base différente")
+    out = bytearray()
+    p, pos = 76, 0
+    while len(out) < target_size:
+        dlen, elen, seek = struct.unpack_from("<IIi", patch, p)
+        p += 12
+        out += bytes((old[pos + k] + patch[p + k]) & 0xFF for k in range(dlen))
+        p += dlen
+        pos += dlen + seek
+        out += patch[p:p + elen]
+        p += elen
+    if hashlib.sha256(out).digest() != patch[44:76]:
+        raise ValueError("empreinte finale invalide")
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("old", help="firmware actuellement installé (.bin)")
+    parser.add_argument("new", help="nouveau firmware (.bin)")
+    parser.add_argument("patch", help="fichier patch à générer")
+    parser.add_argument("--raw", action="store_true", help="patch non compressé (gzip par défaut)")
+    parser.add_argument("--no-verify", action="store_true", help="ne pas rejouer le patch après génération")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    entries = diff(old, new)
+    buf = io.BytesIO()
+    write_patch(old, new, entries, buf)
+    patch = buf.getvalue()
+    # Les blocs diff sont presque nuls : seule la version compressée est petite
+    data = patch if args.raw else gzip.compress(patch, compresslevel=9, mtime=0)
+    with open(args.patch, "wb") as f:
+        f.write(data)
+
+    if not args.no_verify:
+        with open(args.patch, "rb") as f:
+            written = f.read()
+        if apply_patch(old, written if args.raw else gzip.decompress(written)) != new:
+            sys.exit("Erreur: le patch ne reproduit pas le nouveau firmware")
+
+    print("%s: %d octets%s (%.1f %% du firmware complet, %d entrées)"
+          % (args.patch, len(data), "" if args.raw else ", %d avant gzip" % len(patch),
+             100.0 * len(data) / max(len(new), 1), len(entries)))
+
+
+if __name__ == "__main__":
+    main()
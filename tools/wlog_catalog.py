@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Extrait les formats des traces binaires dans un catalogue JSON.
+
+Usage:
+    python3 tools/wlog_catalog.py src examples -o wlog_catalog.json
+
+Chaque appel WLOG_BIN(logger, NIVEAU, "format", ...) et, pour les firmwares
+compilés avec -DWIFIOTA_LOG_BINARY=1, chaque WLOG_*F(logger, "format", ...)
+est identifié par l'empreinte FNV-1a 32 bits des octets du format, calculée
+comme Hash::fnv1a() (src/Hash.h). Le catalogue est lu par
+tools/wlog_decode.py ; il doit être régénéré à chaque firmware publié.
+
+Deux formats différents de même empreinte rendent le décodage ambigu :
+le script les signale et se termine en erreur.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+EXTENSIONS = ('.h', '.hpp', '.c', '.cpp', '.ino')
+LEVELS = ('DEBUG', 'INFO', 'WARNING', 'ERROR', 'CRITICAL')
+
+CALL = re.compile(r'\bWLOG_(?:BIN\s*\(\s*[^,()]+,\s*(?P<level>[A-Z]+)\s*,'
+                  r'|(?P<flevel>[A-Z]+)F\s*\(\s*[^,()]+,)\s*(?=")')
+LITERAL = re.compile(rb'"((?:[^"\\\n]|\\.)*)"\s*')
+
+SIMPLE_ESCAPES = {
+    ord('n'): b'\n', ord('t'): b'\t', ord('r'): b'\r', ord('0'): b'\0',
+    ord('\\'): b'\\', ord('"'): b'"', ord("'"): b"'", ord('?'): b'?',
+    ord('a'): b'\a', ord('b'): b'\b', ord('f'): b'\f', ord('v'): b'\v',
+}
+
+
+def fnv1a(data):
+    h = FNV_OFFSET
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def unescape(raw):
+    """Octets d'un littéral C (source UTF-8, séquences d'échappement)."""
+    out = bytearray()
+    i = 0
+    while i < len(raw):
+        c = raw[i]
+        if c != ord('\\'):
+            out.append(c)
+            i += 1
+            continue
+        e = raw[i + 1]
+        if e == ord('x'):
+            m = re.match(rb'[0-9a-fA-F]+', raw[i + 2:])
+            out.append(int(m.group(0), 16) & 0xFF)
+            i += 2 + len(m.group(0))
+        elif ord('0') <= e <= ord('7'):
+            m = re.match(rb'[0-7]{1,3}', raw[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif e in (ord('u'), ord('U')):
+            n = 4 if e == ord('u') else 8
+            out += chr(int(raw[i + 2:i + 2 + n], 16)).encode('utf-8')
+            i += 2 + n
+        else:
+            out += SIMPLE_ESCAPES.get(e, bytes([e]))
+            i += 2
+    return bytes(out)
+
+
+def strip_comments(src):
+    """Remplace les commentaires par des espaces (numéros de ligne conservés)."""
+    out = bytearray()
+    i = 0
+    n = len(src)
+    while i < n:
+        if src.startswith(b'//', i):
+            j = src.find(b'\n', i)
+            j = n if j < 0 else j
+            out += b' ' * (j - i)
+            i = j
+        elif src.startswith(b'/*', i):
+            j = src.find(b'*/', i + 2)
+            j = n if j < 0 else j + 2
+            out += bytes(b if b == ord('\n') else ord(' ') for b in src[i:j])
+            i = j
+        elif src[i] in (ord('"'), ord("'")):
+            quote = src[i]
+            j = i + 1
+            while j < n and src[j] != quote and src[j] != ord('\n'):
+                j += 2 if src[j] == ord('\\') else 1
+            out += src[i:j + 1]
+            i = j + 1
+        else:
+            out.append(src[i])
+            i += 1
+    return bytes(out)
+
+
+def scan_file(path):
+    with open(path, 'rb') as f:
+        src = strip_comments(f.read())
+    text = src.decode('utf-8', errors='replace')
+    for m in CALL.finditer(text):
+        level = m.group('level') or m.group('flevel')
+        if level not in LEVELS:
+            continue
+        # littéraux adjacents concaténés : "a" "b"
+        pos = len(text[:m.end()].encode('utf-8'))
+        fmt = b''
+        lit = LITERAL.match(src, pos)
+        while lit:
+            fmt += unescape(lit.group(1))
+            pos = lit.end()
+            lit = LITERAL.match(src, pos)
+        line = text.count('\n', 0, m.start()) + 1
+        yield fmt, level, line
+
+
+def collect(paths):
+    for root in paths:
+        if os.path.isfile(root):
+            yield root
+            continue
+        for d, dirs, files in os.walk(root):
+            dirs[:] = sorted(x for x in dirs if not x.startswith('.'))
+            for name in sorted(files):
+                if name.endswith(EXTENSIONS):
+                    yield os.path.join(d, name)
+
+
+def build(paths):
+    """Retourne (catalogue, collisions)."""
+    messages = {}
+    collisions = []
+    for path in collect(paths):
+        for fmt, _, line in scan_file(path):
+            key = '%08x' % fnv1a(fmt)
+            text = fmt.decode('utf-8', errors='replace')
+            where = '%s:%d' % (path, line)
+            entry = messages.get(key)
+            if entry is None:
+                messages[key] = {'format': text, 'sites': [where]}
+            elif entry['format'] != text:
+                collisions.append((key, entry['format'], text, where))
+            else:
+                entry['sites'].append(where)
+    return {'hash': 'fnv1a32', 'messages': messages}, collisions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('paths', nargs='+', help='fichiers ou dossiers sources')
+    parser.add_argument('-o', '--output', help='catalogue JSON (stdout par défaut)')
+    args = parser.parse_args()
+
+    catalog, collisions = build(args.paths)
+    for key, first, other, where in collisions:
+        print('collision %s : "%s" / "%s" (%s)' % (key, first, other, where), file=sys.stderr)
+
+    data = json.dumps(catalog, indent=2, ensure_ascii=False, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as f:
+            f.write(data + '\n')
+        print('%d formats -> %s' % (len(catalog['messages']), args.output), file=sys.stderr)
+    else:
+        print(data)
+    return 1 if collisions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+"""Reconstruit les logs lisibles à partir des traces binaires.
+
+Usage:
+    python3 tools/wlog_decode.py -c wlog_catalog.json capture.log
+    python3 tools/wlog_decode.py -c wlog_catalog.json --serial /dev/ttyUSB0
+    mosquitto_sub -t maison/capteur/logs | python3 tools/wlog_decode.py -c wlog_catalog.json
+    curl -u admin:pass http://esp32.local/logs | python3 tools/wlog_decode.py -s src
+    python3 tools/wlog_decode.py -s src -s lib/capteurs capture.log
+
+Les trames (src/BinaryLog.h) sont repérées dans le flux par leurs octets de
+synchronisation et contrôlées par leur CRC-8 ; le texte qui les entoure
+(logs texte, messages du bootloader) est recopié tel quel. Les lignes
+"#<hexadécimal>" de la page /logs sont décodées de la même façon.
+
+Le catalogue vient de tools/wlog_catalog.py ; -s le construit directement
+à partir des sources (un répertoire par -s, option répétable).
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+import wlog_catalog
+
+SYNC = b'\xfe\x57'
+HEADER = struct.Struct('<IIB')  # id, horodatage, niveau
+LEVELS = ('DEBUG', 'INFO', 'WARN', 'ERROR', 'CRIT')
+
+HEX_LINE = re.compile(rb'^(?P<prefix>[^#\n]*)#(?P<hex>(?:[0-9a-fA-F]{2})+)\s*$')
+SPEC = re.compile(r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<prec>\*|\d+))?'
+                  r'(?:hh|h|ll|l|j|z|t|L)?(?P<conv>[diouxXeEfFgGcspaA%])')
+
+ARG_TYPES = {
+    ord('i'): struct.Struct('<i'), ord('I'): struct.Struct('<q'),
+    ord('u'): struct.Struct('<I'), ord('U'): struct.Struct('<Q'),
+    ord('f'): struct.Struct('<f'), ord('d'): struct.Struct('<d'),
+}
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def parse_args(data):
+    args = []
+    i = 0
+    while i < len(data):
+        tag = data[i]
+        i += 1
+        if tag == ord('s'):
+            n = data[i]
+            args.append(data[i + 1:i + 1 + n].decode('utf-8', errors='replace'))
+            i += 1 + n
+        elif tag == ord('c'):
+            args.append(chr(data[i]))
+            i += 1
+        elif tag in ARG_TYPES:
+            st = ARG_TYPES[tag]
+            args.append(st.unpack_from(data, i)[0])
+            i += st.size
+        else:
+            raise ValueError('étiquette inconnue 0x%02x' % tag)
+    return args
+
+
+def render(fmt, args):
+    """Applique un format printf avec les arguments décodés."""
+    pending = list(args)
+
+    def take():
+        return pending.pop(0) if pending else None
+
+    def convert(m):
+        conv = m.group('conv')
+        if conv == '%':
+            return '%'
+        width, prec = m.group('width'), m.group('prec')
+        if width == '*':
+            width = str(take())
+        if prec == '*':
+            prec = str(take())
+        value = take()
+        if value is None:
+            return m.group(0)
+        if conv == 'c' and isinstance(value, int):
+            value = chr(value)
+        elif conv == 'p':
+            return '0x%x' % int(value)
+        elif conv in 'iu':
+            conv = 'd'
+        spec = '%' + m.group('flags') + (width or '') + ('.' + prec if prec is not None else '') + conv
+        try:
+            return spec % value
+        except (TypeError, ValueError):
+            return '<%s?%r>' % (m.group(0), value)
+
+    text = SPEC.sub(convert, fmt)
+    if pending:
+        text += ' <args en trop: %s>' % ', '.join(repr(a) for a in pending)
+    return text
+
+
+class Decoder:
+    def __init__(self, catalog):
+        self.messages = catalog.get('messages', {})
+        self.buf = b''
+        self.bad = 0
+
+    def frame(self, raw):
+        """Décode une trame complète et vérifiée (sync comprise)."""
+        msg_id, ts, level = HEADER.unpack_from(raw, 3)
+        body = raw[3 + HEADER.size:-1]
+        name = LEVELS[level] if level < len(LEVELS) else str(level)
+        try:
+            args = parse_args(body)
+        except (ValueError, IndexError, struct.error) as e:
+            return '%d.%03d [%s] <trame %08x illisible: %s>' % (ts // 1000, ts % 1000, name, msg_id, e)
+        entry = self.messages.get('%08x' % msg_id)
+        if entry is None:
+            text = '<format %08x inconnu> %s' % (msg_id, ' '.join(repr(a) for a in args))
+        else:
+            text = render(entry['format'], args)
+        return '%d.%03d [%s] %s' % (ts // 1000, ts % 1000, name, text)
+
+    def check(self, buf, pos):
+        """Longueur de la trame valide en pos, 0 si invalide, None si incomplète."""
+        if len(buf) < pos + 3:
+            return None
+        length = buf[pos + 2]
+        if length < HEADER.size:
+            return 0
+        end = pos + 3 + length + 1
+        if len(buf) < end:
+            return None
+        return end - pos if crc8(buf[pos + 2:end - 1]) == buf[end - 1] else 0
+
+    def text_line(self, line):
+        m = HEX_LINE.match(line)
+        if m:
+            raw = bytes.fromhex(m.group('hex').decode())
+            if raw.startswith(SYNC) and self.check(raw, 0) == len(raw):
+                return self.frame(raw)
+        return line.rstrip(b'\r').decode('utf-8', errors='replace')
+
+    def feed(self, data, final=False):
+        """Ajoute des octets ; retourne les lignes décodées disponibles."""
+        self.buf += data
+        out = []
+        while True:
+            pos = self.buf.find(SYNC)
+            text_end = len(self.buf) if pos < 0 else pos
+            # texte avant la prochaine trame : lignes complètes seulement
+            nl = self.buf.rfind(b'\n', 0, text_end)
+            if nl >= 0:
+                out += [self.text_line(l) for l in self.buf[:nl].split(b'\n')]
+                self.buf = self.buf[nl + 1:]
+                continue
+            if pos < 0:
+                break
+            size = self.check(self.buf, pos)
+            if size is None:
+                break
+            if size == 0:
+                # fausse synchronisation : l'octet reste du texte
+                self.bad += 1
+                self.buf = self.buf[:pos] + b'?' + self.buf[pos + 1:]
+                continue
+            if pos > 0:
+                out.append(self.text_line(self.buf[:pos]))
+            out.append(self.frame(self.buf[pos:pos + size]))
+            self.buf = self.buf[pos + size:]
+            if self.buf.startswith(b'\n'):
+                self.buf = self.buf[1:]
+        if final and self.buf:
+            out += [self.text_line(l) for l in self.buf.split(b'\n') if l]
+            self.buf = b''
+        return out
+
+
+def open_serial(port, baud):
+    try:
+        import serial
+    except ImportError:
+        sys.exit('pyserial requis : pip install pyserial')
+    return serial.Serial(port, baud, timeout=0.2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('inputs', nargs='*', help='captures (stdin par défaut)')
+    parser.add_argument('-c', '--catalog', help='catalogue de tools/wlog_catalog.py')
+    parser.add_argument('-s', '--sources', action='append',
+                        help='répertoire de sources pour construire le catalogue (répétable)')
+    parser.add_argument('--serial', help='port série à lire en continu')
+    parser.add_argument('--baud', type=int, default=115200)
+    args = parser.parse_args()
+
+    if args.catalog:
+        with open(args.catalog, encoding='utf-8') as f:
+            catalog = json.load(f)
+    elif args.sources:
+        catalog, _ = wlog_catalog.build(args.sources)
+    else:
+        parser.error('catalogue requis (-c ou -s)')
+
+    decoder = Decoder(catalog)
+
+    def emit(lines):
+        for line in lines:
+            print(line, flush=True)
+
+    if args.serial:
+        port = open_serial(args.serial, args.baud)
+        try:
+            while True:
+                emit(decoder.feed(port.read(256)))
+        except KeyboardInterrupt:
+            emit(decoder.feed(b'', final=True))
+        return 0
+
+    streams = [open(p, 'rb') for p in args.inputs] or [sys.stdin.buffer]
+    for stream in streams:
+        while True:
+            chunk = stream.read1(4096) if hasattr(stream, 'read1') else stream.read(4096)
+            if not chunk:
+                break
+            emit(decoder.feed(chunk))
+        emit(decoder.feed(b'', final=True))
+    if decoder.bad:
+        print('%d synchronisations invalides ignorées' % decoder.bad, file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())